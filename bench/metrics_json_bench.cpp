@@ -0,0 +1,610 @@
+/**
+ * @file metrics_json_bench.cpp
+ * @brief Сравнение сериализации метрик: nlohmann::json DOM и JsonWriter
+ *
+ * Прежний путь отправки: AgentManager::collect_metrics строил дерево
+ * nlohmann::json, send_metrics копировал его, дописывал agent_id и дважды
+ * вызывал dump() (проверка и make_request). Новый — JsonWriter пишет
+ * семейства в переиспользуемую строку за один проход. Перед замером
+ * проверяется, что оба документа после разбора совпадают. Для сравнения
+ * выводятся размер и время того же документа в CBOR (CborWriter); CBOR
+ * тоже разбирается и сверяется с JSON.
+ *
+ * Сборка: cmake -DBUILD_BENCHMARKS=ON; запуск: metrics_json_bench [итераций]
+ */
+
+#include "../include/metrics_cbor.hpp"
+#include "../include/metrics_json.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace monitoring;
+
+namespace {
+
+// Метрики сервера средней величины: 32 ядра, 40 групп cgroup, 1500 пакетов ПО
+SystemMetrics make_metrics() {
+    SystemMetrics m;
+    m.timestamp = std::chrono::system_clock::now();
+    m.machine_type = "physical";
+
+    m.cpu.usage_percent = 37.25;
+    m.cpu.temperature = 54.0;
+    for (int i = 0; i < 32; ++i) {
+        m.cpu.core_usage.push_back(10.0 + i * 1.7);
+        m.cpu.core_temperatures.push_back(50.0 + i % 7);
+        m.cpu.core_temperature_labels.push_back("Core " + std::to_string(i));
+    }
+    m.cpu.load = {2.53, 2.11, 1.87, 3, 1412};
+    m.cpu.pressure.available = true;
+    m.cpu.pressure.some = {0.42, 1.01, 1.19, 34979834};
+    m.cpu.processes.total = 612;
+    for (auto* list : {&m.cpu.processes.top_cpu, &m.cpu.processes.top_memory, &m.cpu.processes.top_io}) {
+        for (uint32_t i = 0; i < 10; ++i) {
+            ProcessInfo p;
+            p.pid = 1000 + i;
+            p.name = "worker-" + std::to_string(i);
+            p.cmdline = "/usr/bin/worker --config /etc/worker/" + std::to_string(i) + ".conf --threads 8";
+            p.state = 'S';
+            p.threads = 8;
+            p.cpu_percent = 12.5 + i;
+            p.rss_bytes = 104857600ull * (i + 1);
+            p.read_bytes_per_sec = 4096.0 * i;
+            list->push_back(p);
+        }
+    }
+
+    m.memory = {68719476736ull, 34359738368ull, 34359738368ull, 50.0, {}, {}};
+    m.memory.paging = {1200, 0, 0, 0.5, 0, 0};
+
+    for (int i = 0; i < 8; ++i) {
+        DiskPartition p{"/mnt/data" + std::to_string(i), "ext4", 1ull << 40, 1ull << 39, 1ull << 39, 50.0,
+                        "/dev/sd" + std::string(1, char('a' + i)) + "1"};
+        p.read_bytes_per_sec = 1048576.0 * i;
+        m.disk.partitions.push_back(p);
+        BlockDeviceIo d;
+        d.name = "sd" + std::string(1, char('a' + i));
+        d.reads_per_sec = 120.5;
+        d.read_await_ms = 0.734;
+        d.utilization_percent = 12.75;
+        m.disk.devices.push_back(d);
+    }
+
+    for (int i = 0; i < 6; ++i) {
+        NetworkInterface n;
+        n.name = "eth" + std::to_string(i);
+        n.bytes_sent = 123456789012ull;
+        n.bytes_received = 98765432109ull;
+        n.packets_sent = 123456789;
+        n.packets_received = 98765432;
+        n.bandwidth_sent = 125000;
+        n.bandwidth_received = 250000;
+        n.operstate = "up";
+        n.mtu = 1500;
+        n.speed_mbps = 10000;
+        m.network.interfaces.push_back(n);
+    }
+    m.network.connection_summary.total = 4200;
+    for (uint16_t i = 0; i < 40; ++i) {
+        m.network.connection_summary.groups.push_back({"TCP", "ESTABLISHED", static_cast<uint16_t>(8000 + i), 100u});
+    }
+    for (int i = 0; i < 10; ++i) {
+        m.network.connection_summary.top_remote_peers.push_back({"10.0.0." + std::to_string(i), 50u});
+    }
+
+    m.gpu = {-1.0, -1.0, 0, 0, {}};
+    for (int i = 0; i < 4; ++i) {
+        m.hdd.drives.push_back({"sd" + std::string(1, char('a' + i)), 36.0 + i, 21000ull + i, "PASSED"});
+    }
+    m.user = {"operator", "", "Operator", "1000", true};
+
+    m.inventory.device_type = "server";
+    m.inventory.manufacturer = "Vendor";
+    m.inventory.model = "Model \"X\"";
+    m.inventory.os_name = "Debian GNU/Linux";
+    for (int i = 0; i < 1500; ++i) {
+        m.inventory.installed_software.push_back("package-" + std::to_string(i));
+        m.inventory.installed_software_versions.push_back("1." + std::to_string(i) + "-1");
+    }
+
+    m.cgroup.available = true;
+    for (int i = 0; i < 40; ++i) {
+        CgroupInfo g;
+        g.path = "/system.slice/service-" + std::to_string(i) + ".service";
+        g.cpu_percent = 1.5 * i;
+        g.memory_current = 52428800ull * i;
+        g.cpu_pressure.available = true;
+        m.cgroup.groups.push_back(g);
+    }
+    return m;
+}
+
+// Top-N процессов: {"total", "top_cpu": [...], "top_memory": [...], "top_io": [...]}
+static nlohmann::json processes_to_json(const monitoring::ProcessMetrics& p) {
+    auto list = [](const std::vector<monitoring::ProcessInfo>& processes) {
+        nlohmann::json arr = nlohmann::json::array();
+        for (const auto& proc : processes) {
+            nlohmann::json jp;
+            jp["pid"] = proc.pid;
+            jp["name"] = proc.name;
+            jp["cmdline"] = proc.cmdline;
+            jp["uid"] = proc.uid;
+            jp["state"] = std::string(1, proc.state);
+            jp["threads"] = proc.threads;
+            jp["cpu_percent"] = proc.cpu_percent;
+            jp["rss_bytes"] = proc.rss_bytes;
+            jp["read_bytes_per_sec"] = proc.read_bytes_per_sec;
+            jp["write_bytes_per_sec"] = proc.write_bytes_per_sec;
+            arr.push_back(jp);
+        }
+        return arr;
+    };
+    return nlohmann::json{{"total", p.total},
+                          {"top_cpu", list(p.top_cpu)},
+                          {"top_memory", list(p.top_memory)},
+                          {"top_io", list(p.top_io)}};
+}
+
+// PSI одного ресурса: {"available", "some": {...}, "full": {...}}
+static nlohmann::json pressure_to_json(const monitoring::PressureInfo& p) {
+    auto stall = [](const monitoring::PressureStall& s) {
+        return nlohmann::json{{"avg10", s.avg10}, {"avg60", s.avg60}, {"avg300", s.avg300}, {"total_us", s.total_us}};
+    };
+    nlohmann::json j;
+    j["available"] = p.available;
+    if (p.available) {
+        j["some"] = stall(p.some);
+        j["full"] = stall(p.full);
+    }
+    return j;
+}
+
+// Группы cgroup v2: {"available", "groups": [{"path", "cpu_percent", ...}]}
+static nlohmann::json cgroup_to_json(const monitoring::CgroupMetrics& c) {
+    nlohmann::json groups = nlohmann::json::array();
+    for (const auto& g : c.groups) {
+        groups.push_back({{"path", g.path},
+                          {"cpu_percent", g.cpu_percent},
+                          {"cpu_user_percent", g.cpu_user_percent},
+                          {"cpu_system_percent", g.cpu_system_percent},
+                          {"throttled_percent", g.throttled_percent},
+                          {"memory_current", g.memory_current},
+                          {"memory_max", g.memory_max},
+                          {"memory_anon", g.memory_anon},
+                          {"memory_file", g.memory_file},
+                          {"read_bytes_per_sec", g.read_bytes_per_sec},
+                          {"write_bytes_per_sec", g.write_bytes_per_sec},
+                          {"reads_per_sec", g.reads_per_sec},
+                          {"writes_per_sec", g.writes_per_sec},
+                          {"cpu_pressure", pressure_to_json(g.cpu_pressure)}});
+    }
+    return nlohmann::json{{"available", c.available}, {"groups", std::move(groups)}};
+}
+
+// Прежний AgentManager::collect_metrics без config
+nlohmann::json legacy_metrics_json(const SystemMetrics& metrics, const std::vector<std::string>& families,
+                                   bool full_connections) {
+    nlohmann::json j;
+    j["timestamp"] = std::chrono::duration_cast<std::chrono::seconds>(metrics.timestamp.time_since_epoch()).count();
+    j["machine_type"] = metrics.machine_type;
+
+    // Добавляем метрики согласно families
+    for (const auto& metric_type : families) {
+        if (metric_type == "cpu") {
+            j["cpu"]["usage_percent"] = metrics.cpu.usage_percent;
+            j["cpu"]["temperature"] = metrics.cpu.temperature;
+            j["cpu"]["core_temperatures"] = metrics.cpu.core_temperatures;
+            j["cpu"]["core_temperature_labels"] = metrics.cpu.core_temperature_labels;
+            j["cpu"]["core_usage"] = metrics.cpu.core_usage;
+            j["cpu"]["load"] = {{"load1", metrics.cpu.load.load1}, {"load5", metrics.cpu.load.load5},
+                                 {"load15", metrics.cpu.load.load15}, {"running", metrics.cpu.load.running},
+                                 {"total", metrics.cpu.load.total}};
+            j["cpu"]["pressure"] = pressure_to_json(metrics.cpu.pressure);
+            j["cpu"]["processes"] = processes_to_json(metrics.cpu.processes);
+        } else if (metric_type == "memory") {
+            j["memory"]["total_bytes"] = metrics.memory.total_bytes;
+            j["memory"]["used_bytes"] = metrics.memory.used_bytes;
+            j["memory"]["free_bytes"] = metrics.memory.free_bytes;
+            j["memory"]["usage_percent"] = metrics.memory.usage_percent;
+            j["memory"]["pressure"] = pressure_to_json(metrics.memory.pressure);
+            j["memory"]["paging"] = {{"major_faults", metrics.memory.paging.major_faults},
+                                     {"swap_in", metrics.memory.paging.swap_in},
+                                     {"swap_out", metrics.memory.paging.swap_out},
+                                     {"major_faults_per_sec", metrics.memory.paging.major_faults_per_sec},
+                                     {"swap_in_per_sec", metrics.memory.paging.swap_in_per_sec},
+                                     {"swap_out_per_sec", metrics.memory.paging.swap_out_per_sec}};
+        } else if (metric_type == "disk") {
+            j["disk"]["partitions"] = nlohmann::json::array();
+            for (const auto& part : metrics.disk.partitions) {
+                nlohmann::json jp;
+                jp["mount_point"] = part.mount_point;
+                jp["filesystem"] = part.filesystem;
+                jp["total_bytes"] = static_cast<int64_t>(part.total_bytes);
+                jp["used_bytes"] = static_cast<int64_t>(part.used_bytes);
+                jp["free_bytes"] = static_cast<int64_t>(part.free_bytes);
+                if (part.usage_percent >= 0) {
+                    jp["usage_percent"] = static_cast<double>(part.usage_percent);
+                }
+                jp["device"] = part.device;
+                jp["unresponsive"] = part.unresponsive;
+                jp["read_bytes_per_sec"] = part.read_bytes_per_sec;
+                jp["write_bytes_per_sec"] = part.write_bytes_per_sec;
+                jp["reads_per_sec"] = part.reads_per_sec;
+                jp["writes_per_sec"] = part.writes_per_sec;
+                j["disk"]["partitions"].push_back(jp);
+            }
+            j["disk"]["io_pressure"] = pressure_to_json(metrics.disk.io_pressure);
+            j["disk"]["devices"] = nlohmann::json::array();
+            for (const auto& dev : metrics.disk.devices) {
+                nlohmann::json jd;
+                jd["name"] = dev.name;
+                jd["parent"] = dev.parent;
+                jd["reads_per_sec"] = dev.reads_per_sec;
+                jd["writes_per_sec"] = dev.writes_per_sec;
+                jd["read_bytes_per_sec"] = dev.read_bytes_per_sec;
+                jd["write_bytes_per_sec"] = dev.write_bytes_per_sec;
+                jd["read_await_ms"] = dev.read_await_ms;
+                jd["write_await_ms"] = dev.write_await_ms;
+                jd["utilization_percent"] = dev.utilization_percent;
+                jd["queue_depth"] = dev.queue_depth;
+                jd["in_flight"] = dev.in_flight;
+                j["disk"]["devices"].push_back(jd);
+            }
+        } else if (metric_type == "network") {
+            j["network"]["interfaces"] = nlohmann::json::array();
+            for (const auto& iface : metrics.network.interfaces) {
+                nlohmann::json ji;
+                ji["name"] = iface.name;
+                ji["bytes_sent"] = static_cast<int64_t>(iface.bytes_sent);
+                ji["bytes_received"] = static_cast<int64_t>(iface.bytes_received);
+                ji["packets_sent"] = static_cast<int64_t>(iface.packets_sent);
+                ji["packets_received"] = static_cast<int64_t>(iface.packets_received);
+                ji["bandwidth_sent"] = static_cast<double>(iface.bandwidth_sent);
+                ji["bandwidth_received"] = static_cast<double>(iface.bandwidth_received);
+                ji["packets_sent_rate"] = static_cast<int64_t>(iface.packets_sent_rate);
+                ji["packets_received_rate"] = static_cast<int64_t>(iface.packets_received_rate);
+                ji["errors_sent"] = static_cast<int64_t>(iface.errors_sent);
+                ji["errors_received"] = static_cast<int64_t>(iface.errors_received);
+                ji["dropped_sent"] = static_cast<int64_t>(iface.dropped_sent);
+                ji["dropped_received"] = static_cast<int64_t>(iface.dropped_received);
+                ji["carrier"] = iface.carrier;
+                ji["mtu"] = iface.mtu;
+                ji["operstate"] = iface.operstate;
+                ji["speed_mbps"] = iface.speed_mbps;
+                j["network"]["interfaces"].push_back(ji);
+            }
+
+            // Сводка по соединениям отправляется всегда
+            const auto& summary = metrics.network.connection_summary;
+            nlohmann::json js;
+            js["total"] = summary.total;
+            js["groups"] = nlohmann::json::array();
+            for (const auto& group : summary.groups) {
+                nlohmann::json jg;
+                jg["protocol"] = group.protocol;
+                jg["state"] = group.state;
+                jg["local_port"] = group.local_port;
+                jg["count"] = group.count;
+                js["groups"].push_back(jg);
+            }
+            js["top_remote_peers"] = nlohmann::json::array();
+            for (const auto& peer : summary.top_remote_peers) {
+                js["top_remote_peers"].push_back({{"remote_ip", peer.remote_ip}, {"count", peer.count}});
+            }
+            j["network"]["connection_summary"] = js;
+
+            // Полный список соединений — только в режиме "full" или по запросу;
+            // коллекторы без агрегации (Windows) по-прежнему отдают список
+            bool has_summary = summary.total > 0 || metrics.network.connections.empty();
+            if (full_connections || !has_summary) {
+                j["network"]["connections"] = nlohmann::json::array();
+                for (const auto& conn : metrics.network.connections) {
+                    nlohmann::json jc;
+                    jc["local_ip"] = conn.local_ip;
+                    jc["local_port"] = conn.local_port;
+                    jc["remote_ip"] = conn.remote_ip;
+                    jc["remote_port"] = conn.remote_port;
+                    jc["protocol"] = conn.protocol;
+                    jc["state"] = conn.state;
+                    j["network"]["connections"].push_back(jc);
+                }
+            }
+        } else if (metric_type == "gpu") {
+            j["gpu"]["temperature"] = metrics.gpu.temperature;
+            j["gpu"]["usage_percent"] = metrics.gpu.usage_percent;
+            j["gpu"]["memory_used"] = metrics.gpu.memory_used;
+            j["gpu"]["memory_total"] = metrics.gpu.memory_total;
+            j["gpu"]["devices"] = nlohmann::json::array();
+            for (const auto& device : metrics.gpu.devices) {
+                nlohmann::json jg;
+                jg["name"] = device.name;
+                jg["vendor"] = device.vendor;
+                jg["model"] = device.model;
+                jg["pci_address"] = device.pci_address;
+                jg["temperature"] = device.temperature;
+                jg["usage_percent"] = device.usage_percent;
+                jg["memory_used"] = device.memory_used;
+                jg["memory_total"] = device.memory_total;
+                j["gpu"]["devices"].push_back(jg);
+            }
+        } else if (metric_type == "hdd") {
+            j["hdd"]["drives"] = nlohmann::json::array();
+            for (const auto& drive : metrics.hdd.drives) {
+                nlohmann::json jd;
+                jd["name"] = drive.name;
+                jd["temperature"] = drive.temperature;
+                jd["power_on_hours"] = drive.power_on_hours;
+                jd["health_status"] = drive.health_status;
+                j["hdd"]["drives"].push_back(jd);
+            }
+        } else if (metric_type == "user") {
+            j["user"]["username"] = metrics.user.username;
+            j["user"]["domain"] = metrics.user.domain;
+            j["user"]["full_name"] = metrics.user.full_name;
+            j["user"]["user_sid"] = metrics.user.user_sid;
+            j["user"]["is_active"] = metrics.user.is_active;
+        } else if (metric_type == "inventory") {
+            j["inventory"]["device_type"] = metrics.inventory.device_type;
+            j["inventory"]["manufacturer"] = metrics.inventory.manufacturer;
+            j["inventory"]["model"] = metrics.inventory.model;
+            j["inventory"]["serial_number"] = metrics.inventory.serial_number;
+            j["inventory"]["uuid"] = metrics.inventory.uuid;
+            j["inventory"]["os_name"] = metrics.inventory.os_name;
+            j["inventory"]["os_version"] = metrics.inventory.os_version;
+            j["inventory"]["cpu_model"] = metrics.inventory.cpu_model;
+            j["inventory"]["cpu_frequency"] = metrics.inventory.cpu_frequency;
+            j["inventory"]["memory_type"] = metrics.inventory.memory_type;
+            j["inventory"]["disk_model"] = metrics.inventory.disk_model;
+            j["inventory"]["disk_type"] = metrics.inventory.disk_type;
+            j["inventory"]["disk_total_bytes"] = metrics.inventory.disk_total_bytes;
+            j["inventory"]["gpu_model"] = metrics.inventory.gpu_model;
+            j["inventory"]["mac_addresses"] = metrics.inventory.mac_addresses;
+            j["inventory"]["ip_addresses"] = metrics.inventory.ip_addresses;
+            j["inventory"]["installed_software"] = metrics.inventory.installed_software;
+            j["inventory"]["installed_software_versions"] = metrics.inventory.installed_software_versions;
+        } else if (metric_type == "cgroup") {
+            j["cgroup"] = cgroup_to_json(metrics.cgroup);
+        }
+
+        // Семейство не успело к сроку — передано последнее удачное значение
+        if ((metrics.stale_families & monitoring::metric_family_bit(metric_type)) && j.contains(metric_type)) {
+            j[metric_type]["stale"] = true;
+        }
+    }
+    return j;
+}
+
+// Прежний путь отправки: копия, agent_id, dump() для проверки и dump() в make_request
+size_t legacy_send(const SystemMetrics& metrics, const std::vector<std::string>& families) {
+    nlohmann::json data = legacy_metrics_json(metrics, families, false);
+    data["agent_id"] = "agent-1";
+    data["machine_name"] = "host-1";
+    std::string checked = data.dump();
+    std::string body = data.dump();
+    return checked.size() + body.size();
+}
+
+template <typename Writer>
+void write_payload(const SystemMetrics& metrics, const std::vector<std::string>& families, std::string& body) {
+    body.clear();
+    Writer w(body);
+    w.begin_object();
+    w.key("timestamp");
+    w.value(std::chrono::duration_cast<std::chrono::seconds>(metrics.timestamp.time_since_epoch()).count());
+    w.key("machine_type");
+    w.value(metrics.machine_type);
+    w.key("agent_id");
+    w.value("agent-1");
+    w.key("machine_name");
+    w.value("host-1");
+    for (const auto& family : families) {
+        w.key(family);
+        write_metric_family(w, metrics, family, false);
+    }
+    w.end_object();
+}
+
+/**
+ * @class CborReader
+ * @brief Разбор CBOR в nlohmann::json для сверки с JSON-документом
+ *
+ * Понимает то, что пишет CborWriter: контейнеры любой длины, half/float/
+ * double, stringref (теги 256 и 25) и массивы float64 little-endian (тег 86).
+ * nlohmann::json::from_cbor ссылки stringref не раскрывает.
+ */
+class CborReader {
+public:
+    explicit CborReader(const std::string& data) : data_(data) {}
+
+    nlohmann::json document() {
+        nlohmann::json value = item();
+        if (pos_ != data_.size()) throw std::runtime_error("trailing bytes");
+        return value;
+    }
+
+private:
+    static constexpr int kBreak = 0xFF;
+
+    uint8_t byte() {
+        if (pos_ >= data_.size()) throw std::runtime_error("unexpected end");
+        return static_cast<uint8_t>(data_[pos_++]);
+    }
+
+    uint64_t argument(uint8_t info) {
+        if (info < 24) return info;
+        const int bytes = info == 24 ? 1 : info == 25 ? 2 : info == 26 ? 4 : info == 27 ? 8 : 0;
+        if (bytes == 0) throw std::runtime_error("bad additional info");
+        uint64_t v = 0;
+        for (int i = 0; i < bytes; ++i) v = (v << 8) | byte();
+        return v;
+    }
+
+    std::string bytes(uint64_t length) {
+        if (length > data_.size() - pos_) throw std::runtime_error("unexpected end");
+        std::string out = data_.substr(pos_, length);
+        pos_ += length;
+        return out;
+    }
+
+    static double half(uint16_t h) {
+        const int exponent = (h >> 10) & 0x1F;
+        const double mantissa = h & 0x3FF;
+        double v = exponent == 0 ? std::ldexp(mantissa, -24)
+                 : exponent == 31 ? (mantissa == 0 ? INFINITY : NAN)
+                 : std::ldexp(mantissa + 1024, exponent - 25);
+        return (h & 0x8000) ? -v : v;
+    }
+
+    // Строка определенной длины попадает в таблицу текущего пространства stringref
+    void remember(const std::string& s) {
+        if (namespaces_.empty()) return;
+        auto& table = namespaces_.back();
+        const size_t n = table.size();
+        const size_t min_length = n < 24 ? 3 : n < 256 ? 4 : n < 65536 ? 5 : n < 4294967296ull ? 7 : 11;
+        if (s.size() >= min_length) table.push_back(s);
+    }
+
+    nlohmann::json item() {
+        nlohmann::json value;
+        if (!next(value)) throw std::runtime_error("unexpected break");
+        return value;
+    }
+
+    // false — встретился break
+    bool next(nlohmann::json& out) {
+        const uint8_t initial = byte();
+        if (initial == kBreak) return false;
+        const uint8_t major = initial >> 5;
+        const uint8_t info = initial & 0x1F;
+        switch (major) {
+        case 0: out = argument(info); return true;
+        case 1: out = -1 - static_cast<int64_t>(argument(info)); return true;
+        case 2:
+        case 3: {
+            std::string s = bytes(argument(info));
+            remember(s);
+            out = major == 3 ? nlohmann::json(s) : nlohmann::json::binary(std::vector<uint8_t>(s.begin(), s.end()));
+            return true;
+        }
+        case 4: {
+            out = nlohmann::json::array();
+            const bool indefinite = info == 31;
+            uint64_t count = indefinite ? 0 : argument(info);
+            nlohmann::json element;
+            while (indefinite ? next(element) : count-- > 0 && (element = item(), true)) out.push_back(std::move(element));
+            return true;
+        }
+        case 5: {
+            out = nlohmann::json::object();
+            const bool indefinite = info == 31;
+            uint64_t count = indefinite ? 0 : argument(info);
+            nlohmann::json key;
+            while (indefinite ? next(key) : count-- > 0 && (key = item(), true)) {
+                out[key.get<std::string>()] = item();
+            }
+            return true;
+        }
+        case 6: {
+            const uint64_t tag = argument(info);
+            if (tag == 256) {
+                namespaces_.emplace_back();
+                out = item();
+                namespaces_.pop_back();
+            } else if (tag == 25) {
+                const uint64_t index = item().get<uint64_t>();
+                if (namespaces_.empty() || index >= namespaces_.back().size()) throw std::runtime_error("bad stringref");
+                out = namespaces_.back()[index];
+            } else if (tag == 86) {
+                const nlohmann::json bytes_value = item();
+                const auto& raw = bytes_value.get_binary();
+                out = nlohmann::json::array();
+                for (size_t i = 0; i + 8 <= raw.size(); i += 8) {
+                    uint64_t bits = 0;
+                    for (int b = 7; b >= 0; --b) bits = (bits << 8) | raw[i + b];
+                    double v;
+                    std::memcpy(&v, &bits, sizeof(v));
+                    out.push_back(v);
+                }
+            } else {
+                out = item();
+            }
+            return true;
+        }
+        default:
+            if (info == 20 || info == 21) out = info == 21;
+            else if (info == 22 || info == 23) out = nullptr;
+            else if (info == 25) out = half(static_cast<uint16_t>(argument(info)));
+            else if (info == 26) {
+                const auto bits = static_cast<uint32_t>(argument(info));
+                float f;
+                std::memcpy(&f, &bits, sizeof(f));
+                out = static_cast<double>(f);
+            } else if (info == 27) {
+                const uint64_t bits = argument(info);
+                double d;
+                std::memcpy(&d, &bits, sizeof(d));
+                out = d;
+            } else {
+                throw std::runtime_error("unsupported simple value");
+            }
+            return true;
+        }
+    }
+
+    const std::string& data_;
+    size_t pos_ = 0;
+    std::vector<std::vector<std::string>> namespaces_;
+};
+
+template <typename F>
+double microseconds_per_call(int iterations, F&& f) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) f();
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int iterations = argc > 1 ? std::atoi(argv[1]) : 2000;
+    const SystemMetrics metrics = make_metrics();
+    const std::vector<std::string> periodic = {"cpu", "memory", "disk", "network", "gpu", "hdd", "user", "cgroup"};
+    const std::vector<std::string> all = {"cpu", "memory", "disk", "network", "gpu", "hdd", "user", "cgroup", "inventory"};
+
+    std::string body;
+    std::string cbor;
+    for (const auto* families : {&periodic, &all}) {
+        nlohmann::json expected = legacy_metrics_json(metrics, *families, false);
+        expected["agent_id"] = "agent-1";
+        expected["machine_name"] = "host-1";
+        write_payload<JsonWriter>(metrics, *families, body);
+        if (nlohmann::json::parse(body) != expected) {
+            std::fprintf(stderr, "JsonWriter output differs from nlohmann::json\n");
+            return 1;
+        }
+        write_payload<CborWriter>(metrics, *families, cbor);
+        if (CborReader(cbor).document() != nlohmann::json::parse(body)) {
+            std::fprintf(stderr, "CborWriter output differs from JsonWriter\n");
+            return 1;
+        }
+
+        const double legacy = microseconds_per_call(iterations, [&] { legacy_send(metrics, *families); });
+        const double writer = microseconds_per_call(iterations, [&] { write_payload<JsonWriter>(metrics, *families, body); });
+        const double cbor_writer = microseconds_per_call(iterations, [&] { write_payload<CborWriter>(metrics, *families, cbor); });
+        std::printf("%-22s %8zu bytes  nlohmann::json %9.1f us  JsonWriter %8.1f us  x%.1f\n",
+                    families == &periodic ? "periodic families" : "with inventory", body.size(), legacy, writer,
+                    legacy / writer);
+        std::printf("%-22s %8zu bytes  CborWriter %8.1f us  JSON/CBOR size x%.1f\n", "", cbor.size(), cbor_writer,
+                    static_cast<double>(body.size()) / static_cast<double>(cbor.size()));
+    }
+    return 0;
+}
@@ -0,0 +1,11 @@
+-- Миграция 003: Семейство метрик cgroup (контейнеры и systemd-юниты)
+
+-- Ограничение из 002 создано без имени, в модели SQLAlchemy — check_metric_type
+ALTER TABLE agent_metrics DROP CONSTRAINT IF EXISTS agent_metrics_metric_type_check;
+ALTER TABLE agent_metrics DROP CONSTRAINT IF EXISTS check_metric_type;
+ALTER TABLE agent_metrics ADD CONSTRAINT check_metric_type CHECK (metric_type IN (
+    'cpu', 'memory', 'disk', 'network', 'gpu', 'hdd', 'user', 'inventory', 'cgroup'
+));
+
+INSERT INTO metric_types (name) VALUES ('cgroup')
+ON CONFLICT (name) DO NOTHING;
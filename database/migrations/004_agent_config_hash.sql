@@ -0,0 +1,6 @@
+-- Миграция 004: Хеш конфигурации агента
+-- Агент присылает полную конфигурацию только при ее изменении, в остальных
+-- отправках метрик — config_hash. Сервер хранит хеш последней полученной
+-- конфигурации и отвечает config_required, если прислан неизвестный хеш.
+
+ALTER TABLE agents ADD COLUMN IF NOT EXISTS config_hash VARCHAR(16);
@@ -27,6 +27,7 @@ CREATE TABLE agents (
     max_script_timeout_sec INTEGER DEFAULT 60,
     send_timeout_ms INTEGER DEFAULT 2000,
     update_frequency INTEGER DEFAULT 60,
+    config_hash VARCHAR(16),  -- Хеш последней конфигурации, присланной агентом
     created_at TIMESTAMPTZ DEFAULT NOW(),
     last_heartbeat TIMESTAMPTZ
 );
@@ -82,7 +83,7 @@ CREATE TABLE agent_metrics (
     machine_type VARCHAR(50) NOT NULL CHECK (machine_type IN ('physical', 'virtual')),
     machine_name VARCHAR(255) NOT NULL,
     metric_type VARCHAR(20) NOT NULL CHECK (metric_type IN (
-        'cpu', 'memory', 'disk', 'network', 'gpu', 'hdd', 'user', 'inventory'
+        'cpu', 'memory', 'disk', 'network', 'gpu', 'hdd', 'user', 'inventory', 'cgroup'
     )),
     
     -- Общие числовые метрики (оптимизированы для запросов)
@@ -140,5 +141,6 @@ INSERT INTO metric_types (name) VALUES
     ('gpu'),
     ('hdd'),
     ('inventory'),
-    ('user')
+    ('user'),
+    ('cgroup')
 ON CONFLICT (name) DO NOTHING;
\ No newline at end of file
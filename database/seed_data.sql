@@ -19,5 +19,6 @@ INSERT INTO metric_types (name) VALUES
     ('gpu'),
     ('hdd'),
     ('inventory'),
-    ('user')
+    ('user'),
+    ('cgroup')
 ON CONFLICT (name) DO NOTHING;
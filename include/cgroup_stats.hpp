@@ -0,0 +1,93 @@
+/**
+ * @file cgroup_stats.hpp
+ * @brief Потребление ресурсов контейнеров и systemd-юнитов по cgroup v2
+ *
+ * Обходит иерархию cgroup v2 и для каждой группы читает cpu.stat,
+ * memory.current, memory.max, memory.stat, io.stat и cpu.pressure.
+ * Дескрипторы файлов открываются при обнаружении группы и остаются
+ * открытыми: в каждом цикле выполняется только pread(). Дерево
+ * перечитывается только по событиям inotify (создание и удаление
+ * каталогов), а также раз в несколько минут — включение контроллера в
+ * cgroup.subtree_control создает файлы без событий inotify.
+ */
+
+#pragma once
+
+#include "metrics_collector.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <unordered_map>
+#include <vector>
+
+namespace monitoring {
+
+/**
+ * @class CgroupTracker
+ * @brief Группы cgroup v2 и скорости их счетчиков между вызовами update()
+ *
+ * Не потокобезопасен: вызывается только из задачи семейства "cgroup".
+ */
+class CgroupTracker {
+public:
+    /**
+     * @param root      Корень иерархии; пустая строка — /sys/fs/cgroup (unified)
+     *                  или /sys/fs/cgroup/unified (hybrid)
+     * @param max_depth Глубина обхода от корня; 4 покрывает поды Kubernetes
+     */
+    explicit CgroupTracker(std::string root = "", size_t max_depth = 4);
+    ~CgroupTracker();
+
+    CgroupTracker(const CgroupTracker&) = delete;
+    CgroupTracker& operator=(const CgroupTracker&) = delete;
+
+    /// Найдена иерархия cgroup v2
+    bool available() const { return !root_.empty(); }
+
+    /// Перечитывает счетчики (и дерево, если оно изменилось) и заполняет out
+    void update(CgroupMetrics& out);
+
+private:
+    enum File { kCpuStat, kMemoryCurrent, kMemoryMax, kMemoryStat, kIoStat, kCpuPressure, kFileCount };
+
+    struct Counters {
+        uint64_t usage_usec = 0;
+        uint64_t user_usec = 0;
+        uint64_t system_usec = 0;
+        uint64_t throttled_usec = 0;
+        uint64_t rbytes = 0;
+        uint64_t wbytes = 0;
+        uint64_t rios = 0;
+        uint64_t wios = 0;
+    };
+
+    struct Group {
+        std::string path;                   ///< От корня иерархии, начинается с "/"
+        ino_t ino = 0;                      ///< Inode каталога: отличает пересозданную группу
+        int fds[kFileCount] = {-1, -1, -1, -1, -1, -1};
+        Counters counters;
+        bool has_counters = false;
+    };
+
+    /// Разбирает накопившиеся события inotify; true, если дерево изменилось
+    bool drain_events();
+    void rescan();
+    void scan_dir(int dir_fd, std::string& path, size_t depth, std::unordered_map<std::string, Group>& old);
+    bool read(int fd, std::string_view& out);
+    void read_group(Group& group, CgroupInfo& info, double seconds);
+    static void close_group(Group& group);
+
+    std::string root_;
+    size_t max_depth_;
+    int inotify_fd_ = -1;
+    bool scanned_ = false;
+    std::vector<Group> groups_;
+    std::vector<char> buffer_;
+    std::chrono::steady_clock::time_point last_update_;
+    std::chrono::steady_clock::time_point last_scan_;
+};
+
+} // namespace monitoring
@@ -0,0 +1,75 @@
+/**
+ * @file connection_aggregator.hpp
+ * @brief Сводка по сетевым соединениям вместо полного списка сокетов
+ *
+ * ConnectionAggregator получает поток SocketRecord и за один проход
+ * считает количество сокетов по ключу (протокол, состояние, локальный
+ * порт) и по удаленным адресам. Счетчики хранятся в компактных хеш-таблицах
+ * с открытой адресацией, которые переиспользуются между циклами сбора.
+ *
+ * Ядро отдает слушающие TCP-сокеты раньше установленных, поэтому порт,
+ * на котором уже встретился LISTEN, не сворачивается в эфемерный даже
+ * если попадает в ip_local_port_range.
+ */
+
+#pragma once
+
+#include "metrics_collector.hpp"
+#include "sock_diag.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace monitoring {
+
+class ConnectionAggregator : public SocketSink {
+public:
+    /**
+     * @param top_peers Сколько самых частых удаленных адресов возвращать
+     * @param ephemeral_min, ephemeral_max Диапазон эфемерных портов
+     *        (net.ipv4.ip_local_port_range); локальные порты из него у
+     *        не-LISTEN сокетов сворачиваются в local_port = 0
+     */
+    explicit ConnectionAggregator(size_t top_peers = 10,
+                                  uint16_t ephemeral_min = 32768, uint16_t ephemeral_max = 60999);
+
+    void set_top_peers(size_t top_peers) { top_peers_ = top_peers; }
+    void set_ephemeral_range(uint16_t min_port, uint16_t max_port);
+
+    /// Очищает счетчики перед новым циклом (память таблиц сохраняется)
+    void reset();
+
+    void on_socket(const SocketRecord& record) override;
+
+    /// Переносит результат в summary: группы по убыванию count и top-N адресов
+    void finish(ConnectionSummary& summary);
+
+private:
+    struct GroupSlot {
+        uint32_t key;    ///< 0 — свободный слот
+        uint32_t count;
+    };
+    struct PeerSlot {
+        uint8_t addr[16];
+        uint8_t family;  ///< 0 — свободный слот
+        uint32_t count;
+    };
+
+    void grow_groups();
+    void grow_peers();
+    void add_group(uint32_t key);
+    void add_peer(const SocketRecord& record);
+
+    size_t top_peers_;
+    uint16_t ephemeral_min_;
+    uint16_t ephemeral_max_;
+    uint64_t total_ = 0;
+
+    std::vector<GroupSlot> groups_;
+    size_t group_count_ = 0;
+    std::vector<PeerSlot> peers_;
+    size_t peer_count_ = 0;
+    std::vector<uint64_t> listen_ports_;  ///< Битовая карта портов, на которых есть LISTEN
+    std::vector<uint32_t> order_;  ///< Буфер индексов для сортировки в finish()
+};
+
+} // namespace monitoring
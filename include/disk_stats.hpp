@@ -0,0 +1,85 @@
+/**
+ * @file disk_stats.hpp
+ * @brief Скорости ввода-вывода блочных устройств по /proc/diskstats
+ *
+ * Файл читается через ProcFile, строки разбираются Scanner'ом, записи
+ * устройств и их имена переиспользуются между циклами — в установившемся
+ * режиме обновление не выделяет память, и его можно вызывать каждую
+ * секунду. Родительский диск раздела определяется по sysfs один раз при
+ * появлении устройства.
+ */
+
+#pragma once
+
+#include "procfs_reader.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace monitoring {
+
+/// Накопительные счетчики одной строки /proc/diskstats
+struct DiskIoCounters {
+    uint64_t reads = 0;            ///< Завершенные чтения
+    uint64_t sectors_read = 0;     ///< Секторы по 512 байт
+    uint64_t read_ms = 0;
+    uint64_t writes = 0;
+    uint64_t sectors_written = 0;
+    uint64_t write_ms = 0;
+    uint64_t in_flight = 0;        ///< Запросов в очереди сейчас
+    uint64_t io_ms = 0;            ///< Время, когда на устройстве были запросы
+    uint64_t weighted_io_ms = 0;   ///< Сумма времени ожидания всех запросов
+};
+
+/// Скорости за последний интервал
+struct DiskIoRates {
+    double read_bytes_per_sec = 0;
+    double write_bytes_per_sec = 0;
+    double reads_per_sec = 0;
+    double writes_per_sec = 0;
+    double read_await_ms = 0;        ///< Среднее время чтения (очередь + обслуживание)
+    double write_await_ms = 0;
+    double utilization_percent = 0;  ///< Доля времени с запросами на устройстве
+    double queue_depth = 0;          ///< Средняя длина очереди за интервал
+};
+
+class DiskStatsTracker {
+public:
+    struct Device {
+        uint32_t major = 0;
+        uint32_t minor = 0;
+        std::string name;          ///< "sda", "sda1", "nvme0n1p2", "dm-0"
+        std::string parent;        ///< Диск раздела ("sda" для "sda1"); пусто для целого устройства
+        DiskIoCounters counters;
+        DiskIoRates rates;
+    };
+
+    explicit DiskStatsTracker(std::string path = "/proc/diskstats", std::string sysfs_root = "/sys");
+
+    /**
+     * @brief Перечитывает счетчики и пересчитывает скорости
+     *
+     * У нового устройства и после сброса счетчиков скорости равны 0.
+     * @return false, если файл не удалось прочитать
+     */
+    bool update();
+
+    /// Устройство по номеру; nullptr, если его нет в /proc/diskstats
+    const Device* find(uint32_t major, uint32_t minor) const;
+
+    const std::vector<Device>& devices() const { return devices_; }
+
+private:
+    void resolve_parent(Device& device) const;
+
+    procfs::ProcFile file_;
+    std::string sysfs_root_;
+    std::vector<Device> devices_;
+    std::vector<Device> previous_;
+    std::chrono::steady_clock::time_point last_update_;
+    bool has_previous_ = false;
+};
+
+} // namespace monitoring
@@ -0,0 +1,57 @@
+/**
+ * @file family_executor.hpp
+ * @brief Параллельный сбор семейств метрик на фиксированном пуле потоков
+ *
+ * Каждое семейство (MetricFamily) — отдельная задача. Сборщик ждет
+ * задачу не дольше ее срока; не успевшая задача продолжает работу в пуле,
+ * а повторно то же семейство не запускается, пока она не завершится.
+ * Так зависший statvfs или медленный диск не задерживают весь снимок.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace monitoring {
+
+class FamilyExecutor {
+public:
+    explicit FamilyExecutor(size_t threads);
+
+    /// Дожидается завершения всех задач, включая не успевшие к сроку
+    ~FamilyExecutor();
+
+    FamilyExecutor(const FamilyExecutor&) = delete;
+    FamilyExecutor& operator=(const FamilyExecutor&) = delete;
+
+    /**
+     * @brief Ставит задачу семейства в очередь
+     * @param family Бит MetricFamily
+     * @return false, если предыдущая задача этого семейства еще не завершилась
+     */
+    bool submit(uint32_t family, std::function<void()> task);
+
+    /// @return true, если задача семейства завершилась до deadline
+    bool wait(uint32_t family, std::chrono::steady_clock::time_point deadline);
+
+private:
+    void worker_loop();
+
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    std::deque<std::pair<uint32_t, std::function<void()>>> queue_;
+    uint32_t busy_ = 0;  ///< Семейства в очереди или в работе
+    bool stop_ = false;
+    std::vector<std::thread> threads_;
+};
+
+} // namespace monitoring
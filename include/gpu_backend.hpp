@@ -0,0 +1,68 @@
+/**
+ * @file gpu_backend.hpp
+ * @brief Телеметрия GPU через NVML и sysfs amdgpu без запуска nvidia-smi/rocm-smi
+ *
+ * Адаптеры обнаруживаются один раз при создании объекта. NVIDIA читается
+ * через libnvidia-ml, загружаемую dlopen(): библиотека ставится вместе с
+ * драйвером, отдельной зависимости при сборке нет. AMD читается из
+ * атрибутов драйвера amdgpu в /sys/class/drm/cardN/device. Если адаптеров
+ * нет, collect() сразу возвращает пустой результат.
+ */
+
+#pragma once
+
+#include "metrics_collector.hpp"
+#include "procfs_reader.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace monitoring {
+
+class GpuBackend {
+public:
+    /**
+     * @param sysfs_root Корень sysfs; задается, чтобы разбор можно было
+     *                   проверить на подготовленном дереве каталогов
+     * @param use_nvml   Загружать ли libnvidia-ml
+     */
+    explicit GpuBackend(std::string sysfs_root = "/sys", bool use_nvml = true);
+    ~GpuBackend();
+
+    GpuBackend(const GpuBackend&) = delete;
+    GpuBackend& operator=(const GpuBackend&) = delete;
+
+    /// Есть ли хотя бы один адаптер, с которого можно снимать метрики
+    bool has_devices() const { return nvml_device_count_ > 0 || !amd_cards_.empty(); }
+
+    /// Заполняет metrics.devices и поля первого адаптера
+    void collect(GpuMetrics& metrics);
+
+private:
+    struct Nvml;
+
+    /// Открытые атрибуты одного адаптера amdgpu
+    struct AmdCard {
+        GpuDevice info;
+        procfs::ProcFile busy_percent;
+        procfs::ProcFile vram_used;
+        procfs::ProcFile vram_total;
+        procfs::ProcFile temperature;  ///< hwmon temp1_input, миллиградусы
+        bool has_temperature = false;
+
+        AmdCard(GpuDevice device, const std::string& dir, const std::string& temp_path);
+    };
+
+    void detect_nvml();
+    void detect_amdgpu();
+    void collect_nvml(GpuMetrics& metrics);
+    void collect_amdgpu(GpuMetrics& metrics);
+
+    std::string root_;
+    std::unique_ptr<Nvml> nvml_;
+    unsigned int nvml_device_count_ = 0;
+    std::vector<AmdCard> amd_cards_;
+};
+
+} // namespace monitoring
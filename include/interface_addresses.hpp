@@ -0,0 +1,41 @@
+/**
+ * @file interface_addresses.hpp
+ * @brief MAC и IP-адреса сетевых интерфейсов Linux
+ *
+ * Один вызов getifaddrs() (внутри — дамп rtnetlink) возвращает и
+ * аппаратные адреса (AF_PACKET), и IPv4/IPv6 адреса всех интерфейсов.
+ * Используется инвентаризацией и автоопределением адреса агента.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace monitoring {
+
+struct InterfaceAddresses {
+    std::string name;
+    unsigned int flags = 0;         ///< IFF_* из net/if.h
+    std::string mac;                ///< Пусто для loopback и интерфейсов без аппаратного адреса
+    std::vector<std::string> ipv4;
+    std::vector<std::string> ipv6;
+};
+
+/**
+ * @brief Адреса всех интерфейсов в порядке, который вернуло ядро
+ *
+ * Всегда обращается к ядру; пустой список, если getifaddrs() не удался.
+ */
+std::vector<InterfaceAddresses> read_interface_addresses();
+
+/**
+ * @brief То же, что read_interface_addresses(), но с кэшем на уровне процесса
+ *
+ * Список перечитывается только после уведомления rtnetlink об изменении
+ * интерфейсов или адресов. Если подписаться на уведомления нельзя,
+ * список читается при каждом вызове. Потокобезопасна.
+ */
+std::vector<InterfaceAddresses> interface_addresses();
+
+} // namespace monitoring
@@ -0,0 +1,66 @@
+/**
+ * @file interface_rates.hpp
+ * @brief Скорости сетевых интерфейсов по разнице счетчиков между сборами
+ *
+ * Состояние хранится по ifindex, а не по имени: пересозданный интерфейс с
+ * тем же именем получает новый индекс и не дает ложного скачка скорости.
+ * Время берется из steady_clock, поэтому перевод системных часов не влияет
+ * на результат.
+ */
+
+#pragma once
+
+#include "metrics_collector.hpp"
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+
+namespace monitoring {
+
+/// Накопительные счетчики интерфейса в момент сбора
+struct InterfaceCounters {
+    uint64_t rx_bytes = 0;
+    uint64_t tx_bytes = 0;
+    uint64_t rx_packets = 0;
+    uint64_t tx_packets = 0;
+};
+
+/**
+ * @class InterfaceRateTracker
+ * @brief Считает байт/с и пакетов/с для каждого интерфейса
+ *
+ * Порядок использования на каждом цикле: begin_cycle(), update() для
+ * каждого интерфейса, end_cycle(). Интерфейсы, не встретившиеся за цикл,
+ * забываются в end_cycle().
+ */
+class InterfaceRateTracker {
+public:
+    void begin_cycle(std::chrono::steady_clock::time_point now);
+
+    /**
+     * @brief Обновляет состояние интерфейса и заполняет скорости в iface
+     *
+     * При первом появлении интерфейса скорости равны 0. Если счетчик
+     * уменьшился, предыдущее значение было в верхней половине 32-битного
+     * диапазона, а новое помещается в 32 бита, считается, что 32-битный
+     * счетчик драйвера переполнился; иначе счетчики были сброшены
+     * (down/up, перезагрузка драйвера) — скорость за этот интервал не
+     * считается, новое значение становится базой.
+     */
+    void update(int ifindex, const InterfaceCounters& counters, NetworkInterface& iface);
+
+    void end_cycle();
+
+private:
+    struct State {
+        InterfaceCounters counters;
+        std::chrono::steady_clock::time_point time;
+        uint32_t generation = 0;
+    };
+
+    std::unordered_map<int, State> states_;
+    std::chrono::steady_clock::time_point now_;
+    uint32_t generation_ = 0;
+};
+
+} // namespace monitoring
@@ -0,0 +1,64 @@
+/**
+ * @file inventory_cache.hpp
+ * @brief Кэш инвентаризационных данных с дешевыми признаками устаревания
+ *
+ * Инвентаризация меняется редко, а собирается дорого (lspci, ip, dpkg/rpm),
+ * поэтому снимок делится на части с собственными признаками устаревания:
+ * - оборудование и ОС — один раз за загрузку системы (boot_id);
+ * - установленное ПО — пока не изменились mtime/размер базы dpkg или rpm;
+ * - MAC/IP-адреса — пока rtnetlink не сообщил об изменении интерфейсов
+ *   или адресов.
+ * Оборудование и ПО сохраняются в файл рядом с конфигурацией и
+ * переживают перезапуск агента; адреса после запуска перечитываются.
+ */
+
+#pragma once
+
+#include "metrics_collector.hpp"
+#include "rtnetlink_links.hpp"
+#include <cstdint>
+#include <string>
+
+namespace monitoring {
+
+class InventoryCache {
+public:
+    /// Части снимка, которые обновляются независимо
+    enum Part : uint32_t {
+        kHardware  = 1u << 0,
+        kSoftware  = 1u << 1,
+        kAddresses = 1u << 2,
+    };
+
+    InventoryCache();
+
+    /**
+     * @brief Файл для сохранения снимка; загружает ранее сохраненный
+     * @param path Пустая строка — хранить только в памяти
+     */
+    void set_path(const std::string& path);
+
+    /// Маска устаревших частей (0 — снимок актуален)
+    uint32_t stale_parts();
+
+    /// Снимок для заполнения устаревших частей
+    InventoryInfo& snapshot() { return snapshot_; }
+
+    /// Отмечает части обновленными и сохраняет снимок на диск
+    void commit(uint32_t parts);
+
+private:
+    void load();
+    void save() const;
+    static std::string read_boot_id();
+    static int64_t packages_signature();
+
+    std::string path_;
+    InventoryInfo snapshot_;
+    uint32_t valid_parts_ = 0;
+    std::string boot_id_;
+    int64_t packages_signature_ = 0;
+    RtnetlinkMonitor link_monitor_;
+};
+
+} // namespace monitoring
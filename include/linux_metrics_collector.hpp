@@ -1,18 +1,35 @@
 #pragma once
 
 #include "metrics_collector.hpp"
+#include "procfs_reader.hpp"
+#include "sensor_registry.hpp"
+#include "sock_diag.hpp"
+#include "connection_aggregator.hpp"
+#include "interface_rates.hpp"
+#include "rtnetlink_links.hpp"
+#include "inventory_cache.hpp"
+#include "gpu_backend.hpp"
+#include "smart_reader.hpp"
+#include "family_executor.hpp"
+#include "mount_table.hpp"
+#include "statvfs_probe.hpp"
+#include "disk_stats.hpp"
+#include "pressure_stats.hpp"
+#include "process_table.hpp"
+#include "cgroup_stats.hpp"
 #include <string>
 #include <vector>
-#include <map>
 #include <chrono>
 #include <filesystem>
+#include <mutex>
+#include <atomic>
 
 namespace monitoring {
 
 /**
  * @class LinuxMetricsCollector
  * @brief Класс для сбора системных метрик в Linux
- * 
+ *
  * Реализует интерфейс MetricsCollector для сбора различных системных метрик
  * в Linux через чтение системных файлов (/proc, /sys) и использование системных вызовов.
  */
@@ -23,7 +40,7 @@ public:
      * @throw std::runtime_error если недоступны необходимые системные файлы
      */
     LinuxMetricsCollector();
-    ~LinuxMetricsCollector() override = default;
+    ~LinuxMetricsCollector() override;
 
     /**
      * @brief Сбор всех системных метрик
@@ -31,21 +48,137 @@ public:
      */
     SystemMetrics collect() override;
 
+    /**
+     * @brief Сбор метрик с параметрами цикла
+     * @param options families — маска собираемых семейств; full_connections —
+     *                дополнительно заполнить полный список соединений
+     */
+    SystemMetrics collect(const CollectOptions& options) override;
+
+    /**
+     * @brief Устанавливает окно "свежего" замера загрузки CPU
+     * @param window 0 — загрузка считается по дельте с предыдущим снимком /proc/stat
+     *               (без ожидания); >0 — два замера с паузой window (не более 1 с)
+     */
+    void set_cpu_sample_window(std::chrono::milliseconds window) override;
+
+    /**
+     * @brief Фильтр состояний TCP-соединений (применяется ядром через sock_diag)
+     * @param states Имена состояний ("ESTABLISHED", "LISTEN", ...); пустой список — все
+     */
+    void set_connection_state_filter(const std::vector<std::string>& states) override;
+
+    /// Размер top-N удаленных адресов в сводке по соединениям
+    void set_connection_top_peers(size_t top_peers) override;
+
+    /// Размер top-N процессов; 0 — /proc/[pid] не обходится
+    void set_process_top_n(size_t top_n) override;
+
+    /// Срок сбора семейства; по умолчанию 5 с, для HDD и инвентаризации — 30 с
+    void set_family_timeout(uint32_t family, std::chrono::milliseconds timeout) override;
+
+    /// Путь к файлу кэша инвентаризации (рядом с конфигурацией агента)
+    void set_inventory_cache_path(const std::string& path) override;
+
+    /**
+     * @brief Инвентаризация из кэша; устаревшие части собираются заново
+     */
+    InventoryInfo collect_inventory_info_linux();
+
 private:
+    /// Собирает одно семейство в last_good (выполняется в пуле family_executor)
+    void run_family(uint32_t family, const CollectOptions& options);
+    std::chrono::milliseconds family_timeout(uint32_t family) const;
+
     CpuMetrics collect_cpu_metrics();
     MemoryMetrics collect_memory_metrics();
     void collect_disk_metrics(DiskMetrics& disk_metrics);
-    void collect_network_metrics(NetworkMetrics& network_metrics);
+    void collect_network_metrics(NetworkMetrics& network_metrics, const CollectOptions& options);
+    void collect_interfaces_procfs(NetworkMetrics& network_metrics);
+    void collect_connections(NetworkMetrics& network_metrics, bool full_list);
     GpuMetrics collect_gpu_metrics();
     void collect_hdd_metrics(HddMetrics& hdd_metrics);
     UserMetrics collect_user_metrics();
+    std::string detect_machine_type_linux();
+    void collect_inventory_hardware(InventoryInfo& inv);
+    void collect_inventory_addresses(InventoryInfo& inv);
+    void collect_inventory_software(InventoryInfo& inv);
+
+    /// Счетчики одной строки cpu* из /proc/stat
+    struct CpuTimes {
+        uint32_t id;      ///< Номер ядра, kAggregateCpu для строки "cpu"
+        uint64_t total;
+        uint64_t idle;
+    };
+    static constexpr uint32_t kAggregateCpu = UINT32_MAX;
+    void read_cpu_times(std::vector<CpuTimes>& out);
+
+    // Переиспользуемые буферы файлов /proc
+    procfs::ProcFile proc_stat{"/proc/stat", 16384};
+    procfs::ProcFile proc_meminfo{"/proc/meminfo"};
+    procfs::ProcFile proc_net_dev{"/proc/net/dev"};
+    procfs::ProcFile proc_net_tcp{"/proc/net/tcp", 65536};
+    procfs::ProcFile proc_net_udp{"/proc/net/udp", 16384};
+    procfs::ProcFile proc_net_tcp6{"/proc/net/tcp6", 65536};
+    procfs::ProcFile proc_net_udp6{"/proc/net/udp6", 16384};
+
+    // Перечисление сокетов через netlink; /proc/net/* — запасной путь
+    SockDiagClient sock_diag;
+    std::atomic<uint32_t> connection_states{kAllTcpStates};
+    std::atomic<size_t> connection_top_peers{10};
+    ConnectionAggregator connection_aggregator;  ///< Таблицы сводки, переиспользуются между сборами
+
+    // Датчики температуры (thermal_zone и hwmon), обнаруженные при создании
+    SensorRegistry sensor_registry;
+
+    // Адаптеры GPU (NVML, amdgpu), обнаруженные при создании
+    GpuBackend gpu_backend;
+
+    // Разделы: таблица монтирования по событиям mountinfo, statvfs с таймаутом
+    MountTable mount_table;
+    StatvfsProbe statvfs_probe;
+    DiskStatsTracker disk_stats;
+
+    // PSI, loadavg и vmstat для семейств cpu, memory и disk
+    PressureReader pressure_reader;
+
+    // Процессы: инкрементальный обход /proc/[pid] в семействе cpu
+    ProcessTable process_table;
+    std::atomic<size_t> process_top_n{10};
+
+    // Группы cgroup v2 (семейство cgroup), дерево перечитывается по inotify
+    CgroupTracker cgroup_tracker;
+
+    // S.M.A.R.T. дисков, обновляется фоновым потоком с большим TTL
+    SmartCache smart_cache{std::make_unique<LinuxSmartBackend>()};
 
     // For stateful CPU usage calculation
-    std::map<std::string, std::pair<uint64_t, uint64_t>> last_cpu_times;
+    std::vector<CpuTimes> last_cpu_times;    ///< Предыдущий снимок, в порядке /proc/stat
+    std::vector<CpuTimes> cur_cpu_times;     ///< Буфер текущего снимка
+    std::vector<double> last_core_usage;     ///< Последние посчитанные значения по ядрам
+    double last_cpu_usage = 0.0;             ///< Последнее посчитанное общее значение
+    std::atomic<int64_t> cpu_sample_window_ms{0};
+    std::mutex collect_mutex;                ///< Защищает буферы и состояние между сборами
+    std::string machine_type;                ///< Результат systemd-detect-virt, не меняется за время работы
+    InventoryCache inventory_cache;
+
+    // Статистика интерфейсов через RTM_GETLINK; /proc/net/dev — запасной путь
+    RtnetlinkClient rtnetlink;
+    std::vector<LinkInfo> link_buffer;       ///< Переиспользуемый буфер дампа
+    InterfaceRateTracker interface_rates;    ///< Скорости по разнице счетчиков
+    int ioctl_socket = -1;                   ///< Сокет для SIOCGIFINDEX / SIOCETHTOOL
+    int interface_index(std::string_view name);
+    uint32_t interface_speed_mbps(const std::string& name);
+
+    // Последние удачные значения семейств, которые пишут задачи пула
+    std::mutex results_mutex;
+    SystemMetrics last_good;
+    uint32_t updated_families = 0;           ///< Семейства, обновленные с начала текущего сбора
+    int64_t family_timeout_ms[9] = {5000, 5000, 5000, 5000, 5000, 30000, 5000, 30000, 5000};
 
-    // For stateful network bandwidth calculation
-    std::map<std::string, std::pair<uint64_t, uint64_t>> last_network_stats;
-    std::chrono::steady_clock::time_point last_network_collection_time;
+    // Последний член: разрушается первым и дожидается задач, которые
+    // обращаются к остальным полям
+    FamilyExecutor family_executor{4};
 };
 
-} // namespace monitoring 
\ No newline at end of file
+} // namespace monitoring
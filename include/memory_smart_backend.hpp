@@ -0,0 +1,68 @@
+/**
+ * @file memory_smart_backend.hpp
+ * @brief Источник S.M.A.R.T.-данных из памяти
+ *
+ * Подставляется в SmartCache вместо LinuxSmartBackend, чтобы проверить
+ * кэш, TTL и фоновое обновление без физических дисков. В сборку агента
+ * не входит.
+ */
+
+#pragma once
+
+#include "smart_reader.hpp"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace monitoring {
+
+/**
+ * @class MemorySmartBackend
+ * @brief Backend с заранее заданными данными — для проверки SmartCache без дисков
+ *
+ * Данные можно менять, пока backend принадлежит SmartCache: вызывающий
+ * сохраняет указатель перед передачей unique_ptr.
+ */
+class MemorySmartBackend : public SmartDeviceBackend {
+public:
+    void set(const std::string& device, const SmartData& data) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        devices_[device] = data;
+    }
+
+    void remove(const std::string& device) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        devices_.erase(device);
+    }
+
+    /// Сколько раз вызывался read() — по нему видно, обращался ли кэш к дискам
+    size_t read_count() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return reads_;
+    }
+
+    std::vector<std::string> list_devices() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<std::string> devices;
+        for (const auto& [name, data] : devices_) devices.push_back(name);
+        return devices;
+    }
+
+    bool read(const std::string& device, SmartData& out) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++reads_;
+        auto it = devices_.find(device);
+        if (it == devices_.end()) return false;
+        out = it->second;
+        return true;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::map<std::string, SmartData> devices_;
+    size_t reads_ = 0;
+};
+
+} // namespace monitoring
@@ -0,0 +1,108 @@
+/**
+ * @file metrics_cbor.hpp
+ * @brief Потоковая запись SystemMetrics в CBOR (RFC 8949)
+ *
+ * Тот же интерфейс, что у JsonWriter, поэтому семейства метрик пишутся по
+ * тем же схемам. Отличия от JSON:
+ * - объекты и массивы — неопределенной длины, размер заранее не считается;
+ * - числа с плавающей точкой — в самом коротком формате (half, float,
+ *   double), представляющем значение без потерь;
+ * - массивы double (core_usage, core_temperatures) — типизированные
+ *   массивы float64 little-endian (RFC 8746, тег 86);
+ * - внутри пространства строк (stringref, теги 256 и 25) повторная строка
+ *   заменяется номером первого вхождения — имена полей в массивах
+ *   процессов, разделов и cgroup и командные строки процессов, попавших
+ *   в несколько top-списков, передаются по одному разу.
+ */
+
+#pragma once
+
+#include "metrics_json.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace monitoring {
+
+/// Content-Type отправки метрик в CBOR
+inline constexpr const char* kCborContentType = "application/cbor";
+
+/**
+ * @class CborWriter
+ * @brief Запись CBOR в строку без промежуточного дерева
+ */
+class CborWriter {
+public:
+    /// Дописывает в out; очищать буфер перед новым документом — забота вызывающего
+    explicit CborWriter(std::string& out) : out_(out) {}
+
+    /**
+     * @brief Открывает пространство строк stringref для следующего объекта или массива
+     *
+     * Пространство закрывается вместе с этим объектом. Строки из него
+     * запоминаются по string_view: они должны жить до его закрытия.
+     */
+    void begin_string_namespace();
+
+    void begin_object();
+    void end_object();
+    void begin_array();
+    void end_array();
+
+    void key(std::string_view name) { text(name); }
+
+    void value(bool v);
+    /// NaN и бесконечность — null, как в JSON
+    void value(double v);
+    /// Некорректные последовательности UTF-8 заменяются на U+FFFD, как в JsonWriter
+    void value(std::string_view v) { text(v); }
+    void value(const char* v) { text(v); }
+    void value(const std::string& v) { text(v); }
+
+    template <typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, int> = 0>
+    void value(T v) {
+        if constexpr (std::is_signed_v<T>) {
+            if (v < 0) {
+                head(1, static_cast<uint64_t>(-(static_cast<int64_t>(v) + 1)));
+                return;
+            }
+        }
+        head(0, static_cast<uint64_t>(v));
+    }
+
+    void null();
+
+    /// Типизированный массив float64 little-endian (тег 86)
+    void number_array(const std::vector<double>& values);
+
+    /// Готовое закодированное значение (например, ранее записанное семейство)
+    void raw(std::string_view cbor);
+
+private:
+    void head(uint8_t major, uint64_t argument);
+    void text(std::string_view v);
+    void end_container();
+    /// Учитывает литеральную строку длины length в таблице stringref; true, если она туда попала
+    bool add_string(size_t length);
+
+    std::string& out_;
+    int depth_ = 0;
+    int namespace_depth_ = -1;  ///< Глубина, на которой открыто пространство строк; -1 — вне его
+    std::unordered_map<std::string_view, uint64_t> strings_;  ///< Строка -> номер в таблице stringref
+    uint64_t string_count_ = 0;  ///< Размер таблицы stringref, включая незапомненные строки
+};
+
+/**
+ * @brief Пишет семейство метрик как CBOR-объект в собственном пространстве строк
+ *
+ * Состав ключей и значений тот же, что у JSON-версии write_metric_family.
+ *
+ * @return false, если имя семейства неизвестно; тогда ничего не записано
+ */
+bool write_metric_family(CborWriter& w, const SystemMetrics& metrics, const std::string& family, bool full_connections);
+
+} // namespace monitoring
@@ -20,6 +20,83 @@
  */
 namespace monitoring {
 
+/**
+ * @struct PressureStall
+ * @brief Одна строка Pressure Stall Information ("some" или "full")
+ *
+ * avg10/avg60/avg300 — доля времени (0-100), когда задачи ждали ресурс,
+ * усредненная за 10, 60 и 300 секунд.
+ */
+struct PressureStall {
+    double avg10 = 0;
+    double avg60 = 0;
+    double avg300 = 0;
+    uint64_t total_us = 0;            ///< Накопленное время ожидания, мкс
+};
+
+/**
+ * @struct PressureInfo
+ * @brief PSI одного ресурса (/proc/pressure/cpu, memory, io)
+ */
+struct PressureInfo {
+    bool available = false;           ///< Ядро без PSI (CONFIG_PSI=n или psi=0) — false
+    PressureStall some;               ///< Ждала хотя бы одна задача
+    PressureStall full;               ///< Ждали все задачи, не простаивающие по другим причинам
+};
+
+/**
+ * @struct LoadAverage
+ * @brief Средняя загрузка из /proc/loadavg
+ */
+struct LoadAverage {
+    double load1 = 0;
+    double load5 = 0;
+    double load15 = 0;
+    uint32_t running = 0;             ///< Исполняемых задач в момент чтения
+    uint32_t total = 0;               ///< Всего задач (потоков) в системе
+};
+
+/**
+ * @struct PagingActivity
+ * @brief Подкачка страниц по счетчикам /proc/vmstat
+ */
+struct PagingActivity {
+    uint64_t major_faults = 0;        ///< pgmajfault с загрузки
+    uint64_t swap_in = 0;             ///< pswpin, страниц
+    uint64_t swap_out = 0;            ///< pswpout, страниц
+    double major_faults_per_sec = 0;
+    double swap_in_per_sec = 0;
+    double swap_out_per_sec = 0;
+};
+
+/**
+ * @struct ProcessInfo
+ * @brief Процесс в top-N (по /proc/[pid])
+ */
+struct ProcessInfo {
+    uint32_t pid = 0;
+    std::string name;                 ///< comm из /proc/[pid]/stat
+    std::string cmdline;              ///< Аргументы через пробел, не длиннее 512 байт
+    uint32_t uid = 0;                 ///< Владелец процесса
+    char state = '?';                 ///< R, S, D, Z, ...
+    uint32_t threads = 0;
+    double cpu_percent = 0;           ///< Доля одного ядра за интервал; у многопоточных может быть больше 100
+    uint64_t rss_bytes = 0;
+    double read_bytes_per_sec = 0;    ///< Чтение с устройств (read_bytes из /proc/[pid]/io)
+    double write_bytes_per_sec = 0;
+};
+
+/**
+ * @struct ProcessMetrics
+ * @brief Процессы, больше всего потребляющие CPU, память и ввод-вывод
+ */
+struct ProcessMetrics {
+    uint32_t total = 0;               ///< Всего процессов
+    std::vector<ProcessInfo> top_cpu;
+    std::vector<ProcessInfo> top_memory;
+    std::vector<ProcessInfo> top_io;
+};
+
 /**
  * @struct CpuMetrics
  * @brief Структура для хранения метрик центрального процессора
@@ -31,7 +108,11 @@ struct CpuMetrics {
     double usage_percent;              ///< Общее использование CPU в процентах (0-100)
     double temperature;                ///< Температура CPU в градусах Цельсия
     std::vector<double> core_temperatures; ///< Температуры ядер CPU
+    std::vector<std::string> core_temperature_labels; ///< Подписи датчиков для core_temperatures (тот же порядок)
     std::vector<double> core_usage;    ///< Использование каждого ядра в процентах
+    LoadAverage load;                  ///< Средняя загрузка за 1, 5 и 15 минут
+    PressureInfo pressure;             ///< Ожидание CPU (/proc/pressure/cpu)
+    ProcessMetrics processes;          ///< Top-N процессов; пусто, если set_process_top_n(0)
 };
 
 /**
@@ -46,6 +127,8 @@ struct MemoryMetrics {
     uint64_t used_bytes;              ///< Использованная память в байтах
     uint64_t free_bytes;              ///< Свободная память в байтах
     double usage_percent;             ///< Процент использования памяти (0-100)
+    PressureInfo pressure;            ///< Ожидание памяти (/proc/pressure/memory)
+    PagingActivity paging;            ///< Major page faults и swap
 };
 
 /**
@@ -62,10 +145,36 @@ struct DiskPartition {
     uint64_t used_bytes;              ///< Использовано байт
     uint64_t free_bytes;              ///< Свободно байт
     double usage_percent;             ///< Процент использования (0-100)
+    std::string device;               ///< Устройство или сетевой ресурс
+    bool unresponsive = false;        ///< statvfs не ответил вовремя: размеры неизвестны, usage_percent = -1
+    double read_bytes_per_sec = 0;    ///< Скорость чтения устройства раздела
+    double write_bytes_per_sec = 0;   ///< Скорость записи устройства раздела
+    double reads_per_sec = 0;         ///< Операций чтения в секунду
+    double writes_per_sec = 0;        ///< Операций записи в секунду
+};
+
+/**
+ * @struct BlockDeviceIo
+ * @brief Нагрузка на блочное устройство за последний интервал (/proc/diskstats)
+ */
+struct BlockDeviceIo {
+    std::string name;                 ///< "sda", "sda1", "nvme0n1", "dm-0"
+    std::string parent;               ///< Диск, которому принадлежит раздел; пусто для целого устройства
+    double reads_per_sec = 0;
+    double writes_per_sec = 0;
+    double read_bytes_per_sec = 0;
+    double write_bytes_per_sec = 0;
+    double read_await_ms = 0;         ///< Среднее время чтения, мс
+    double write_await_ms = 0;        ///< Среднее время записи, мс
+    double utilization_percent = 0;   ///< Доля времени, когда устройство было занято (0-100)
+    double queue_depth = 0;           ///< Средняя длина очереди за интервал
+    uint64_t in_flight = 0;           ///< Запросов в очереди в момент сбора
 };
 
 struct DiskMetrics {
     std::vector<DiskPartition> partitions; ///< Список разделов диска
+    std::vector<BlockDeviceIo> devices;    ///< Блочные устройства, по которым был ввод-вывод
+    PressureInfo io_pressure;              ///< Ожидание ввода-вывода (/proc/pressure/io)
 };
 
 /**
@@ -80,6 +189,7 @@ struct NetworkConnection {
     std::string remote_ip;     ///< Удалённый IP-адрес
     uint16_t remote_port;      ///< Удалённый порт
     std::string protocol;      ///< Протокол (TCP/UDP)
+    std::string state;         ///< Состояние сокета (ESTABLISHED, LISTEN, ...; для UDP — UNCONN)
 };
 
 /**
@@ -97,24 +207,78 @@ struct NetworkInterface {
     uint64_t packets_received;        ///< Получено пакетов
     uint64_t bandwidth_sent;          ///< Текущая скорость отправки (байт/с)
     uint64_t bandwidth_received;      ///< Текущая скорость получения (байт/с)
+    uint64_t packets_sent_rate = 0;     ///< Текущая скорость отправки (пакетов/с)
+    uint64_t packets_received_rate = 0; ///< Текущая скорость получения (пакетов/с)
+    uint64_t errors_sent = 0;         ///< Ошибок при отправке
+    uint64_t errors_received = 0;     ///< Ошибок при получении
+    uint64_t dropped_sent = 0;        ///< Отброшено пакетов при отправке
+    uint64_t dropped_received = 0;    ///< Отброшено пакетов при получении
+    bool carrier = false;             ///< Есть ли несущая (кабель/линк)
+    uint32_t mtu = 0;                 ///< MTU (0 — неизвестно)
+    std::string operstate;            ///< Состояние по RFC 2863: "up", "down", "dormant", ...
+    uint32_t speed_mbps = 0;          ///< Скорость линка в Мбит/с (0 — неизвестно)
+};
+
+/**
+ * @struct ConnectionSummary
+ * @brief Сводка по сетевым соединениям
+ *
+ * Количество сокетов по ключу (протокол, состояние, локальный порт) и самые
+ * частые удаленные адреса. Эфемерные локальные порты клиентских соединений
+ * сворачиваются в local_port = 0, чтобы число групп не росло с нагрузкой.
+ */
+struct ConnectionGroup {
+    std::string protocol;      ///< Протокол (TCP/UDP)
+    std::string state;         ///< Состояние сокета
+    uint16_t local_port;       ///< Локальный порт (0 — эфемерные порты)
+    uint32_t count;            ///< Количество сокетов в группе
+};
+
+struct RemotePeer {
+    std::string remote_ip;     ///< Удалённый IP-адрес
+    uint32_t count;            ///< Количество соединений с этим адресом
+};
+
+struct ConnectionSummary {
+    uint64_t total = 0;                      ///< Всего сокетов (после фильтра состояний)
+    std::vector<ConnectionGroup> groups;     ///< Группы по убыванию count
+    std::vector<RemotePeer> top_remote_peers; ///< Top-N удаленных адресов
 };
 
 struct NetworkMetrics {
     std::vector<NetworkInterface> interfaces; ///< Список сетевых интерфейсов
-    std::vector<NetworkConnection> connections; ///< Список активных сетевых соединений
+    std::vector<NetworkConnection> connections; ///< Список активных сетевых соединений (только по запросу)
+    ConnectionSummary connection_summary;     ///< Сводка по соединениям
+};
+
+/**
+ * @struct GpuDevice
+ * @brief Метрики одного графического адаптера
+ */
+struct GpuDevice {
+    std::string name;                 ///< Имя устройства: "card0" (DRM) или "nvidia0" (NVML)
+    std::string vendor;               ///< "nvidia" или "amd"
+    std::string model;                ///< Модель адаптера
+    std::string pci_address;          ///< Адрес на шине PCI, если известен
+    double temperature = -1.0;        ///< Температура в градусах Цельсия; -1 — нет датчика
+    double usage_percent = -1.0;      ///< Загрузка в процентах (0-100); -1 — не поддерживается
+    uint64_t memory_used = 0;         ///< Использовано видеопамяти в байтах
+    uint64_t memory_total = 0;        ///< Общий объем видеопамяти в байтах
 };
 
 /**
  * @struct GpuMetrics
  * @brief Структура для хранения метрик графического процессора
  * 
- * Содержит информацию о температуре, использовании и памяти GPU
+ * Содержит информацию о температуре, использовании и памяти GPU.
+ * Поля верхнего уровня повторяют первый адаптер из devices.
  */
 struct GpuMetrics {
     double temperature;               ///< Температура GPU в градусах Цельсия
     double usage_percent;             ///< Использование GPU в процентах (0-100)
     uint64_t memory_used;            ///< Использовано видеопамяти в байтах
     uint64_t memory_total;           ///< Общий объем видеопамяти в байтах
+    std::vector<GpuDevice> devices;  ///< Все обнаруженные адаптеры
 };
 
 /**
@@ -126,8 +290,8 @@ struct GpuMetrics {
  */
 struct HddDrive {
     std::string name;                 ///< Имя диска
-    double temperature;               ///< Температура в градусах Цельсия
-    uint64_t power_on_hours;          ///< Время работы в часах
+    double temperature = 0;           ///< Температура в градусах Цельсия
+    uint64_t power_on_hours = 0;      ///< Время работы в часах
     std::string health_status;        ///< Статус здоровья диска
 };
 
@@ -172,6 +336,41 @@ struct InventoryInfo {
     std::vector<std::string> mac_addresses;
     std::vector<std::string> ip_addresses;
     std::vector<std::string> installed_software;
+    std::vector<std::string> installed_software_versions; // Версии для installed_software (тот же порядок)
+    std::string content_hash;     // Хеш остальных полей; заполняет агент перед отправкой, пустой не передается
+};
+
+/**
+ * @struct CgroupInfo
+ * @brief Потребление ресурсов одной cgroup v2 (контейнер, systemd-юнит, слайс)
+ *
+ * Скорости посчитаны по разнице с прошлым сбором семейства; при первом
+ * сборе после появления группы они равны 0.
+ */
+struct CgroupInfo {
+    std::string path;                 ///< Путь от корня иерархии: "/system.slice/nginx.service"
+    double cpu_percent = 0;           ///< usage_usec за интервал, доля одного ядра
+    double cpu_user_percent = 0;
+    double cpu_system_percent = 0;
+    double throttled_percent = 0;     ///< Доля интервала, когда группа упиралась в cpu.max
+    uint64_t memory_current = 0;      ///< memory.current, байт
+    uint64_t memory_max = 0;          ///< memory.max, байт; 0 — без ограничения
+    uint64_t memory_anon = 0;         ///< anon из memory.stat
+    uint64_t memory_file = 0;         ///< file (страничный кэш) из memory.stat
+    double read_bytes_per_sec = 0;    ///< Сумма по устройствам из io.stat
+    double write_bytes_per_sec = 0;
+    double reads_per_sec = 0;
+    double writes_per_sec = 0;
+    PressureInfo cpu_pressure;        ///< cpu.pressure группы
+};
+
+/**
+ * @struct CgroupMetrics
+ * @brief Группы cgroup v2 (семейство "cgroup")
+ */
+struct CgroupMetrics {
+    bool available = false;           ///< Смонтирована иерархия cgroup v2
+    std::vector<CgroupInfo> groups;
 };
 
 /**
@@ -192,6 +391,8 @@ struct SystemMetrics {
     UserMetrics user;                 ///< Метрики текущего пользователя
     std::string machine_type;         ///< Тип устройства: "virtual" или "physical"
     InventoryInfo inventory;          ///< Инвентаризационная информация
+    CgroupMetrics cgroup;             ///< Ресурсы контейнеров и systemd-юнитов (cgroup v2)
+    uint32_t stale_families = 0;      ///< Семейства (MetricFamily), не успевшие к сроку: в них последние удачные значения
 };
 
 /**
@@ -214,11 +415,95 @@ public:
     virtual bool send(const SystemMetrics& metrics) = 0;
 };
 
+/**
+ * @enum MetricFamily
+ * @brief Семейства метрик (биты маски CollectOptions::families)
+ *
+ * Имена семейств совпадают с ключами enabled_metrics в конфигурации агента.
+ */
+enum MetricFamily : uint32_t {
+    kFamilyCpu       = 1u << 0,
+    kFamilyMemory    = 1u << 1,
+    kFamilyDisk      = 1u << 2,
+    kFamilyNetwork   = 1u << 3,
+    kFamilyGpu       = 1u << 4,
+    kFamilyHdd       = 1u << 5,
+    kFamilyUser      = 1u << 6,
+    kFamilyInventory = 1u << 7,
+    kFamilyCgroup    = 1u << 8,
+    kAllFamilies     = 0x1FFu
+};
+
+/// Бит семейства по имени ("cpu", "memory", ...); 0 — неизвестное имя
+inline uint32_t metric_family_bit(const std::string& name) {
+    static const char* const names[] = {"cpu", "memory", "disk", "network", "gpu", "hdd", "user", "inventory",
+                                          "cgroup"};
+    for (uint32_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        if (name == names[i]) return 1u << i;
+    }
+    return 0;
+}
+
+/**
+ * @struct CollectOptions
+ * @brief Параметры одного цикла сбора
+ */
+struct CollectOptions {
+    uint32_t families = kAllFamilies; ///< Какие семейства собирать; остальные поля SystemMetrics остаются пустыми
+    bool full_connections = false;    ///< Заполнить NetworkMetrics::connections полным списком сокетов
+};
+
 // Базовый абстрактный класс для сбора метрик
 class MetricsCollector {
 public:
     virtual ~MetricsCollector() = default;
+
+    /// Сбор всех семейств метрик
     virtual SystemMetrics collect() = 0;
+
+    /**
+     * @brief Сбор с параметрами цикла
+     *
+     * Реализации должны опрашивать только семейства из options.families —
+     * выключенные в enabled_metrics GPU, HDD или инвентаризация не должны
+     * стоить ни одного popen. Реализация по умолчанию игнорирует параметры
+     * и вызывает collect().
+     */
+    virtual SystemMetrics collect(const CollectOptions& /*options*/) { return collect(); }
+
+    /**
+     * @brief Окно "свежего" замера загрузки CPU (0 — дельта с предыдущим сбором)
+     *
+     * По умолчанию ничего не делает: коллекторы, которые считают загрузку
+     * CPU иначе, могут не переопределять этот метод.
+     */
+    virtual void set_cpu_sample_window(std::chrono::milliseconds /*window*/) {}
+
+    /**
+     * @brief Фильтр состояний TCP-соединений в NetworkMetrics::connections
+     * @param states Имена состояний ("ESTABLISHED", "LISTEN", ...); пустой список — все
+     */
+    virtual void set_connection_state_filter(const std::vector<std::string>& /*states*/) {}
+
+    /// Сколько удаленных адресов включать в ConnectionSummary::top_remote_peers
+    virtual void set_connection_top_peers(size_t /*top_peers*/) {}
+
+    /// Размер top-N процессов в CpuMetrics::processes; 0 — процессы не обходятся
+    virtual void set_process_top_n(size_t /*top_n*/) {}
+
+    /**
+     * @brief Срок сбора одного семейства
+     * @param family  Бит MetricFamily
+     * @param timeout Сколько ждать семейство; по истечении берется последнее
+     *                удачное значение, а семейство отмечается в stale_families
+     */
+    virtual void set_family_timeout(uint32_t /*family*/, std::chrono::milliseconds /*timeout*/) {}
+
+    /**
+     * @brief Файл для сохранения кэша инвентаризации между запусками
+     * @param path Пустая строка — кэш только в памяти
+     */
+    virtual void set_inventory_cache_path(const std::string& /*path*/) {}
 };
 
 std::unique_ptr<MetricsCollector> create_metrics_collector();
@@ -0,0 +1,98 @@
+/**
+ * @file metrics_json.hpp
+ * @brief Потоковая сериализация SystemMetrics в JSON без построения DOM
+ *
+ * Поля структур метрик описаны схемами времени компиляции (имя ключа и
+ * указатель на член, см. metrics_json.cpp). Значения пишутся за один
+ * проход прямо в строку, которую вызывающий переиспользует между
+ * отправками, поэтому в установившемся режиме сериализация не выделяет
+ * память. Состав ключей и типы значений совпадают с прежней сборкой через
+ * nlohmann::json; порядок ключей — порядок схемы.
+ */
+
+#pragma once
+
+#include "metrics_collector.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace monitoring {
+
+/**
+ * @class JsonWriter
+ * @brief Запись JSON в строку без промежуточного дерева
+ *
+ * Запятые между элементами расставляются автоматически; вложенность не
+ * проверяется — парность begin/end обеспечивает вызывающий.
+ */
+class JsonWriter {
+public:
+    /// Дописывает в out; очищать буфер перед новым документом — забота вызывающего
+    explicit JsonWriter(std::string& out) : out_(out) {}
+
+    void begin_object();
+    void end_object();
+    void begin_array();
+    void end_array();
+
+    /// Ключ объекта; ключи — ASCII-идентификаторы и не экранируются
+    void key(std::string_view name);
+
+    void value(bool v);
+    /// Кратчайшая запись, восстанавливающая то же число; NaN и бесконечность — null, как в nlohmann::json
+    void value(double v);
+    /**
+     * @brief Строка с экранированием
+     *
+     * Некорректные последовательности UTF-8 заменяются на U+FFFD: nlohmann::json
+     * в этом случае бросал исключение, и терялась вся отправка.
+     */
+    void value(std::string_view v);
+    void value(const char* v) { value(std::string_view(v)); }
+    void value(const std::string& v) { value(std::string_view(v)); }
+
+    template <typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, int> = 0>
+    void value(T v) {
+        if constexpr (std::is_signed_v<T>) {
+            write_signed(static_cast<int64_t>(v));
+        } else {
+            write_unsigned(static_cast<uint64_t>(v));
+        }
+    }
+
+    void null();
+
+    /// Массив чисел; общий интерфейс с CborWriter, который пишет его упакованным
+    void number_array(const std::vector<double>& values);
+
+    /// Готовый JSON-текст одного значения (например, ранее сериализованное семейство)
+    void raw(std::string_view json);
+
+private:
+    void separate();
+    void write_signed(int64_t v);
+    void write_unsigned(uint64_t v);
+
+    std::string& out_;
+    bool need_comma_ = false;
+};
+
+/// Длина корректной последовательности UTF-8 с первым байтом p[0] (>= 0x80); 0 — некорректна
+size_t utf8_sequence_length(const unsigned char* p, size_t available);
+
+/**
+ * @brief Пишет семейство метрик ("cpu", "memory", ...) как JSON-объект
+ *
+ * Семейство, не успевшее к сроку (SystemMetrics::stale_families), получает
+ * поле "stale": true.
+ *
+ * @param full_connections Писать network.connections, даже если есть сводка
+ * @return false, если имя семейства неизвестно; тогда ничего не записано
+ */
+bool write_metric_family(JsonWriter& w, const SystemMetrics& metrics, const std::string& family, bool full_connections);
+
+} // namespace monitoring
@@ -0,0 +1,51 @@
+/**
+ * @file mount_table.hpp
+ * @brief Таблица точек монтирования из /proc/self/mountinfo
+ *
+ * Файл перечитывается только после изменения таблицы: ядро сообщает о
+ * монтировании и размонтировании событием POLLPRI на открытом дескрипторе
+ * mountinfo, поэтому на каждом цикле достаточно poll() с нулевым таймаутом.
+ */
+
+#pragma once
+
+#include "procfs_reader.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace monitoring {
+
+struct MountEntry {
+    std::string mount_point;
+    std::string filesystem;  ///< Тип ФС ("ext4", "nfs4", ...)
+    std::string source;      ///< Устройство или сетевой ресурс ("/dev/sda1", "server:/export")
+    uint32_t major = 0;      ///< Номер устройства, как в /proc/diskstats
+    uint32_t minor = 0;
+    bool network = false;    ///< Сетевая ФС (NFS, CIFS, ...)
+};
+
+class MountTable {
+public:
+    explicit MountTable(std::string path = "/proc/self/mountinfo");
+
+    /**
+     * @brief Перечитывает таблицу, если она изменилась с прошлого вызова
+     * @return true, если таблица перечитана
+     */
+    bool refresh();
+
+    /// Блочные устройства (/dev/*) и сетевые ФС; псевдо-ФС отброшены
+    const std::vector<MountEntry>& entries() const { return entries_; }
+
+private:
+    bool changed();
+    void parse();
+
+    procfs::ProcFile file_;
+    std::vector<MountEntry> entries_;
+    bool loaded_ = false;
+};
+
+} // namespace monitoring
@@ -0,0 +1,35 @@
+/**
+ * @file package_db.hpp
+ * @brief Чтение списка установленных пакетов без запуска dpkg/rpm
+ *
+ * /var/lib/dpkg/status отображается в память и разбирается по строфам
+ * без аллокаций на каждую строку. База rpm читается через librpm,
+ * загружаемую dlopen(): формат базы (BerkeleyDB, NDB, sqlite) зависит от
+ * дистрибутива, а библиотека есть везде, где установлен rpm.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace monitoring {
+
+struct InstalledPackage {
+    std::string name;
+    std::string version;
+};
+
+/**
+ * @brief Пакеты в состоянии "installed" из файла статуса dpkg
+ * @return false, если файл не удалось открыть
+ */
+bool read_dpkg_status(const char* path, std::vector<InstalledPackage>& out);
+
+/**
+ * @brief Пакеты из базы rpm через librpm
+ * @return false, если librpm не найдена или базу не удалось открыть
+ */
+bool read_rpm_database(std::vector<InstalledPackage>& out);
+
+} // namespace monitoring
@@ -0,0 +1,59 @@
+/**
+ * @file pci_devices.hpp
+ * @brief Перечисление PCI-устройств через sysfs без запуска lspci
+ *
+ * Идентификаторы класса, производителя и устройства читаются из
+ * /sys/bus/pci/devices/<адрес>/{class,vendor,device}. Имена берутся из
+ * pci.ids (hwdata/pciutils), если файл установлен; в минимальных
+ * контейнерах остаются числовые идентификаторы.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace monitoring {
+
+struct PciDevice {
+    std::string address;      ///< Адрес на шине, например "0000:01:00.0"
+    uint32_t class_code = 0;  ///< Класс, подкласс и prog-if (0x030000 — VGA)
+    uint16_t vendor_id = 0;
+    uint16_t device_id = 0;
+    bool boot_vga = false;    ///< Основной видеоадаптер (атрибут boot_vga)
+};
+
+/// Класс 0x03xxxx: VGA, XGA, 3D-контроллеры и прочие видеоадаптеры
+inline bool is_display_controller(const PciDevice& device) {
+    return (device.class_code >> 16) == 0x03;
+}
+
+/**
+ * @brief Все PCI-устройства из <sysfs_root>/bus/pci/devices, по возрастанию адреса
+ *
+ * Корень sysfs задается параметром, чтобы разбор можно было проверить на
+ * подготовленном дереве каталогов.
+ */
+std::vector<PciDevice> enumerate_pci_devices(const std::string& sysfs_root = "/sys");
+
+/**
+ * @brief Ищет имена производителя и устройства в файле pci.ids
+ *
+ * Файл отображается в память и просматривается до нужного блока производителя.
+ * @return false, если файл не открылся или производитель не найден;
+ *         device_name остается пустым, если неизвестно только устройство
+ */
+bool lookup_pci_ids(const char* ids_path, uint16_t vendor_id, uint16_t device_id,
+                    std::string& vendor_name, std::string& device_name);
+
+/**
+ * @brief Название устройства "Производитель Устройство"
+ *
+ * Используется первый найденный pci.ids из стандартных путей. Результат
+ * кэшируется на время жизни процесса: каждая пара vendor:device ищется в
+ * файле один раз. Без pci.ids возвращается "[vvvv:dddd]".
+ */
+std::string pci_device_description(const PciDevice& device);
+
+} // namespace monitoring
@@ -0,0 +1,70 @@
+/**
+ * @file pressure_stats.hpp
+ * @brief Pressure Stall Information, средняя загрузка и подкачка страниц
+ *
+ * Читает /proc/pressure/{cpu,memory,io}, /proc/loadavg и счетчики
+ * pgmajfault/pswpin/pswpout из /proc/vmstat через ProcFile: дескрипторы
+ * остаются открытыми, разбор идет Scanner'ом без аллокаций.
+ */
+
+#pragma once
+
+#include "metrics_collector.hpp"
+#include "procfs_reader.hpp"
+
+#include <chrono>
+#include <string>
+#include <string_view>
+
+namespace monitoring {
+
+/**
+ * @brief Разбор текста PSI ("some avg10=... total=...", "full ...")
+ *
+ * Формат общий для /proc/pressure и файлов cpu.pressure, io.pressure в cgroup v2.
+ * out.available = true, если строка "some" разобрана.
+ */
+bool parse_pressure(std::string_view text, PressureInfo& out);
+
+/**
+ * @class PressureReader
+ * @brief Источник PSI, loadavg и vmstat для семейств cpu, memory и disk
+ *
+ * У каждого метода свой файл и свое состояние, поэтому семейства,
+ * собираемые параллельно, могут вызывать разные методы одновременно.
+ * Один и тот же метод из нескольких потоков сразу вызывать нельзя.
+ */
+class PressureReader {
+public:
+    enum class Resource { kCpu = 0, kMemory = 1, kIo = 2 };
+
+    explicit PressureReader(const std::string& proc_root = "/proc");
+
+    /**
+     * @brief Читает /proc/pressure/<resource>
+     * @return false, если PSI в ядре нет; out.available = false
+     */
+    bool read_pressure(Resource resource, PressureInfo& out);
+
+    /// Читает /proc/loadavg
+    bool read_load(LoadAverage& out);
+
+    /**
+     * @brief Читает pgmajfault/pswpin/pswpout и скорости с прошлого вызова
+     *
+     * При первом вызове скорости равны 0.
+     */
+    bool read_paging(PagingActivity& out);
+
+private:
+    procfs::ProcFile pressure_[3];
+    bool pressure_available_[3] = {false, false, false};  ///< Файл был при создании; PSI не включается на ходу
+    procfs::ProcFile loadavg_;
+    procfs::ProcFile vmstat_;
+
+    PagingActivity last_paging_;
+    std::chrono::steady_clock::time_point last_paging_time_;
+    bool has_last_paging_ = false;
+};
+
+} // namespace monitoring
@@ -0,0 +1,114 @@
+/**
+ * @file process_table.hpp
+ * @brief Таблица процессов по /proc/[pid] с инкрементальным обновлением
+ *
+ * /proc/[pid]/stat дорог: ядро собирает для него десятки полей под
+ * блокировками. Поэтому у однопоточного процесса каждый цикл читается
+ * schedstat (время на CPU в нс) через pread() по дескриптору, открытому
+ * при появлении процесса. schedstat учитывает только главный поток, так
+ * что число потоков проверяется каждый цикл по числу ссылок на
+ * /proc/[pid]/task, а многопоточные процессы читают stat. statm (RSS) и
+ * io перечитываются только у процессов, получивших процессорное время с
+ * прошлого цикла: спящий процесс не увеличивает RSS и не инициирует
+ * ввод-вывод. Имя, командная строка и владелец читаются один раз.
+ * Процессы, которым не хватило дескриптора (или ядро без schedstat),
+ * открывают файлы по pid, поэтому у них stat сверяет время запуска, чтобы
+ * не принять новый процесс с тем же pid за старый.
+ */
+
+#pragma once
+
+#include "metrics_collector.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace monitoring {
+
+/**
+ * @class ProcessTable
+ * @brief Процессы системы и их потребление ресурсов между вызовами update()
+ *
+ * Записи хранятся в векторе, упорядоченном по pid (в этом порядке ядро
+ * отдает каталог /proc), и сопоставляются с предыдущим обходом слиянием.
+ * Строки и дескрипторы переносятся между обходами перемещением, поэтому в
+ * установившемся режиме обновление не выделяет память и не открывает
+ * файлов. Дескриптор, открытый на завершившийся процесс, возвращает
+ * ошибку даже после переиспользования pid — так новый процесс с тем же
+ * pid отличается от старого.
+ *
+ * Дескриптор нужен на каждый процесс, поэтому при создании мягкий
+ * лимит RLIMIT_NOFILE поднимается до жесткого. Процессы сверх лимита
+ * читаются через open/read/close на каждом цикле.
+ */
+class ProcessTable {
+public:
+    explicit ProcessTable(std::string proc_root = "/proc");
+    ~ProcessTable();
+
+    ProcessTable(const ProcessTable&) = delete;
+    ProcessTable& operator=(const ProcessTable&) = delete;
+
+    /// Обходит /proc; CPU% и скорости считаются по разнице с прошлым вызовом
+    void update();
+
+    /**
+     * @brief Заполняет top-N по CPU, RSS и вводу-выводу
+     *
+     * Используется частичная сортировка: упорядочиваются только первые n.
+     * Состояние и число потоков перечитываются из stat только у них.
+     */
+    void top(size_t n, ProcessMetrics& out);
+
+    size_t size() const { return entries_.size(); }
+
+private:
+    struct Entry {
+        uint32_t pid = 0;
+        int schedstat_fd = -1;
+        std::string name;
+        std::string cmdline;
+        uint32_t uid = 0;
+        uint64_t starttime = 0;       ///< Поле 22 stat: отличает новый процесс с тем же pid
+        uint64_t cpu_ns = 0;          ///< Время на CPU с запуска
+        bool cpu_from_stat = false;   ///< cpu_ns взято из stat (все потоки), а не из schedstat
+        uint64_t rss_pages = 0;
+        uint64_t read_bytes = 0;
+        uint64_t write_bytes = 0;
+        bool io_denied = false;       ///< /proc/[pid]/io недоступен (чужой процесс без прав)
+        double cpu_percent = 0;
+        double read_bytes_per_sec = 0;
+        double write_bytes_per_sec = 0;
+    };
+
+    /// Читает pid/<file> в buffer_ через open/read/close; false, если процесс исчез
+    bool read_file(uint32_t pid, const char* file, std::string_view& out);
+    /// pread() по открытому дескриптору или read_file(), если дескриптора нет
+    bool read_counter_file(uint32_t pid, int fd, const char* file, std::string_view& out);
+    int open_counter_file(uint32_t pid, const char* file);
+    bool single_threaded(uint32_t pid);
+    bool read_cpu(Entry& entry);
+    bool read_rss(Entry& entry);
+    bool start_entry(Entry& entry);
+    void read_io(Entry& entry);
+    void close_entry(Entry& entry);
+    void fill(const Entry& entry, ProcessInfo& info);
+
+    std::string proc_root_;
+    int proc_fd_ = -1;
+    bool use_schedstat_ = true;       ///< Без CONFIG_SCHED_INFO время берется из stat
+    size_t fd_budget_ = 0;            ///< Сколько дескрипторов можно держать открытыми
+    size_t open_fds_ = 0;
+    std::vector<char> buffer_;
+    std::vector<Entry> entries_;      ///< Текущий обход, по возрастанию pid
+    std::vector<Entry> next_;         ///< Буфер следующего обхода
+    std::vector<uint32_t> order_;     ///< Индексы для частичной сортировки
+    std::chrono::steady_clock::time_point last_update_;
+    double ns_per_tick_ = 1e7;
+    uint64_t page_size_ = 4096;
+};
+
+} // namespace monitoring
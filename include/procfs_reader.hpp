@@ -0,0 +1,140 @@
+/**
+ * @file procfs_reader.hpp
+ * @brief Чтение файлов /proc и /sys без iostream и без аллокаций на каждом цикле
+ *
+ * ProcFile читает файл целиком через pread() в собственный буфер, который
+ * переиспользуется между вызовами. Scanner разбирает прочитанный текст
+ * по строкам и токенам, не создавая промежуточных строк.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace monitoring {
+namespace procfs {
+
+/**
+ * @class ProcFile
+ * @brief Файл /proc или /sys, перечитываемый в переиспользуемый буфер
+ *
+ * Дескриптор открывается при первом чтении и остается открытым: каждое
+ * следующее read() делает только pread(fd, ..., 0). Если чтение через
+ * сохраненный дескриптор не удалось (например, устройство в /sys исчезло),
+ * файл один раз переоткрывается. Буфер растет только тогда, когда
+ * содержимое файла в него не поместилось, поэтому в установившемся режиме
+ * чтение не выделяет память и не делает open/close.
+ */
+class ProcFile {
+public:
+    explicit ProcFile(std::string path, size_t initial_capacity = 4096);
+    ~ProcFile();
+
+    ProcFile(const ProcFile&) = delete;
+    ProcFile& operator=(const ProcFile&) = delete;
+    ProcFile(ProcFile&& other) noexcept;
+    ProcFile& operator=(ProcFile&& other) noexcept;
+
+    /**
+     * @brief Перечитывает файл с начала
+     * @return true, если файл удалось открыть и прочитать
+     */
+    bool read();
+
+    /// Закрывает дескриптор; следующий read() откроет файл заново
+    void close();
+
+    bool is_open() const { return fd_ >= 0; }
+
+    /// Дескриптор открытого файла (например, для poll()); -1 до первого read()
+    int fd() const { return fd_; }
+
+    /// Содержимое файла после последнего успешного read()
+    std::string_view data() const { return std::string_view(buffer_.data(), size_); }
+
+    const std::string& path() const { return path_; }
+
+private:
+    bool open();
+    bool read_from_fd();
+
+    std::string path_;
+    std::vector<char> buffer_;
+    size_t size_ = 0;
+    int fd_ = -1;
+};
+
+/**
+ * @class Scanner
+ * @brief Разбор текста /proc без аллокаций
+ *
+ * Все методы работают со string_view поверх буфера ProcFile. Разбор
+ * ведется в пределах текущей строки; next_line() переходит к следующей.
+ */
+class Scanner {
+public:
+    explicit Scanner(std::string_view text) : text_(text) {}
+
+    bool eof() const { return pos_ >= text_.size(); }
+
+    /// Конец текущей строки (или всего текста)
+    bool eol() const { return eof() || text_[pos_] == '\n'; }
+
+    /// Переходит на начало следующей строки; false, если строк больше нет
+    bool next_line();
+
+    /// Пропускает пробелы и табуляции в пределах строки
+    void skip_spaces();
+
+    /// Следующий токен текущей строки, разделенный пробелами
+    std::string_view token();
+
+    /// Часть токена до разделителя sep (разделитель пропускается)
+    std::string_view token_until(char sep);
+
+    /// Остаток текущей строки без ведущих пробелов
+    std::string_view rest_of_line();
+
+    /// Пропускает n токенов текущей строки
+    void skip_tokens(size_t n);
+
+    bool parse_u64(uint64_t& value);
+    bool parse_i64(int64_t& value);
+    bool parse_hex(uint64_t& value);
+
+    /// true, если текущая позиция начинается с prefix (позиция не меняется)
+    bool starts_with(std::string_view prefix) const;
+
+    /// Пропускает символ c, если он стоит в текущей позиции
+    bool consume(char c);
+
+private:
+    std::string_view text_;
+    size_t pos_ = 0;
+};
+
+/// Разбор десятичного числа из всей строки s
+bool parse_u64(std::string_view s, uint64_t& value);
+
+/// Разбор шестнадцатеричного числа из всей строки s
+bool parse_hex(std::string_view s, uint64_t& value);
+
+/**
+ * @brief Читает одно целое число из небольшого файла (например, датчика в /sys)
+ *
+ * Файл читается в буфер на стеке, без аллокаций.
+ */
+bool read_i64(const char* path, int64_t& value);
+
+/**
+ * @brief Форматирует IPv4-адрес из /proc/net (network byte order) в out
+ * @return Длина записанной строки
+ */
+size_t format_ipv4(uint32_t addr, char* out);
+
+} // namespace procfs
+} // namespace monitoring
@@ -0,0 +1,98 @@
+/**
+ * @file rtnetlink_links.hpp
+ * @brief Статистика сетевых интерфейсов через rtnetlink (RTM_GETLINK)
+ *
+ * Один дамп RTM_GETLINK возвращает для всех интерфейсов 64-битные счетчики
+ * (IFLA_STATS64), MTU, operstate и наличие несущей, поэтому текстовый
+ * разбор /proc/net/dev нужен только как запасной путь.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace monitoring {
+
+/**
+ * @struct LinkInfo
+ * @brief Данные одного интерфейса из ответа RTM_GETLINK
+ */
+struct LinkInfo {
+    int ifindex = 0;
+    std::string name;
+    unsigned int flags = 0;      ///< IFF_UP, IFF_LOOPBACK, ...
+    uint32_t mtu = 0;
+    uint8_t operstate = 0;       ///< IF_OPER_* из RFC 2863
+    bool carrier = false;
+    uint64_t rx_bytes = 0;
+    uint64_t tx_bytes = 0;
+    uint64_t rx_packets = 0;
+    uint64_t tx_packets = 0;
+    uint64_t rx_errors = 0;
+    uint64_t tx_errors = 0;
+    uint64_t rx_dropped = 0;
+    uint64_t tx_dropped = 0;
+};
+
+/// Имя operstate в нотации /sys/class/net/<if>/operstate ("up", "down", ...)
+const char* operstate_name(uint8_t operstate);
+
+/**
+ * @class RtnetlinkClient
+ * @brief Клиент NETLINK_ROUTE с переиспользуемым буфером приема
+ */
+class RtnetlinkClient {
+public:
+    RtnetlinkClient();
+    ~RtnetlinkClient();
+
+    RtnetlinkClient(const RtnetlinkClient&) = delete;
+    RtnetlinkClient& operator=(const RtnetlinkClient&) = delete;
+
+    /// Удалось ли открыть netlink-сокет
+    bool available() const { return fd_ >= 0; }
+
+    /**
+     * @brief Дамп всех интерфейсов
+     * @param out Заполняется заново; элементы и их строки переиспользуются между вызовами
+     * @return false, если дамп не удался — out в этом случае не определен
+     */
+    bool dump_links(std::vector<LinkInfo>& out);
+
+private:
+    int fd_ = -1;
+    uint32_t seq_ = 0;
+    std::vector<char> buffer_;
+};
+
+/**
+ * @class RtnetlinkMonitor
+ * @brief Подписка на уведомления rtnetlink об изменении интерфейсов и адресов
+ *
+ * Сокет неблокирующий: changed() только вычитывает то, что ядро уже
+ * положило в очередь, и никогда не ждет.
+ */
+class RtnetlinkMonitor {
+public:
+    /// @param groups Маска групп RTMGRP_* (например, RTMGRP_LINK | RTMGRP_IPV4_IFADDR)
+    explicit RtnetlinkMonitor(uint32_t groups);
+    ~RtnetlinkMonitor();
+
+    RtnetlinkMonitor(const RtnetlinkMonitor&) = delete;
+    RtnetlinkMonitor& operator=(const RtnetlinkMonitor&) = delete;
+
+    bool available() const { return fd_ >= 0; }
+
+    /**
+     * @brief Были ли уведомления с прошлого вызова
+     * @return true и при переполнении очереди (ENOBUFS) — часть событий потеряна
+     */
+    bool changed();
+
+private:
+    int fd_ = -1;
+};
+
+} // namespace monitoring
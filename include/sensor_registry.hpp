@@ -0,0 +1,75 @@
+/**
+ * @file sensor_registry.hpp
+ * @brief Реестр датчиков температуры Linux (thermal_zone и hwmon)
+ *
+ * Обход /sys/class/thermal и /sys/class/hwmon выполняется один раз при
+ * создании реестра и затем только по истечении интервала пересканирования
+ * или после ошибки чтения. Сбор значений — проход по плоскому вектору
+ * открытых файлов.
+ */
+
+#pragma once
+
+#include "procfs_reader.hpp"
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace monitoring {
+
+/**
+ * @struct TemperatureSensor
+ * @brief Один датчик температуры с открытым файлом значения
+ */
+struct TemperatureSensor {
+    enum class Kind { ThermalZone, Hwmon };
+
+    Kind kind;
+    procfs::ProcFile file;   ///< .../temp или .../tempN_input
+    std::string chip;        ///< Имя hwmon-чипа (name) или тип thermal zone (type)
+    std::string label;       ///< Содержимое tempN_label, для thermal zone — ее имя
+    double scale = 0.001;    ///< Множитель к значению файла (миллиградусы -> градусы)
+    int index = 0;           ///< N из tempN_input / thermal_zoneN (для сортировки)
+};
+
+/**
+ * @class SensorRegistry
+ * @brief Кэш топологии датчиков температуры
+ */
+class SensorRegistry {
+public:
+    /**
+     * @param sysfs_root Корень sysfs (для тестов можно подставить поддельное дерево)
+     * @param rescan_interval Как часто заново обходить каталоги датчиков
+     */
+    explicit SensorRegistry(std::string sysfs_root = "/sys",
+                            std::chrono::seconds rescan_interval = std::chrono::seconds(300));
+
+    /// Пересканирует каталоги, если истек интервал или было ошибочное чтение
+    void refresh_if_due();
+
+    /// Полный обход каталогов; открытые файлы сохранившихся датчиков переиспользуются
+    void rescan();
+
+    /**
+     * @brief Читает значение датчика в градусах Цельсия
+     * @return false при ошибке чтения (реестр будет пересканирован)
+     */
+    bool read(TemperatureSensor& sensor, double& celsius);
+
+    std::vector<TemperatureSensor>& sensors() { return sensors_; }
+
+    /// Подпись датчика для отчета: "chip: label"
+    static std::string display_name(const TemperatureSensor& sensor);
+
+private:
+    std::string root_;
+    std::chrono::seconds rescan_interval_;
+    std::chrono::steady_clock::time_point last_scan_;
+    bool read_failed_ = false;
+    std::vector<TemperatureSensor> sensors_;
+
+    static constexpr std::chrono::seconds kRetryInterval{10};
+};
+
+} // namespace monitoring
@@ -0,0 +1,116 @@
+/**
+ * @file smart_reader.hpp
+ * @brief Чтение S.M.A.R.T. напрямую через ioctl без запуска smartctl
+ *
+ * ATA-диски опрашиваются командой ATA PASS-THROUGH (16) через SG_IO,
+ * NVMe — командой Get Log Page (SMART / Health Information) через
+ * NVME_IOCTL_ADMIN_CMD. Атрибуты меняются медленно, поэтому SmartCache
+ * хранит результат с большим TTL и обновляет все диски параллельно в
+ * фоновом потоке, не задерживая цикл сбора метрик.
+ */
+
+#pragma once
+
+#include "metrics_collector.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace monitoring {
+
+/// Результат опроса одного диска
+struct SmartData {
+    double temperature = 0;              ///< Градусы Цельсия
+    uint64_t power_on_hours = 0;
+    std::string health_status = "Unknown";  ///< "OK", "FAILED" или "Unknown"
+};
+
+/**
+ * @class SmartDeviceBackend
+ * @brief Источник списка дисков и их S.M.A.R.T.-данных
+ *
+ * Отделен от SmartCache, чтобы кэш и расписание обновления можно было
+ * проверить без физических дисков (см. MemorySmartBackend в
+ * memory_smart_backend.hpp). read() вызывается из нескольких потоков
+ * одновременно для разных устройств.
+ */
+class SmartDeviceBackend {
+public:
+    virtual ~SmartDeviceBackend() = default;
+
+    /// Пути устройств, например "/dev/sda", "/dev/nvme0"
+    virtual std::vector<std::string> list_devices() = 0;
+
+    /// @return false, если устройство недоступно; без поддержки S.M.A.R.T. — true и статус "Unknown"
+    virtual bool read(const std::string& device, SmartData& out) = 0;
+};
+
+/**
+ * @class LinuxSmartBackend
+ * @brief Диски sd* и контроллеры NVMe из /sys/block, опрос через ioctl
+ *
+ * Требует прав root (CAP_SYS_RAWIO / CAP_SYS_ADMIN). SAS/SCSI-диски без
+ * трансляции ATA не поддерживаются и возвращаются со статусом "Unknown".
+ */
+class LinuxSmartBackend : public SmartDeviceBackend {
+public:
+    explicit LinuxSmartBackend(std::string sysfs_root = "/sys", std::string dev_root = "/dev");
+
+    std::vector<std::string> list_devices() override;
+    bool read(const std::string& device, SmartData& out) override;
+
+private:
+    std::string sysfs_root_;
+    std::string dev_root_;
+};
+
+/**
+ * @class SmartCache
+ * @brief S.M.A.R.T.-данные всех дисков с большим TTL
+ *
+ * Фоновый поток запускается при первом обращении. Когда данные старше
+ * TTL, snapshot() будит поток и ждет обновления не дольше wait_timeout;
+ * если диски отвечают дольше, возвращаются прежние значения. Поток
+ * опрашивает до kMaxParallel дисков одновременно.
+ */
+class SmartCache {
+public:
+    static constexpr size_t kMaxParallel = 8;
+
+    explicit SmartCache(std::unique_ptr<SmartDeviceBackend> backend,
+                        std::chrono::seconds ttl = std::chrono::minutes(30),
+                        std::chrono::milliseconds wait_timeout = std::chrono::seconds(10));
+    ~SmartCache();
+
+    SmartCache(const SmartCache&) = delete;
+    SmartCache& operator=(const SmartCache&) = delete;
+
+    /// Заполняет metrics.drives последними известными значениями
+    void snapshot(HddMetrics& metrics);
+
+private:
+    void worker_loop();
+    std::vector<HddDrive> refresh();
+
+    std::unique_ptr<SmartDeviceBackend> backend_;
+    std::chrono::seconds ttl_;
+    std::chrono::milliseconds wait_timeout_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread worker_;
+    bool stop_ = false;
+    bool refresh_requested_ = false;
+    bool refreshing_ = false;
+    uint64_t generation_ = 0;  ///< Число завершенных обновлений
+    std::chrono::steady_clock::time_point updated_at_;
+    std::vector<HddDrive> drives_;
+};
+
+} // namespace monitoring
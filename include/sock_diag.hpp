@@ -0,0 +1,108 @@
+/**
+ * @file sock_diag.hpp
+ * @brief Перечисление сокетов через netlink (NETLINK_SOCK_DIAG / inet_diag)
+ *
+ * Вместо построчного разбора /proc/net/tcp* и /proc/net/udp* ядро само
+ * отдает бинарные записи inet_diag_msg, а фильтр по состоянию TCP
+ * применяется на стороне ядра. Если netlink недоступен (нет модуля
+ * inet_diag, seccomp и т.п.), dump() возвращает false и вызывающий код
+ * переходит на разбор /proc.
+ */
+
+#pragma once
+
+#include "metrics_collector.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace monitoring {
+
+/// Маска всех состояний TCP (биты 1 << TCP_ESTABLISHED ... 1 << TCP_NEW_SYN_RECV)
+constexpr uint32_t kAllTcpStates = 0xFFFFFFFFu;
+
+/// Имя состояния TCP в нотации ядра ("ESTABLISHED", "LISTEN", ...)
+const char* tcp_state_name(uint8_t state);
+
+/// Имя состояния UDP-сокета: "ESTABLISHED" для connect()-нутых, иначе "UNCONN"
+const char* udp_state_name(uint8_t state);
+
+/**
+ * @brief Маска состояний по списку имен
+ * @param names Имена состояний TCP без учета регистра; пустой список — все состояния
+ */
+uint32_t tcp_state_mask(const std::vector<std::string>& names);
+
+/**
+ * @struct SocketRecord
+ * @brief Сырые данные одного сокета, без строк и аллокаций
+ *
+ * Адреса хранятся в сетевом порядке байт: для AF_INET используются
+ * первые 4 байта, для AF_INET6 — все 16.
+ */
+struct SocketRecord {
+    uint8_t family;        ///< AF_INET или AF_INET6
+    uint8_t protocol;      ///< IPPROTO_TCP или IPPROTO_UDP
+    uint8_t state;         ///< Состояние в нумерации ядра (TCP_ESTABLISHED = 1, ...)
+    uint16_t local_port;   ///< Порт в порядке байт хоста
+    uint16_t remote_port;  ///< Порт в порядке байт хоста
+    uint8_t local_addr[16];
+    uint8_t remote_addr[16];
+};
+
+/**
+ * @class SocketSink
+ * @brief Получатель потока SocketRecord (список соединений, агрегатор и т.п.)
+ */
+class SocketSink {
+public:
+    virtual ~SocketSink() = default;
+    virtual void on_socket(const SocketRecord& record) = 0;
+};
+
+/**
+ * @class ConnectionListSink
+ * @brief Превращает SocketRecord в полные записи NetworkConnection
+ */
+class ConnectionListSink : public SocketSink {
+public:
+    explicit ConnectionListSink(std::vector<NetworkConnection>& out) : out_(out) {}
+    void on_socket(const SocketRecord& record) override;
+
+private:
+    std::vector<NetworkConnection>& out_;
+};
+
+/**
+ * @class SockDiagClient
+ * @brief Клиент NETLINK_SOCK_DIAG с переиспользуемым буфером приема
+ */
+class SockDiagClient {
+public:
+    SockDiagClient();
+    ~SockDiagClient();
+
+    SockDiagClient(const SockDiagClient&) = delete;
+    SockDiagClient& operator=(const SockDiagClient&) = delete;
+
+    /// Удалось ли открыть netlink-сокет
+    bool available() const { return fd_ >= 0; }
+
+    /**
+     * @brief Дамп сокетов одного семейства и протокола
+     * @param family AF_INET или AF_INET6
+     * @param protocol IPPROTO_TCP или IPPROTO_UDP
+     * @param states Маска состояний, фильтруется ядром
+     * @param sink Получает записи по мере разбора ответов ядра
+     * @param delivered Сколько записей было передано в sink
+     * @return false, если дамп не удался (в том числе на середине ответа)
+     */
+    bool dump(int family, int protocol, uint32_t states, SocketSink& sink, size_t& delivered);
+
+private:
+    int fd_ = -1;
+    uint32_t seq_ = 0;
+    std::vector<char> buffer_;
+};
+
+} // namespace monitoring
@@ -0,0 +1,71 @@
+/**
+ * @file statvfs_probe.hpp
+ * @brief statvfs() с таймаутом и карантином зависших точек монтирования
+ *
+ * statvfs на недоступном NFS-сервере или умирающем диске может не
+ * вернуться никогда, и прервать его нельзя. Поэтому вызов выполняется в
+ * отдельном потоке; если он не уложился в таймаут, поток оставляется
+ * дожидаться ответа ядра, а точка монтирования попадает в карантин и не
+ * опрашивается, пока зависший вызов не завершится. Следующие запросы
+ * обслуживает новый поток.
+ */
+
+#pragma once
+
+#include <sys/statvfs.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace monitoring {
+
+class StatvfsProbe {
+public:
+    enum class Result {
+        kOk,
+        kError,        ///< statvfs вернул ошибку
+        kTimeout,      ///< не ответил за таймаут, точка отправлена в карантин
+        kQuarantined,  ///< предыдущий вызов для этой точки еще не вернулся
+    };
+
+    explicit StatvfsProbe(std::chrono::milliseconds timeout = std::chrono::seconds(2));
+    ~StatvfsProbe();
+
+    StatvfsProbe(const StatvfsProbe&) = delete;
+    StatvfsProbe& operator=(const StatvfsProbe&) = delete;
+
+    void set_timeout(std::chrono::milliseconds timeout) { timeout_ = timeout; }
+
+    Result stat(const std::string& path, struct statvfs& out);
+
+    /// Сколько точек сейчас в карантине
+    size_t quarantined_count();
+
+private:
+    /// Состояние потока; разделяется с потоком, который может пережить объект
+    struct Worker {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::string path;
+        struct statvfs buf {};
+        int rc = 0;
+        bool pending = false;  ///< Запрос передан и еще не выполнен
+        bool stop = false;
+    };
+
+    static void worker_loop(std::shared_ptr<Worker> worker);
+    void start_worker();
+    void release_finished();
+
+    std::chrono::milliseconds timeout_;
+    std::shared_ptr<Worker> worker_;
+    std::thread thread_;
+    std::map<std::string, std::shared_ptr<Worker>> quarantine_;
+};
+
+} // namespace monitoring
@@ -14,6 +14,7 @@ public:
     ~WindowsMetricsCollector() override;
     
     SystemMetrics collect() override;
+    SystemMetrics collect(const CollectOptions& options) override;
 
 private:
     CpuMetrics collect_cpu_metrics();
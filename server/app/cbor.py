@@ -0,0 +1,194 @@
+"""Декодер CBOR (RFC 8949) для метрик агента.
+
+Кроме основных типов поддерживает расширения, которыми пользуется агент:
+- stringref (теги 256 и 25): повторная строка передается номером первого
+  вхождения в пределах пространства строк;
+- типизированные массивы чисел с плавающей точкой (RFC 8746, теги 80-86):
+  раскрываются в списки float.
+Прочие теги возвращают свое содержимое без изменений.
+"""
+
+import struct
+from typing import Any, List
+
+CBOR_CONTENT_TYPE = "application/cbor"
+
+TAG_STRINGREF = 25
+TAG_STRINGREF_NAMESPACE = 256
+
+# Тег типизированного массива -> (порядок байтов, формат struct, размер элемента)
+TYPED_FLOAT_ARRAYS = {
+    80: (">", "e", 2), 81: (">", "f", 4), 82: (">", "d", 8),
+    84: ("<", "e", 2), 85: ("<", "f", 4), 86: ("<", "d", 8),
+}
+
+
+class CBORDecodeError(ValueError):
+    """Некорректный или усеченный документ CBOR"""
+
+
+_BREAK = object()
+
+
+def _stringref_min_length(count: int) -> int:
+    """Минимальная длина строки, попадающей в таблицу stringref размера count"""
+    if count < 24:
+        return 3
+    if count < 256:
+        return 4
+    if count < 65536:
+        return 5
+    if count < 4294967296:
+        return 7
+    return 11
+
+
+class _Decoder:
+    def __init__(self, data: bytes):
+        self.data = memoryview(data)
+        self.pos = 0
+        self.namespaces: List[list] = []
+
+    def read(self, length: int) -> memoryview:
+        end = self.pos + length
+        if end > len(self.data):
+            raise CBORDecodeError("Неожиданный конец данных")
+        chunk = self.data[self.pos:end]
+        self.pos = end
+        return chunk
+
+    def argument(self, info: int) -> int:
+        if info < 24:
+            return info
+        if info == 24:
+            return self.read(1)[0]
+        if info == 25:
+            return struct.unpack(">H", self.read(2))[0]
+        if info == 26:
+            return struct.unpack(">I", self.read(4))[0]
+        if info == 27:
+            return struct.unpack(">Q", self.read(8))[0]
+        raise CBORDecodeError(f"Недопустимое значение дополнительной информации: {info}")
+
+    def remember(self, value, length: int):
+        """Строки определенной длины внутри пространства stringref нумеруются по порядку"""
+        if self.namespaces:
+            table = self.namespaces[-1]
+            if length >= _stringref_min_length(len(table)):
+                table.append(value)
+
+    def string(self, major: int, info: int):
+        if info == 31:
+            # Строка неопределенной длины — последовательность частей того же типа
+            chunks = []
+            while True:
+                initial = self.read(1)[0]
+                if initial == 0xFF:
+                    break
+                if initial >> 5 != major or initial & 0x1F == 31:
+                    raise CBORDecodeError("Некорректная часть строки неопределенной длины")
+                chunks.append(bytes(self.read(self.argument(initial & 0x1F))))
+            raw = b"".join(chunks)
+            return raw if major == 2 else self.text(raw)
+        length = self.argument(info)
+        raw = bytes(self.read(length))
+        value = raw if major == 2 else self.text(raw)
+        self.remember(value, length)
+        return value
+
+    @staticmethod
+    def text(raw: bytes) -> str:
+        try:
+            return raw.decode("utf-8")
+        except UnicodeDecodeError as e:
+            raise CBORDecodeError(f"Некорректная строка UTF-8: {e}") from None
+
+    def tagged(self, tag: int):
+        if tag == TAG_STRINGREF_NAMESPACE:
+            self.namespaces.append([])
+            try:
+                return self.decode()
+            finally:
+                self.namespaces.pop()
+        if tag == TAG_STRINGREF:
+            index = self.decode()
+            if not self.namespaces or not isinstance(index, int) or not 0 <= index < len(self.namespaces[-1]):
+                raise CBORDecodeError(f"Ссылка на неизвестную строку: {index}")
+            return self.namespaces[-1][index]
+
+        value = self.decode()
+        if tag in TYPED_FLOAT_ARRAYS:
+            byte_order, code, size = TYPED_FLOAT_ARRAYS[tag]
+            if not isinstance(value, bytes) or len(value) % size != 0:
+                raise CBORDecodeError(f"Некорректный типизированный массив (тег {tag})")
+            return list(struct.unpack(f"{byte_order}{len(value) // size}{code}", value))
+        return value
+
+    def decode(self) -> Any:
+        initial = self.read(1)[0]
+        major, info = initial >> 5, initial & 0x1F
+
+        if major == 0:
+            return self.argument(info)
+        if major == 1:
+            return -1 - self.argument(info)
+        if major in (2, 3):
+            return self.string(major, info)
+        if major == 4:
+            items = []
+            if info == 31:
+                while (item := self.decode()) is not _BREAK:
+                    items.append(item)
+            else:
+                for _ in range(self.argument(info)):
+                    items.append(self.item())
+            return items
+        if major == 5:
+            result = {}
+            count = None if info == 31 else self.argument(info)
+            while count is None or len(result) < count:
+                key = self.decode()
+                if key is _BREAK and count is None:
+                    break
+                if key is _BREAK or isinstance(key, (list, dict)):
+                    raise CBORDecodeError("Недопустимый ключ объекта")
+                result[key] = self.item()
+            return result
+        if major == 6:
+            return self.tagged(self.argument(info))
+
+        # major == 7: простые значения и числа с плавающей точкой
+        if info == 20:
+            return False
+        if info == 21:
+            return True
+        if info in (22, 23):
+            return None
+        if info == 25:
+            return struct.unpack(">e", self.read(2))[0]
+        if info == 26:
+            return struct.unpack(">f", self.read(4))[0]
+        if info == 27:
+            return struct.unpack(">d", self.read(8))[0]
+        if info == 31:
+            return _BREAK
+        raise CBORDecodeError(f"Неподдерживаемое простое значение: {info}")
+
+    def item(self) -> Any:
+        """Значение, которое не может быть концом контейнера"""
+        value = self.decode()
+        if value is _BREAK:
+            raise CBORDecodeError("Неожиданный break")
+        return value
+
+
+def loads(data: bytes) -> Any:
+    """Разбирает один документ CBOR; лишние байты после него — ошибка"""
+    decoder = _Decoder(data)
+    try:
+        value = decoder.item()
+    except RecursionError:
+        raise CBORDecodeError("Слишком глубокая вложенность") from None
+    if decoder.pos != len(decoder.data):
+        raise CBORDecodeError("Лишние данные после документа")
+    return value
@@ -32,6 +32,7 @@ class Agent(Base):
     max_script_timeout_sec = Column(Integer, default=60)
     send_timeout_ms = Column(Integer, default=2000)
     update_frequency = Column(Integer, default=60)
+    config_hash = Column(String(16))  # Хеш последней конфигурации, присланной агентом
     created_at = Column(DateTime(timezone=True), default=datetime.utcnow)
     last_heartbeat = Column(DateTime(timezone=True))
     
@@ -121,7 +122,7 @@ class AgentMetric(Base):
     # Ограничения
     __table_args__ = (
         CheckConstraint("machine_type IN ('physical', 'virtual')", name="check_machine_type"),
-        CheckConstraint("metric_type IN ('cpu', 'memory', 'disk', 'network', 'gpu', 'hdd', 'user', 'inventory')", name="check_metric_type"),
+        CheckConstraint("metric_type IN ('cpu', 'memory', 'disk', 'network', 'gpu', 'hdd', 'user', 'inventory', 'cgroup')", name="check_metric_type"),
     )
 
 class MetricNetworkConnection(Base):
@@ -1,6 +1,6 @@
-from fastapi import FastAPI, HTTPException, BackgroundTasks, Request
+from fastapi import FastAPI, HTTPException, BackgroundTasks, Request, Depends, status
 from fastapi.middleware.cors import CORSMiddleware
-from pydantic import BaseModel
+from pydantic import BaseModel, ValidationError
 import uvicorn
 from datetime import datetime
 import json
@@ -11,6 +11,7 @@ import os
 from .database.connection import init_db, close_db, get_db
 from .database.api import create_agent, agent_exists, save_metric, get_agent
 from .api.agents import router as agents_router
+from . import cbor
 
 def clean_null_characters(data):
     """Очищает null-символы из данных"""
@@ -45,7 +46,8 @@ class MetricsData(BaseModel):
     machine_type: str
     agent_id: Optional[str] = None
     machine_name: Optional[str] = None
-    config: Optional[Dict[str, Any]] = None  # Конфигурация агента
+    config: Optional[Dict[str, Any]] = None  # Конфигурация агента, только при ее изменении
+    config_hash: Optional[str] = None  # Хеш конфигурации агента, в каждой отправке
     cpu: Optional[Dict[str, Any]] = None
     memory: Optional[Dict[str, Any]] = None
     disk: Optional[Dict[str, Any]] = None
@@ -54,6 +56,33 @@ class MetricsData(BaseModel):
     hdd: Optional[Dict[str, Any]] = None
     user: Optional[Dict[str, Any]] = None
     inventory: Optional[Dict[str, Any]] = None
+    cgroup: Optional[Dict[str, Any]] = None
+
+# Кодировки тела /metrics; агент с metrics_encoding "auto" переходит на CBOR, увидев его в ответе
+METRICS_ENCODINGS = ["json", "cbor"]
+
+async def read_metrics_body(request: Request) -> MetricsData:
+    """Разбор тела /metrics по Content-Type: application/json или application/cbor"""
+    content_type = request.headers.get("content-type", "application/json").split(";")[0].strip().lower()
+    body = await request.body()
+    try:
+        if content_type == cbor.CBOR_CONTENT_TYPE:
+            data = cbor.loads(body)
+        elif content_type == "application/json":
+            data = json.loads(body)
+        else:
+            raise HTTPException(
+                status_code=status.HTTP_415_UNSUPPORTED_MEDIA_TYPE,
+                detail=f"Неподдерживаемый Content-Type: {content_type}"
+            )
+    except (ValueError, UnicodeDecodeError) as e:
+        raise HTTPException(status_code=status.HTTP_400_BAD_REQUEST, detail=f"Некорректное тело запроса: {e}")
+    if not isinstance(data, dict):
+        raise HTTPException(status_code=status.HTTP_400_BAD_REQUEST, detail="Ожидался объект метрик")
+    try:
+        return MetricsData(**data)
+    except ValidationError as e:
+        raise HTTPException(status_code=status.HTTP_422_UNPROCESSABLE_ENTITY, detail=e.errors())
 
 # Подключаем роутеры
 app.include_router(agents_router)
@@ -92,7 +121,7 @@ async def root():
     }
 
 @app.post("/metrics")
-async def receive_metrics(metrics: MetricsData, request: Request):
+async def receive_metrics(request: Request, metrics: MetricsData = Depends(read_metrics_body)):
     """Получение метрик от агента"""
     from .database.connection import get_db
     from .database.api import create_agent, save_metric, agent_exists
@@ -122,7 +151,7 @@ async def receive_metrics(metrics: MetricsData, request: Request):
                     "agent_id": agent_id,
                     "machine_name": metrics.machine_name or "Unknown Machine",
                     "agent_ip": client_ip,  # Используем реальный IP адрес агента 
-                    "server_url": metrics.config.get("server_url", f"http://{client_ip}:8000"),  # Используем server_url из конфига агента
+                    "server_url": (metrics.config or {}).get("server_url", f"http://{client_ip}:8000"),  # Используем server_url из конфига агента
                     "auto_detect_id": True,
                     "auto_detect_name": True
                 }
@@ -245,10 +274,22 @@ async def receive_metrics(metrics: MetricsData, request: Request):
                                     })
                                 
                                 print(f"⚙️ Обновлены пользовательские параметры агента {agent_id}: {sorted(new_param_keys)}")
+                    
+                    # Запоминаем хеш полученной конфигурации
+                    if metrics.config_hash and metrics.config_hash != current_agent.config_hash:
+                        await update_agent_config(db, agent_id, {"config_hash": metrics.config_hash})
+            
+            # Агент прислал только хеш, а такой конфигурации у сервера нет — просим полную
+            config_required = False
+            if metrics.config is None and metrics.config_hash:
+                current_agent = await get_agent(db, agent_id)
+                config_required = current_agent is None or current_agent.config_hash != metrics.config_hash
+                if config_required:
+                    print(f"🔧 Неизвестный хеш конфигурации агента {agent_id}: {metrics.config_hash}")
             
             # Сохраняем метрики
             for metric_type, metric_data in metrics.dict().items():
-                if metric_type in ['cpu', 'memory', 'disk', 'network', 'gpu', 'hdd', 'user', 'inventory'] and metric_data:
+                if metric_type in ['cpu', 'memory', 'disk', 'network', 'gpu', 'hdd', 'user', 'inventory', 'cgroup'] and metric_data:
                     # Очищаем null-символы из данных
                     cleaned_data = clean_null_characters(metric_data)
                     
@@ -278,7 +319,9 @@ async def receive_metrics(metrics: MetricsData, request: Request):
         return {
             "status": "success", 
             "message": "Metrics received and saved",
-            "agent_id": agent_id
+            "agent_id": agent_id,
+            "config_required": config_required,
+            "encodings": METRICS_ENCODINGS
         }
     except Exception as e:
         print(f"❌ Ошибка при обработке метрик: {e}")
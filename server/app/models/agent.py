@@ -17,6 +17,7 @@ class MetricType(str, Enum):
     HDD = "hdd"
     INVENTORY = "inventory"
     USER = "user"
+    CGROUP = "cgroup"
 
 class AgentRegistration(BaseModel):
     """Данные для регистрации агента"""
@@ -36,7 +37,8 @@ class AgentConfig(BaseModel):
         "gpu": False,
         "hdd": False,
         "inventory": True,
-        "user": True
+        "user": True,
+        "cgroup": False
     }
     server_url: str = "http://localhost:8000/metrics"
     agent_id: Optional[str] = None
@@ -20,6 +20,7 @@ class MetricType(str, Enum):
     HDD = "hdd"
     USER = "user"
     INVENTORY = "inventory"
+    CGROUP = "cgroup"
 
 class Protocol(str, Enum):
     TCP = "TCP"
@@ -1,4 +1,6 @@
 #include "agent_api.hpp"
+#include "../include/metrics_cbor.hpp"
+#include "../include/metrics_json.hpp"
 #include <iostream>
 #include <sstream>
 #include <chrono>
@@ -11,6 +13,7 @@
 #include <random>
 #include <functional>
 #include <algorithm>
+#include <cstdio>
 
 #ifdef _WIN32
 #include <winsock2.h>
@@ -328,6 +331,18 @@ static bool is_subpath(const std::filesystem::path& base, const std::filesystem:
     }
 }
 
+// FNV-1a от сериализованного семейства (порядок ключей задан схемой и не меняется)
+static std::string content_hash(std::string_view json) {
+    uint64_t h = 14695981039346656037ull;
+    for (unsigned char c : json) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(h));
+    return hex;
+}
+
 static std::string substitute_params(const std::string& templ,
                                      const std::vector<std::string>& params) {
     std::string out = templ;
@@ -1083,19 +1098,18 @@ MonitoringServerClient::MonitoringServerClient(const AgentConfig& config) : conf
             
 }
 
-bool MonitoringServerClient::send_metrics(const nlohmann::json& metrics) {
+bool MonitoringServerClient::send_metrics(const std::string& body) {
+    nlohmann::json response;
+    long status = 0;
+    return send_metrics(body, MetricsEncoding::Json, response, status);
+}
+
+bool MonitoringServerClient::send_metrics(const std::string& body, MetricsEncoding encoding, nlohmann::json& response,
+                                          long& status) {
     try {
-        // Добавляем информацию об агенте
-        nlohmann::json data = metrics;
-        data["agent_id"] = agent_id_;
-        data["machine_name"] = machine_name_;
-        
-        // Проверяем корректность JSON перед отправкой
-        std::string json_str = data.dump();
-        
-        
-        nlohmann::json response;
-        bool success = make_request("/metrics", data, response);
+        const char* content_type =
+            encoding == MetricsEncoding::Cbor ? monitoring::kCborContentType : "application/json; charset=utf-8";
+        bool success = make_request("/metrics", body, content_type, response, &status);
         
         if (success) {
             
@@ -1125,7 +1139,7 @@ bool MonitoringServerClient::register_agent() {
 bool MonitoringServerClient::update_config_from_server() {
     try {
         nlohmann::json response;
-        if (make_request("/api/agents/" + agent_id_ + "/config", {}, response)) {
+        if (make_request("/api/agents/" + agent_id_ + "/config", nlohmann::json{}, response)) {
             // Обновляем конфигурацию
             config_.update_from_json(response);
             
@@ -1139,30 +1153,33 @@ bool MonitoringServerClient::update_config_from_server() {
 }
 
 bool MonitoringServerClient::make_request(const std::string& endpoint, const nlohmann::json& data, nlohmann::json& response) {
+    // Проверяем корректность JSON данных
+    std::string json_body;
     try {
-        
-        
+        json_body = data.dump();
+    } catch (const std::exception& e) {
+
+        return false;
+    }
+    return make_request(endpoint, json_body, "application/json; charset=utf-8", response);
+}
+
+bool MonitoringServerClient::make_request(const std::string& endpoint, const std::string& body, const char* content_type,
+                                          nlohmann::json& response, long* status) {
+    try {
+
+
         std::string url;
         // Всегда используем базовый URL + endpoint
         url = config_.server_url + endpoint;
-                    
-        
-        // Проверяем корректность JSON данных
-        std::string json_body;
-        try {
-            json_body = data.dump();
-                    
-        } catch (const std::exception& e) {
-            
-            return false;
-        }
-        
+
         auto cpr_response = cpr::Post(
             cpr::Url{url},
-            cpr::Header{{"Content-Type", "application/json; charset=utf-8"}},
-            cpr::Body{json_body},
+            cpr::Header{{"Content-Type", content_type}},
+            cpr::Body{body},
             cpr::Timeout{config_.send_timeout_ms}
         );
+        if (status) *status = cpr_response.status_code;
         
         if (cpr_response.status_code == 200) {
             if (!cpr_response.text.empty()) {
@@ -1188,6 +1205,7 @@ AgentManager::AgentManager(const AgentConfig& config, const std::string& config_
     initialize_metrics_collector();
     http_server_ = std::make_unique<AgentHttpServer>(config_, this);
     server_client_ = std::make_unique<MonitoringServerClient>(config_);
+    refresh_config_snapshot();
 }
 
 AgentManager::~AgentManager() {
@@ -1248,10 +1266,21 @@ CommandResponse AgentManager::handle_collect_metrics(const Command& cmd) {
             }
         }
         
-        auto metrics = collect_metrics(requested_metrics);
-        server_client_->send_metrics(metrics);
-        
-        return CommandResponse{true, "Metrics collected and sent", metrics, current_iso_time()};
+        // Полный список соединений — только по явному запросу: {"connections": "full"}
+        bool full_connections = cmd.data.contains("connections") && cmd.data["connections"].is_string() &&
+                                cmd.data["connections"].get<std::string>() == "full";
+
+        const auto families = requested_metrics.empty() ? config_.get_enabled_metrics_list() : requested_metrics;
+        MetricsBatch batch;
+        collect_metrics(families, batch, full_connections);
+        std::string body;
+        const std::string config_sent = write_metrics_payload(batch, families, body);
+        nlohmann::json response;
+        long status = 0;
+        confirm_config_sent(config_sent, server_client_->send_metrics(body, batch.encoding, response, status), response);
+
+        // Ответ на команду — тот же документ (всегда JSON); разбирается только здесь, не в плановой отправке
+        return CommandResponse{true, "Metrics collected and sent", nlohmann::json::parse(body), current_iso_time()};
     } catch (const std::exception& e) {
         return CommandResponse{false, "Error collecting metrics: " + std::string(e.what()), {}, current_iso_time()};
     }
@@ -1260,7 +1289,10 @@ CommandResponse AgentManager::handle_collect_metrics(const Command& cmd) {
 CommandResponse AgentManager::handle_update_config(const Command& cmd) {
     try {
         config_.update_from_json(cmd.data);
-        
+        apply_collector_settings();
+        refresh_config_snapshot();
+        schedule_reset_ = true;
+
         // Используем сохраненный путь к конфигурационному файлу
         if (!config_path_.empty()) {
             config_.save_to_file(config_path_);
@@ -1607,143 +1639,229 @@ void AgentManager::purge_old_jobs() {
     }
 }
 
-nlohmann::json AgentManager::collect_metrics(const std::vector<std::string>& requested_metrics) {
+void AgentManager::collect_metrics(const std::vector<std::string>& families, MetricsBatch& batch,
+                                   bool full_connections) {
     if (!metrics_collector_) {
         throw std::runtime_error("Metrics collector not initialized");
     }
-    
-    auto metrics = metrics_collector_->collect();
-    
-    // Определяем, какие метрики собирать
-    std::vector<std::string> enabled_metrics = requested_metrics.empty() ? 
-        config_.get_enabled_metrics_list() : requested_metrics;
-    
-    // Конвертируем в JSON
-    nlohmann::json j;
-    j["timestamp"] = std::chrono::duration_cast<std::chrono::seconds>(metrics.timestamp.time_since_epoch()).count();
-    j["machine_type"] = metrics.machine_type;
-    j["agent_id"] = config_.agent_id;
-    j["machine_name"] = config_.machine_name;
-    
-    // Добавляем конфигурацию агента
-    j["config"] = config_.to_json();
-    
-    // Добавляем метрики согласно enabled_metrics (убираем проверку config_.is_metric_enabled)
-    for (const auto& metric_type : enabled_metrics) {
-        if (metric_type == "cpu") {
-            j["cpu"]["usage_percent"] = metrics.cpu.usage_percent;
-            j["cpu"]["temperature"] = metrics.cpu.temperature;
-            j["cpu"]["core_temperatures"] = metrics.cpu.core_temperatures;
-            j["cpu"]["core_usage"] = metrics.cpu.core_usage;
-        } else if (metric_type == "memory") {
-            j["memory"]["total_bytes"] = metrics.memory.total_bytes;
-            j["memory"]["used_bytes"] = metrics.memory.used_bytes;
-            j["memory"]["free_bytes"] = metrics.memory.free_bytes;
-            j["memory"]["usage_percent"] = metrics.memory.usage_percent;
-        } else if (metric_type == "disk") {
-            j["disk"]["partitions"] = nlohmann::json::array();
-            for (const auto& part : metrics.disk.partitions) {
-                nlohmann::json jp;
-                jp["mount_point"] = part.mount_point;
-                jp["filesystem"] = part.filesystem;
-                jp["total_bytes"] = static_cast<int64_t>(part.total_bytes);
-                jp["used_bytes"] = static_cast<int64_t>(part.used_bytes);
-                jp["free_bytes"] = static_cast<int64_t>(part.free_bytes);
-                if (part.usage_percent >= 0) {
-                    jp["usage_percent"] = static_cast<double>(part.usage_percent);
-                }
-                j["disk"]["partitions"].push_back(jp);
-            }
-        } else if (metric_type == "network") {
-            j["network"]["interfaces"] = nlohmann::json::array();
-            for (const auto& iface : metrics.network.interfaces) {
-                nlohmann::json ji;
-                ji["name"] = iface.name;
-                ji["bytes_sent"] = static_cast<int64_t>(iface.bytes_sent);
-                ji["bytes_received"] = static_cast<int64_t>(iface.bytes_received);
-                ji["packets_sent"] = static_cast<int64_t>(iface.packets_sent);
-                ji["packets_received"] = static_cast<int64_t>(iface.packets_received);
-                if (iface.bandwidth_sent >= 0) {
-                    ji["bandwidth_sent"] = static_cast<double>(iface.bandwidth_sent);
-                }
-                if (iface.bandwidth_received >= 0) {
-                    ji["bandwidth_received"] = static_cast<double>(iface.bandwidth_received);
-                }
-                j["network"]["interfaces"].push_back(ji);
-            }
-            
-            // Добавляем сериализацию connections
-            j["network"]["connections"] = nlohmann::json::array();
-            for (const auto& conn : metrics.network.connections) {
-                nlohmann::json jc;
-                jc["local_ip"] = conn.local_ip;
-                jc["local_port"] = conn.local_port;
-                jc["remote_ip"] = conn.remote_ip;
-                jc["remote_port"] = conn.remote_port;
-                jc["protocol"] = conn.protocol;
-                j["network"]["connections"].push_back(jc);
-            }
-        } else if (metric_type == "gpu") {
-            j["gpu"]["temperature"] = metrics.gpu.temperature;
-            j["gpu"]["usage_percent"] = metrics.gpu.usage_percent;
-            j["gpu"]["memory_used"] = metrics.gpu.memory_used;
-            j["gpu"]["memory_total"] = metrics.gpu.memory_total;
-        } else if (metric_type == "hdd") {
-            // HDD метрики (если доступны)
-            j["hdd"]["drives"] = nlohmann::json::array();
-            // TODO: Добавить сбор HDD метрик, когда они будут реализованы в MetricsCollector
-        } else if (metric_type == "user") {
-            j["user"]["username"] = metrics.user.username;
-            j["user"]["domain"] = metrics.user.domain;
-            j["user"]["full_name"] = metrics.user.full_name;
-            j["user"]["user_sid"] = metrics.user.user_sid;
-            j["user"]["is_active"] = metrics.user.is_active;
-        } else if (metric_type == "inventory") {
-            j["inventory"]["device_type"] = metrics.inventory.device_type;
-            j["inventory"]["manufacturer"] = metrics.inventory.manufacturer;
-            j["inventory"]["model"] = metrics.inventory.model;
-            j["inventory"]["serial_number"] = metrics.inventory.serial_number;
-            j["inventory"]["uuid"] = metrics.inventory.uuid;
-            j["inventory"]["os_name"] = metrics.inventory.os_name;
-            j["inventory"]["os_version"] = metrics.inventory.os_version;
-            j["inventory"]["cpu_model"] = metrics.inventory.cpu_model;
-            j["inventory"]["cpu_frequency"] = metrics.inventory.cpu_frequency;
-            j["inventory"]["memory_type"] = metrics.inventory.memory_type;
-            j["inventory"]["disk_model"] = metrics.inventory.disk_model;
-            j["inventory"]["disk_type"] = metrics.inventory.disk_type;
-            j["inventory"]["disk_total_bytes"] = metrics.inventory.disk_total_bytes;
-            j["inventory"]["gpu_model"] = metrics.inventory.gpu_model;
-            j["inventory"]["mac_addresses"] = metrics.inventory.mac_addresses;
-            j["inventory"]["ip_addresses"] = metrics.inventory.ip_addresses;
-            j["inventory"]["installed_software"] = metrics.inventory.installed_software;
+
+    monitoring::CollectOptions options;
+    options.families = 0;
+    for (const auto& metric_type : families) {
+        options.families |= monitoring::metric_family_bit(metric_type);
+    }
+    options.full_connections = full_connections || config_.connections_mode == "full";
+    auto metrics = metrics_collector_->collect(options);
+    if (options.families & monitoring::kFamilyInventory) {
+        // Хеш считается по JSON без самого поля и поэтому не зависит от кодировки отправки
+        std::string json;
+        monitoring::JsonWriter writer(json);
+        monitoring::write_metric_family(writer, metrics, "inventory", options.full_connections);
+        metrics.inventory.content_hash = content_hash(json);
+        batch.inventory_hash = metrics.inventory.content_hash;
+    }
+
+    batch.timestamp = std::chrono::duration_cast<std::chrono::seconds>(metrics.timestamp.time_since_epoch()).count();
+    batch.machine_type = metrics.machine_type;
+
+    // Каждое семейство пишется в свою строку; емкость строк сохраняется между сборами
+    for (const auto& metric_type : families) {
+        std::string& fragment = batch.families[metric_type];
+        fragment.clear();
+        bool written;
+        if (batch.encoding == MetricsEncoding::Cbor) {
+            monitoring::CborWriter writer(fragment);
+            written = monitoring::write_metric_family(writer, metrics, metric_type, options.full_connections);
+        } else {
+            monitoring::JsonWriter writer(fragment);
+            written = monitoring::write_metric_family(writer, metrics, metric_type, options.full_connections);
+        }
+        if (!written) {
+            batch.families.erase(metric_type);
         }
     }
-    
-    return j;
 }
 
+void AgentManager::refresh_config_snapshot() {
+    const nlohmann::json config = config_.to_json();
+    std::string json = config.dump();
+    std::string hash = content_hash(json);
+    std::vector<uint8_t> cbor = nlohmann::json::to_cbor(config);
+    std::lock_guard<std::mutex> lock(config_mutex_);
+    config_json_ = std::move(json);
+    config_cbor_.assign(cbor.begin(), cbor.end());
+    config_hash_ = std::move(hash);
+}
+
+void AgentManager::confirm_config_sent(const std::string& sent_hash, bool success, const nlohmann::json& response) {
+    std::lock_guard<std::mutex> lock(config_mutex_);
+    if (success && !sent_hash.empty()) {
+        config_acked_hash_ = sent_hash;
+    }
+    // Сервер не знает присланный хеш (например, после очистки базы) — следующая отправка несет config
+    if (response.is_object() && response.value("config_required", false)) {
+        config_acked_hash_.clear();
+    }
+}
+
+std::string AgentManager::write_metrics_payload(const MetricsBatch& batch, const std::vector<std::string>& families,
+                                                std::string& body) const {
+    body.clear();
+    if (batch.encoding == MetricsEncoding::Cbor) {
+        monitoring::CborWriter writer(body);
+        return write_payload(writer, batch, families);
+    }
+    monitoring::JsonWriter writer(body);
+    return write_payload(writer, batch, families);
+}
+
+template <typename Writer>
+std::string AgentManager::write_payload(Writer& writer, const MetricsBatch& batch,
+                                        const std::vector<std::string>& families) const {
+    writer.begin_object();
+    writer.key("timestamp");
+    writer.value(batch.timestamp);
+    writer.key("machine_type");
+    writer.value(batch.machine_type);
+    writer.key("agent_id");
+    writer.value(server_client_->agent_id());
+    writer.key("machine_name");
+    writer.value(server_client_->machine_name());
+
+    // Конфигурация агента: хеш всегда, полный документ — пока сервер его не подтвердил
+    std::string config_sent;
+    {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        writer.key("config_hash");
+        writer.value(config_hash_);
+        if (config_hash_ != config_acked_hash_) {
+            writer.key("config");
+            writer.raw(batch.encoding == MetricsEncoding::Cbor ? config_cbor_ : config_json_);
+            config_sent = config_hash_;
+        }
+    }
+
+    // В batch только известные семейства, поэтому имена не экранируются
+    for (const auto& metric_type : families) {
+        auto it = batch.families.find(metric_type);
+        if (it != batch.families.end()) {
+            writer.key(metric_type);
+            writer.raw(it->second);
+        }
+    }
+    writer.end_object();
+    return config_sent;
+}
+/**
+ * Цикл сбора метрик. Каждое семейство из enabled_metrics собирается со своим
+ * интервалом (metric_intervals, по умолчанию update_frequency). В отправку
+ * попадают только семейства, чей срок наступил: сервер сохраняет каждое
+ * присланное семейство под временем отправки, и повтор прошлых значений
+ * дал бы ему записи-дубликаты.
+ */
 void AgentManager::metrics_loop() {
     while (running_) {
-        try {
-            auto metrics = collect_metrics();
-            server_client_->send_metrics(metrics);
-            // periodic purge of old jobs
-            purge_old_jobs();
-        } catch (const std::exception& e) {
-            
+        if (schedule_reset_.exchange(false)) {
+            metric_next_due_.clear();
+        }
+        
+        const MetricsEncoding encoding = select_metrics_encoding();
+        if (encoding != metric_cache_.encoding) {
+            // Кэш закодирован по-старому: все семейства собираются заново в новой кодировке
+            metric_cache_.encoding = encoding;
+            metric_cache_.families.clear();
+            metric_next_due_.clear();
+        }
+        
+        const auto now = std::chrono::steady_clock::now();
+        const auto enabled = config_.get_enabled_metrics_list();
+        auto next_wakeup = now + std::chrono::seconds(config_.update_frequency > 0 ? config_.update_frequency : 1);
+        std::vector<std::string> due;
+        for (const auto& metric_type : enabled) {
+            auto& next_due = metric_next_due_[metric_type]; // новое семейство собирается сразу
+            if (next_due <= now) {
+                due.push_back(metric_type);
+                next_due = now + config_.get_metric_interval(metric_type);
+            }
+            next_wakeup = std::min(next_wakeup, next_due);
+        }
+        
+        if (!due.empty()) {
+            try {
+                collect_metrics(due, metric_cache_);
+                // Инвентаризация отправляется, пока сервер не примет ее текущее содержимое
+                auto inventory = metric_cache_.families.find("inventory");
+                if (inventory != metric_cache_.families.end()) {
+                    if (metric_cache_.inventory_hash == last_inventory_hash_ ||
+                        std::find(enabled.begin(), enabled.end(), "inventory") == enabled.end()) {
+                        metric_cache_.families.erase(inventory);
+                    } else if (std::find(due.begin(), due.end(), "inventory") == due.end()) {
+                        due.push_back("inventory");
+                    }
+                }
+                const std::string config_sent = write_metrics_payload(metric_cache_, due, payload_);
+                nlohmann::json response;
+                long status = 0;
+                const bool sent = server_client_->send_metrics(payload_, metric_cache_.encoding, response, status);
+                confirm_config_sent(config_sent, sent, response);
+                // Неотправленная инвентаризация остается в кэше и уйдет со следующим сбором
+                if (sent && metric_cache_.families.erase("inventory")) {
+                    last_inventory_hash_ = metric_cache_.inventory_hash;
+                }
+                if (response.is_object() && response.contains("encodings") && response["encodings"].is_array()) {
+                    const auto& encodings = response["encodings"];
+                    server_accepts_cbor_ = std::find(encodings.begin(), encodings.end(), "cbor") != encodings.end();
+                }
+                // Сервер перестал принимать CBOR (415) или разобрал его как JSON (422) — возвращаемся к JSON
+                if (metric_cache_.encoding == MetricsEncoding::Cbor && (status == 415 || status == 422)) {
+                    server_accepts_cbor_ = false;
+                }
+                // periodic purge of old jobs
+                purge_old_jobs();
+            } catch (const std::exception& e) {
+                
+            }
         }
         
-        // Используем update_frequency как интервал сбора метрик
-        std::this_thread::sleep_for(std::chrono::seconds(config_.update_frequency));
+        // Спим до ближайшего срока, просыпаясь раз в секунду, чтобы stop() не ждал
+        while (running_ && !schedule_reset_ && std::chrono::steady_clock::now() < next_wakeup) {
+            auto remaining = next_wakeup - std::chrono::steady_clock::now();
+            std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(remaining, std::chrono::seconds(1)));
+        }
     }
 }
 
+MetricsEncoding AgentManager::select_metrics_encoding() const {
+    if (config_.metrics_encoding == "cbor") return MetricsEncoding::Cbor;
+    if (config_.metrics_encoding == "json") return MetricsEncoding::Json;
+    return server_accepts_cbor_ ? MetricsEncoding::Cbor : MetricsEncoding::Json;
+}
+
 void AgentManager::initialize_metrics_collector() {
 #ifdef _WIN32
     metrics_collector_ = std::make_unique<monitoring::WindowsMetricsCollector>();
 #else
     metrics_collector_ = monitoring::create_metrics_collector();
 #endif
+    apply_collector_settings();
+}
+
+void AgentManager::apply_collector_settings() {
+    if (!metrics_collector_) return;
+    metrics_collector_->set_cpu_sample_window(std::chrono::milliseconds(config_.cpu_sample_window_ms));
+    metrics_collector_->set_connection_state_filter(config_.connection_states);
+    metrics_collector_->set_connection_top_peers(static_cast<size_t>(std::max(0, config_.connection_top_peers)));
+    metrics_collector_->set_process_top_n(static_cast<size_t>(std::max(0, config_.process_top_n)));
+    for (const auto& [metric_type, timeout_ms] : config_.metric_timeouts_ms) {
+        uint32_t bit = monitoring::metric_family_bit(metric_type);
+        if (bit && timeout_ms > 0) metrics_collector_->set_family_timeout(bit, std::chrono::milliseconds(timeout_ms));
+    }
+    
+    // Кэш инвентаризации хранится рядом с конфигурацией
+    const std::string cache_file = "inventory_cache.json";
+    metrics_collector_->set_inventory_cache_path(config_path_.empty()
+        ? AgentConfig::get_config_path(cache_file)
+        : (std::filesystem::path(config_path_).parent_path() / cache_file).string());
 }
 
 } // namespace agent } // namespace agent 
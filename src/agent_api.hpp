@@ -85,26 +85,48 @@ private:
     std::string generate_response(int status_code, const std::string& content_type, const std::string& body);
 };
 
+// Кодировка документа отправки метрик
+enum class MetricsEncoding {
+    Json,
+    Cbor   ///< application/cbor, см. metrics_cbor.hpp
+};
+
 // Класс для взаимодействия с сервером мониторинга
 class MonitoringServerClient {
 public:
     MonitoringServerClient(const AgentConfig& config);
     
-    // Отправка метрик
-    bool send_metrics(const nlohmann::json& metrics);
-    
+    // Отправка метрик: body — готовый документ (AgentManager::write_metrics_payload) в кодировке encoding.
+    // status — HTTP-код ответа, 0 — сервер не ответил
+    bool send_metrics(const std::string& body);
+    bool send_metrics(const std::string& body, MetricsEncoding encoding, nlohmann::json& response, long& status);
+
     // Регистрация агента
     bool register_agent();
     
     // Получение конфигурации с сервера
     bool update_config_from_server();
     
+    const std::string& agent_id() const { return agent_id_; }
+    const std::string& machine_name() const { return machine_name_; }
+    
 private:
     AgentConfig config_;
     std::string agent_id_;
     std::string machine_name_;
     
     bool make_request(const std::string& endpoint, const nlohmann::json& data, nlohmann::json& response);
+    bool make_request(const std::string& endpoint, const std::string& body, const char* content_type,
+                      nlohmann::json& response, long* status = nullptr);
+};
+
+// Семейства метрик одного или нескольких сборов, уже сериализованные
+struct MetricsBatch {
+    int64_t timestamp = 0;
+    std::string machine_type;
+    MetricsEncoding encoding = MetricsEncoding::Json;
+    std::map<std::string, std::string> families;  ///< Семейство -> объект в кодировке encoding
+    std::string inventory_hash;                   ///< content_hash инвентаризации из families
 };
 
 // Класс для управления агентом
@@ -131,8 +153,14 @@ public:
     CommandResponse handle_list_scripts(const Command& cmd);
     CommandResponse handle_delete_script(const Command& cmd);
     
-    // Сбор метрик
-    nlohmann::json collect_metrics(const std::vector<std::string>& requested_metrics = {});
+    // Сбор метрик: семейства сериализуются сразу в batch.families (в batch.encoding), остальные записи batch не меняются
+    void collect_metrics(const std::vector<std::string>& families, MetricsBatch& batch,
+                         bool full_connections = false);
+    // Документ для отправки в batch.encoding: данные агента, config_hash и перечисленные семейства из batch.
+    // Полный config пишется, только если сервер еще не подтвердил текущий хеш;
+    // тогда возвращается этот хеш, иначе пустая строка
+    std::string write_metrics_payload(const MetricsBatch& batch, const std::vector<std::string>& families,
+                                      std::string& body) const;
     
     // Управление задачами
     std::string generate_job_id();
@@ -154,8 +182,31 @@ private:
     std::unordered_map<std::string, std::shared_ptr<BackgroundJobInfo>> jobs_;
     mutable std::mutex jobs_mutex_;
     
+    // Планировщик сбора: у каждого семейства метрик свой интервал
+    std::map<std::string, std::chrono::steady_clock::time_point> metric_next_due_;
+    MetricsBatch metric_cache_;                ///< Семейства текущего сбора и неподтвержденная инвентаризация
+    std::string payload_;                      ///< Буфер документа отправки, переиспользуется между циклами
+    std::atomic<bool> schedule_reset_{false};  ///< Конфигурация изменилась — пересчитать расписание
+    std::string last_inventory_hash_;          ///< Хеш инвентаризации, которую сервер принял
+    
+    // Конфигурация уходит на сервер только при изменении, в остальных отправках — ее хеш
+    mutable std::mutex config_mutex_;
+    std::string config_json_;        ///< Сериализованный config_, пересчитывается при изменении
+    std::string config_cbor_;        ///< Тот же config_ в CBOR
+    std::string config_hash_;        ///< Хеш config_json_
+    std::string config_acked_hash_;  ///< Хеш конфигурации, которую сервер уже получил
+    
+    // Согласование кодировки: сервер перечисляет поддерживаемые в ответе на отправку метрик
+    bool server_accepts_cbor_ = false;  ///< Только из metrics_loop
+    
     void metrics_loop();
+    MetricsEncoding select_metrics_encoding() const;
+    template <typename Writer>
+    std::string write_payload(Writer& writer, const MetricsBatch& batch, const std::vector<std::string>& families) const;
+    void refresh_config_snapshot();
+    void confirm_config_sent(const std::string& sent_hash, bool success, const nlohmann::json& response);
     void initialize_metrics_collector();
+    void apply_collector_settings();
 };
 
 // Структура для результатов выполнения процессов
@@ -17,12 +17,43 @@
 #include <unistd.h>
 #include <sys/utsname.h>
 #include <linux/limits.h>
-#include <ifaddrs.h>
-#include <arpa/inet.h>
+#include <net/if.h>
+#include "../include/interface_addresses.hpp"
 #endif
 
 namespace agent {
 
+namespace {
+
+// Значения по семействам: {"cpu": 5, "network": 10, ...}
+void read_metric_intervals(const nlohmann::json& obj, std::map<std::string, int>& intervals) {
+    if (!obj.is_object()) return;
+    for (auto it = obj.begin(); it != obj.end(); ++it) {
+        if (it.value().is_number_integer()) intervals[it.key()] = it.value().get<int>();
+    }
+}
+
+// enabled_metrics: значение — флаг или объект {"enabled": true, "interval": 5}
+void read_enabled_metrics(const nlohmann::json& obj, std::map<std::string, bool>& enabled,
+                          std::map<std::string, int>& intervals) {
+    if (!obj.is_object()) return;
+    for (auto it = obj.begin(); it != obj.end(); ++it) {
+        const auto& value = it.value();
+        if (value.is_boolean()) {
+            enabled[it.key()] = value.get<bool>();
+        } else if (value.is_object()) {
+            if (value.contains("enabled") && value["enabled"].is_boolean()) {
+                enabled[it.key()] = value["enabled"].get<bool>();
+            }
+            if (value.contains("interval") && value["interval"].is_number_integer()) {
+                intervals[it.key()] = value["interval"].get<int>();
+            }
+        }
+    }
+}
+
+} // namespace
+
 nlohmann::json AgentConfig::to_json() const {
     nlohmann::json j;
     j["agent_id"] = agent_id;
@@ -33,9 +64,15 @@ nlohmann::json AgentConfig::to_json() const {
     j["command_server_host"] = command_server_host;
     j["send_timeout_ms"] = send_timeout_ms;
     j["max_buffer_size"] = max_buffer_size;
+    j["metrics_encoding"] = metrics_encoding;
     j["auto_detect_id"] = auto_detect_id;
     j["auto_detect_name"] = auto_detect_name;
     j["update_frequency"] = update_frequency;
+    j["cpu_sample_window_ms"] = cpu_sample_window_ms;
+    j["connection_states"] = connection_states;
+    j["connections_mode"] = connections_mode;
+    j["connection_top_peers"] = connection_top_peers;
+    j["process_top_n"] = process_top_n;
     j["scripts_dir"] = scripts_dir;
     j["allowed_interpreters"] = allowed_interpreters;
     j["max_script_timeout_sec"] = max_script_timeout_sec;
@@ -53,6 +90,8 @@ nlohmann::json AgentConfig::to_json() const {
         metrics_obj[metric] = enabled;
     }
     j["enabled_metrics"] = metrics_obj;
+    j["metric_intervals"] = metric_intervals;
+    j["metric_timeouts_ms"] = metric_timeouts_ms;
     
     // user_parameters as object
     nlohmann::json up;
@@ -74,9 +113,15 @@ AgentConfig AgentConfig::from_json(const nlohmann::json& j) {
     if (j.contains("command_server_host")) config.command_server_host = j["command_server_host"];
     if (j.contains("send_timeout_ms")) config.send_timeout_ms = j["send_timeout_ms"];
     if (j.contains("max_buffer_size")) config.max_buffer_size = j["max_buffer_size"];
+    if (j.contains("metrics_encoding")) config.metrics_encoding = j["metrics_encoding"];
     if (j.contains("auto_detect_id")) config.auto_detect_id = j["auto_detect_id"];
     if (j.contains("auto_detect_name")) config.auto_detect_name = j["auto_detect_name"];
     if (j.contains("update_frequency")) config.update_frequency = j["update_frequency"];
+    if (j.contains("cpu_sample_window_ms")) config.cpu_sample_window_ms = j["cpu_sample_window_ms"];
+    if (j.contains("connection_states")) config.connection_states = j["connection_states"].get<std::vector<std::string>>();
+    if (j.contains("connections_mode")) config.connections_mode = j["connections_mode"];
+    if (j.contains("connection_top_peers")) config.connection_top_peers = j["connection_top_peers"];
+    if (j.contains("process_top_n")) config.process_top_n = j["process_top_n"];
     if (j.contains("scripts_dir")) config.scripts_dir = j["scripts_dir"];
     if (j.contains("allowed_interpreters")) config.allowed_interpreters = j["allowed_interpreters"].get<std::vector<std::string>>();
     if (j.contains("max_script_timeout_sec")) config.max_script_timeout_sec = j["max_script_timeout_sec"];
@@ -90,12 +135,13 @@ AgentConfig AgentConfig::from_json(const nlohmann::json& j) {
     
     // Загружаем метрики из объекта с флагами
     if (j.contains("enabled_metrics")) {
-        const auto& metrics_obj = j["enabled_metrics"];
-        if (metrics_obj.is_object()) {
-            for (auto it = metrics_obj.begin(); it != metrics_obj.end(); ++it) {
-                config.enabled_metrics[it.key()] = it.value().get<bool>();
-            }
-        }
+        read_enabled_metrics(j["enabled_metrics"], config.enabled_metrics, config.metric_intervals);
+    }
+    if (j.contains("metric_intervals")) {
+        read_metric_intervals(j["metric_intervals"], config.metric_intervals);
+    }
+    if (j.contains("metric_timeouts_ms")) {
+        read_metric_intervals(j["metric_timeouts_ms"], config.metric_timeouts_ms);
     }
     // user_parameters
     if (j.contains("user_parameters") && j["user_parameters"].is_object()) {
@@ -193,17 +239,26 @@ void AgentConfig::update_from_json(const nlohmann::json& j) {
         update_frequency = j["update_frequency"];
     }
     if (j.contains("enabled_metrics")) {
-        const auto& metrics_obj = j["enabled_metrics"];
-        if (metrics_obj.is_object()) {
-            for (auto it = metrics_obj.begin(); it != metrics_obj.end(); ++it) {
-                enabled_metrics[it.key()] = it.value().get<bool>();
-            }
-        }
+        read_enabled_metrics(j["enabled_metrics"], enabled_metrics, metric_intervals);
+    }
+    if (j.contains("metric_intervals")) {
+        read_metric_intervals(j["metric_intervals"], metric_intervals);
+    }
+    if (j.contains("metric_timeouts_ms")) {
+        read_metric_intervals(j["metric_timeouts_ms"], metric_timeouts_ms);
     }
     if (j.contains("server_url")) server_url = j["server_url"];
     if (j.contains("agent_id")) agent_id = j["agent_id"];
     if (j.contains("machine_name")) machine_name = j["machine_name"];
     if (j.contains("update_frequency")) update_frequency = j["update_frequency"];
+    if (j.contains("cpu_sample_window_ms")) cpu_sample_window_ms = j["cpu_sample_window_ms"];
+    if (j.contains("connection_states")) {
+        try { connection_states = j["connection_states"].get<std::vector<std::string>>(); } catch (...) {}
+    }
+    if (j.contains("connections_mode")) connections_mode = j["connections_mode"];
+    if (j.contains("connection_top_peers")) connection_top_peers = j["connection_top_peers"];
+    if (j.contains("process_top_n")) process_top_n = j["process_top_n"];
+    if (j.contains("metrics_encoding")) metrics_encoding = j["metrics_encoding"];
 
     // New script execution related fields
     if (j.contains("scripts_dir")) scripts_dir = j["scripts_dir"];
@@ -288,30 +343,16 @@ std::string AgentConfig::get_local_ip() {
     WSACleanup();
     return "127.0.0.1";
 #else
-    // Linux: получаем IP адрес через getifaddrs
-    struct ifaddrs *ifaddr, *ifa;
-    if (getifaddrs(&ifaddr) == -1) {
-        return "127.0.0.1";
-    }
-    
-    for (ifa = ifaddr; ifa != NULL; ifa = ifa->ifa_next) {
-        if (ifa->ifa_addr == NULL) continue;
-        
-        if (ifa->ifa_addr->sa_family == AF_INET) {
-            struct sockaddr_in* sa_in = (struct sockaddr_in*)ifa->ifa_addr;
-            char ip_str[INET_ADDRSTRLEN];
-            inet_ntop(AF_INET, &(sa_in->sin_addr), ip_str, INET_ADDRSTRLEN);
-            
-            // Пропускаем локальные адреса и loopback
-            if (strncmp(ip_str, "127.", 4) != 0 && 
-                strncmp(ip_str, "169.254.", 8) != 0 &&
-                strcmp(ifa->ifa_name, "lo") != 0) {
-                freeifaddrs(ifaddr);
-                return std::string(ip_str);
+    // Linux: адреса интерфейсов из общего кэша getifaddrs
+    for (const auto& iface : monitoring::interface_addresses()) {
+        if (iface.flags & IFF_LOOPBACK) continue;
+        for (const auto& ip : iface.ipv4) {
+            // Пропускаем локальные адреса
+            if (ip.compare(0, 4, "127.") != 0 && ip.compare(0, 8, "169.254.") != 0) {
+                return ip;
             }
         }
     }
-    freeifaddrs(ifaddr);
 #endif
     return "127.0.0.1"; // Fallback
 }
@@ -352,4 +393,11 @@ std::vector<std::string> AgentConfig::get_enabled_metrics_list() const {
     return result;
 }
 
+std::chrono::seconds AgentConfig::get_metric_interval(const std::string& metric_name) const {
+    auto it = metric_intervals.find(metric_name);
+    int seconds = (it != metric_intervals.end() && it->second > 0) ? it->second : update_frequency;
+    if (seconds < 1) seconds = 1;
+    return std::chrono::seconds(seconds);
+}
+
 } // namespace agent 
\ No newline at end of file
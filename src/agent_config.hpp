@@ -24,8 +24,16 @@ struct AgentConfig {
         {"gpu", false},
         {"hdd", false},
         {"inventory", true},
-        {"user", true}
+        {"user", true},
+        {"cgroup", false}
     };
+    // Интервалы сбора по семействам (секунды); семейства без записи собираются раз в update_frequency
+    std::map<std::string, int> metric_intervals = {
+        {"hdd", 3600},
+        {"inventory", 86400}
+    };
+    // Срок сбора семейства (мс); не успевшее семейство передается с прошлым значением и "stale": true
+    std::map<std::string, int> metric_timeouts_ms;
     
     // Настройки HTTP сервера агента
     int command_server_port = 8081;
@@ -34,7 +42,13 @@ struct AgentConfig {
     // Настройки отправки
     int send_timeout_ms = 2000;
     int max_buffer_size = 10;
+    std::string metrics_encoding = "json"; // "json", "cbor" или "auto" — CBOR, если сервер его принимает
     int update_frequency = 60; // Metrics collection interval in seconds
+    int cpu_sample_window_ms = 0; // 0 — загрузка CPU по дельте между сборами, >0 — отдельный замер (мс)
+    std::vector<std::string> connection_states; // Фильтр состояний TCP-соединений (пусто — все)
+    std::string connections_mode = "summary"; // "summary" — только сводка, "full" — еще и полный список сокетов
+    int connection_top_peers = 10; // Сколько удаленных адресов включать в сводку
+    int process_top_n = 10; // Сколько процессов включать в top-N по CPU, памяти и вводу-выводу (0 — не собирать)
     
     // Настройки автоматического определения
     bool auto_detect_id = true;
@@ -84,6 +98,7 @@ struct AgentConfig {
     bool is_metric_enabled(const std::string& metric_name) const;
     void set_metric_enabled(const std::string& metric_name, bool enabled);
     std::vector<std::string> get_enabled_metrics_list() const;
+    std::chrono::seconds get_metric_interval(const std::string& metric_name) const;
 };
 
 } // namespace agent 
\ No newline at end of file
@@ -0,0 +1,264 @@
+/**
+ * @file cgroup_stats.cpp
+ * @brief Реализация обхода cgroup v2
+ */
+
+#include "../include/cgroup_stats.hpp"
+#include "../include/pressure_stats.hpp"
+#include "../include/procfs_reader.hpp"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace monitoring {
+
+namespace {
+
+// Полный обход на случай изменений без событий inotify (включение контроллеров)
+constexpr auto kRescanInterval = std::chrono::minutes(5);
+
+constexpr uint32_t kWatchMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+const char* const kFileNames[] = {"cpu.stat", "memory.current", "memory.max", "memory.stat", "io.stat", "cpu.pressure"};
+
+std::string detect_root() {
+    if (::access("/sys/fs/cgroup/cgroup.controllers", R_OK) == 0) return "/sys/fs/cgroup";
+    if (::access("/sys/fs/cgroup/unified/cgroup.controllers", R_OK) == 0) return "/sys/fs/cgroup/unified";
+    return "";
+}
+
+double per_second(uint64_t current, uint64_t previous, double seconds) {
+    if (current < previous || seconds <= 0) return 0;
+    return static_cast<double>(current - previous) / seconds;
+}
+
+// Доля интервала в процентах по приросту микросекунд
+double usec_percent(uint64_t current, uint64_t previous, double seconds) {
+    return per_second(current, previous, seconds) / 1e4;
+}
+
+} // namespace
+
+CgroupTracker::CgroupTracker(std::string root, size_t max_depth)
+    : root_(root.empty() ? detect_root() : std::move(root)), max_depth_(max_depth), buffer_(4096) {
+    if (!root_.empty() && ::access(root_.c_str(), R_OK | X_OK) != 0) root_.clear();
+    if (root_.empty()) return;
+    inotify_fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+}
+
+CgroupTracker::~CgroupTracker() {
+    for (auto& group : groups_) close_group(group);
+    if (inotify_fd_ >= 0) ::close(inotify_fd_);
+}
+
+void CgroupTracker::close_group(Group& group) {
+    for (int& fd : group.fds) {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+}
+
+bool CgroupTracker::drain_events() {
+    if (inotify_fd_ < 0) return true;  // без inotify дерево перечитывается каждый раз
+    alignas(struct inotify_event) char events[4096];
+    bool changed = false;
+    for (;;) {
+        ssize_t n = ::read(inotify_fd_, events, sizeof(events));
+        if (n <= 0) break;
+        for (ssize_t offset = 0; offset < n;) {
+            const auto* event = reinterpret_cast<const struct inotify_event*>(events + offset);
+            offset += static_cast<ssize_t>(sizeof(struct inotify_event) + event->len);
+            if ((event->mask & (IN_ISDIR | IN_Q_OVERFLOW)) != 0) changed = true;
+        }
+    }
+    return changed;
+}
+
+void CgroupTracker::rescan() {
+    // Группы, оставшиеся в дереве, сохраняют дескрипторы и прошлые счетчики
+    std::unordered_map<std::string, Group> old;
+    old.reserve(groups_.size());
+    for (auto& group : groups_) {
+        std::string key = group.path;
+        old.emplace(std::move(key), std::move(group));
+    }
+    groups_.clear();
+
+    int root_fd = ::open(root_.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (root_fd >= 0) {
+        if (inotify_fd_ >= 0) ::inotify_add_watch(inotify_fd_, root_.c_str(), kWatchMask);
+        std::string path;
+        scan_dir(root_fd, path, 1, old);
+        ::close(root_fd);
+    }
+    for (auto& [path, group] : old) close_group(group);
+    scanned_ = true;
+    last_scan_ = std::chrono::steady_clock::now();
+}
+
+// path — путь каталога dir_fd от корня ("" для корня)
+void CgroupTracker::scan_dir(int dir_fd, std::string& path, size_t depth,
+                             std::unordered_map<std::string, Group>& old) {
+    int list_fd = ::dup(dir_fd);
+    if (list_fd < 0) return;
+    DIR* dir = ::fdopendir(list_fd);
+    if (!dir) {
+        ::close(list_fd);
+        return;
+    }
+    while (struct dirent* entry = ::readdir(dir)) {
+        if (entry->d_type != DT_DIR || entry->d_name[0] == '.') continue;
+        int child_fd = ::openat(dir_fd, entry->d_name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (child_fd < 0) continue;
+
+        const size_t parent_length = path.size();
+        path += '/';
+        path += entry->d_name;
+
+        // Группа, пересозданная под тем же именем, — другой каталог: старые
+        // дескрипторы указывают на удаленные файлы и отвечают ENODEV
+        struct stat st;
+        const ino_t ino = ::fstat(child_fd, &st) == 0 ? st.st_ino : 0;
+        auto it = old.find(path);
+        if (it != old.end() && it->second.ino == ino) {
+            groups_.push_back(std::move(it->second));
+            old.erase(it);
+        } else {
+            groups_.emplace_back();
+            groups_.back().path = path;
+            groups_.back().ino = ino;
+        }
+        // Файлы контроллеров, включенных после обнаружения группы
+        for (int i = 0; i < kFileCount; ++i) {
+            int& fd = groups_.back().fds[i];
+            if (fd < 0) fd = ::openat(child_fd, kFileNames[i], O_RDONLY | O_CLOEXEC);
+        }
+
+        if (depth < max_depth_) {
+            if (inotify_fd_ >= 0) ::inotify_add_watch(inotify_fd_, (root_ + path).c_str(), kWatchMask);
+            scan_dir(child_fd, path, depth + 1, old);
+        }
+        ::close(child_fd);
+        path.resize(parent_length);
+    }
+    ::closedir(dir);
+}
+
+bool CgroupTracker::read(int fd, std::string_view& out) {
+    if (fd < 0) return false;
+    for (;;) {
+        ssize_t n = ::pread(fd, buffer_.data(), buffer_.size(), 0);
+        if (n < 0) return false;
+        if (static_cast<size_t>(n) < buffer_.size()) {
+            out = std::string_view(buffer_.data(), static_cast<size_t>(n));
+            return true;
+        }
+        buffer_.resize(buffer_.size() * 2);  // memory.stat на больших машинах длиннее 4 КБ
+    }
+}
+
+void CgroupTracker::read_group(Group& group, CgroupInfo& info, double seconds) {
+    Counters cur = group.counters;
+    std::string_view text;
+
+    if (read(group.fds[kCpuStat], text)) {
+        procfs::Scanner sc(text);
+        do {
+            std::string_view key = sc.token();
+            uint64_t* target = nullptr;
+            if (key == "usage_usec") target = &cur.usage_usec;
+            else if (key == "user_usec") target = &cur.user_usec;
+            else if (key == "system_usec") target = &cur.system_usec;
+            else if (key == "throttled_usec") target = &cur.throttled_usec;
+            if (!target) continue;
+            sc.skip_spaces();
+            sc.parse_u64(*target);
+        } while (sc.next_line());
+    }
+
+    // "8:0 rbytes=1 wbytes=2 rios=3 wios=4 dbytes=0 dios=0", по строке на устройство
+    if (read(group.fds[kIoStat], text)) {
+        cur.rbytes = cur.wbytes = cur.rios = cur.wios = 0;
+        procfs::Scanner sc(text);
+        do {
+            sc.token();
+            while (!sc.eol()) {
+                std::string_view key = sc.token_until('=');
+                uint64_t value = 0;
+                if (!procfs::parse_u64(sc.token(), value)) continue;
+                if (key == "rbytes") cur.rbytes += value;
+                else if (key == "wbytes") cur.wbytes += value;
+                else if (key == "rios") cur.rios += value;
+                else if (key == "wios") cur.wios += value;
+            }
+        } while (sc.next_line());
+    }
+
+    info.memory_current = 0;
+    if (read(group.fds[kMemoryCurrent], text)) {
+        procfs::Scanner sc(text);
+        sc.parse_u64(info.memory_current);
+    }
+    info.memory_max = 0;
+    if (read(group.fds[kMemoryMax], text)) {
+        procfs::Scanner sc(text);
+        sc.parse_u64(info.memory_max);  // "max" не разбирается — ограничения нет
+    }
+    info.memory_anon = 0;
+    info.memory_file = 0;
+    if (read(group.fds[kMemoryStat], text)) {
+        procfs::Scanner sc(text);
+        int found = 0;
+        do {
+            std::string_view key = sc.token();
+            uint64_t* target = key == "anon" ? &info.memory_anon : key == "file" ? &info.memory_file : nullptr;
+            if (!target) continue;
+            sc.skip_spaces();
+            if (sc.parse_u64(*target)) ++found;
+        } while (found < 2 && sc.next_line());
+    }
+
+    info.cpu_pressure = PressureInfo{};
+    if (read(group.fds[kCpuPressure], text)) parse_pressure(text, info.cpu_pressure);
+
+    const Counters& prev = group.counters;
+    if (group.has_counters) {
+        info.cpu_percent = usec_percent(cur.usage_usec, prev.usage_usec, seconds);
+        info.cpu_user_percent = usec_percent(cur.user_usec, prev.user_usec, seconds);
+        info.cpu_system_percent = usec_percent(cur.system_usec, prev.system_usec, seconds);
+        info.throttled_percent = usec_percent(cur.throttled_usec, prev.throttled_usec, seconds);
+        info.read_bytes_per_sec = per_second(cur.rbytes, prev.rbytes, seconds);
+        info.write_bytes_per_sec = per_second(cur.wbytes, prev.wbytes, seconds);
+        info.reads_per_sec = per_second(cur.rios, prev.rios, seconds);
+        info.writes_per_sec = per_second(cur.wios, prev.wios, seconds);
+    } else {
+        info.cpu_percent = info.cpu_user_percent = info.cpu_system_percent = info.throttled_percent = 0;
+        info.read_bytes_per_sec = info.write_bytes_per_sec = info.reads_per_sec = info.writes_per_sec = 0;
+    }
+    group.counters = cur;
+    group.has_counters = true;
+}
+
+void CgroupTracker::update(CgroupMetrics& out) {
+    out.available = available();
+    if (!available()) {
+        out.groups.clear();
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (drain_events() || !scanned_ || now - last_scan_ >= kRescanInterval) rescan();
+    const double seconds = std::chrono::duration<double>(now - last_update_).count();
+    last_update_ = now;
+
+    out.groups.resize(groups_.size());
+    for (size_t i = 0; i < groups_.size(); ++i) {
+        out.groups[i].path = groups_[i].path;
+        read_group(groups_[i], out.groups[i], seconds);
+    }
+}
+
+} // namespace monitoring
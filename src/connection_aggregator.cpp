@@ -0,0 +1,200 @@
+/**
+ * @file connection_aggregator.cpp
+ * @brief Реализация агрегации сетевых соединений
+ */
+
+#include "../include/connection_aggregator.hpp"
+
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <algorithm>
+#include <cstring>
+
+namespace monitoring {
+
+namespace {
+
+// Ключ группы: 1 (признак занятости) | протокол | состояние | порт
+uint32_t make_group_key(uint8_t protocol, uint8_t state, uint16_t port) {
+    uint32_t proto_bit = protocol == IPPROTO_UDP ? 1u : 0u;
+    return 0x80000000u | (proto_bit << 24) | (static_cast<uint32_t>(state) << 16) | port;
+}
+
+uint32_t hash_u32(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+// FNV-1a по байтам адреса
+uint32_t hash_addr(const uint8_t* addr, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= addr[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+size_t addr_len(uint8_t family) {
+    return family == AF_INET6 ? 16 : 4;
+}
+
+bool is_unspecified(const uint8_t* addr, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        if (addr[i] != 0) return false;
+    }
+    return true;
+}
+
+constexpr size_t kInitialCapacity = 64;
+
+} // namespace
+
+ConnectionAggregator::ConnectionAggregator(size_t top_peers, uint16_t ephemeral_min, uint16_t ephemeral_max)
+    : top_peers_(top_peers), ephemeral_min_(ephemeral_min), ephemeral_max_(ephemeral_max),
+      groups_(kInitialCapacity, GroupSlot{0, 0}), peers_(kInitialCapacity, PeerSlot{}),
+      listen_ports_(65536 / 64, 0) {}
+
+void ConnectionAggregator::set_ephemeral_range(uint16_t min_port, uint16_t max_port) {
+    ephemeral_min_ = min_port;
+    ephemeral_max_ = max_port;
+}
+
+void ConnectionAggregator::reset() {
+    if (group_count_) std::fill(groups_.begin(), groups_.end(), GroupSlot{0, 0});
+    if (peer_count_) std::fill(peers_.begin(), peers_.end(), PeerSlot{});
+    std::fill(listen_ports_.begin(), listen_ports_.end(), 0);
+    group_count_ = 0;
+    peer_count_ = 0;
+    total_ = 0;
+}
+
+void ConnectionAggregator::on_socket(const SocketRecord& record) {
+    ++total_;
+    const bool listening = record.protocol == IPPROTO_TCP ? record.state == 10 /* TCP_LISTEN */
+                                                          : record.remote_port == 0;
+    uint16_t port = record.local_port;
+    if (listening && record.protocol == IPPROTO_TCP) {
+        listen_ports_[port >> 6] |= uint64_t{1} << (port & 63);
+    } else if (!listening && port >= ephemeral_min_ && port <= ephemeral_max_ &&
+               !(listen_ports_[port >> 6] & (uint64_t{1} << (port & 63)))) {
+        port = 0;
+    }
+    add_group(make_group_key(record.protocol, record.state, port));
+
+    if (!is_unspecified(record.remote_addr, addr_len(record.family))) {
+        add_peer(record);
+    }
+}
+
+void ConnectionAggregator::add_group(uint32_t key) {
+    if ((group_count_ + 1) * 10 > groups_.size() * 7) grow_groups();
+    const size_t mask = groups_.size() - 1;
+    for (size_t i = hash_u32(key) & mask;; i = (i + 1) & mask) {
+        GroupSlot& slot = groups_[i];
+        if (slot.key == key) {
+            ++slot.count;
+            return;
+        }
+        if (slot.key == 0) {
+            slot.key = key;
+            slot.count = 1;
+            ++group_count_;
+            return;
+        }
+    }
+}
+
+void ConnectionAggregator::add_peer(const SocketRecord& record) {
+    if ((peer_count_ + 1) * 10 > peers_.size() * 7) grow_peers();
+    const size_t len = addr_len(record.family);
+    const size_t mask = peers_.size() - 1;
+    for (size_t i = (hash_addr(record.remote_addr, len) ^ record.family) & mask;; i = (i + 1) & mask) {
+        PeerSlot& slot = peers_[i];
+        if (slot.family == record.family && std::memcmp(slot.addr, record.remote_addr, len) == 0) {
+            ++slot.count;
+            return;
+        }
+        if (slot.family == 0) {
+            std::memcpy(slot.addr, record.remote_addr, len);
+            slot.family = record.family;
+            slot.count = 1;
+            ++peer_count_;
+            return;
+        }
+    }
+}
+
+void ConnectionAggregator::grow_groups() {
+    std::vector<GroupSlot> old(groups_.size() * 2, GroupSlot{0, 0});
+    old.swap(groups_);
+    const size_t mask = groups_.size() - 1;
+    for (const auto& slot : old) {
+        if (slot.key == 0) continue;
+        size_t i = hash_u32(slot.key) & mask;
+        while (groups_[i].key != 0) i = (i + 1) & mask;
+        groups_[i] = slot;
+    }
+}
+
+void ConnectionAggregator::grow_peers() {
+    std::vector<PeerSlot> old(peers_.size() * 2, PeerSlot{});
+    old.swap(peers_);
+    const size_t mask = peers_.size() - 1;
+    for (const auto& slot : old) {
+        if (slot.family == 0) continue;
+        size_t i = (hash_addr(slot.addr, addr_len(slot.family)) ^ slot.family) & mask;
+        while (peers_[i].family != 0) i = (i + 1) & mask;
+        peers_[i] = slot;
+    }
+}
+
+void ConnectionAggregator::finish(ConnectionSummary& summary) {
+    summary.total = total_;
+    summary.groups.clear();
+    summary.top_remote_peers.clear();
+
+    order_.clear();
+    for (uint32_t i = 0; i < groups_.size(); ++i) {
+        if (groups_[i].key != 0) order_.push_back(i);
+    }
+    std::sort(order_.begin(), order_.end(), [&](uint32_t a, uint32_t b) {
+        if (groups_[a].count != groups_[b].count) return groups_[a].count > groups_[b].count;
+        return groups_[a].key < groups_[b].key;
+    });
+    summary.groups.reserve(order_.size());
+    for (uint32_t index : order_) {
+        const GroupSlot& slot = groups_[index];
+        const bool udp = (slot.key >> 24) & 1u;
+        const uint8_t state = static_cast<uint8_t>((slot.key >> 16) & 0xFF);
+        ConnectionGroup group;
+        group.protocol = udp ? "UDP" : "TCP";
+        group.state = udp ? udp_state_name(state) : tcp_state_name(state);
+        group.local_port = static_cast<uint16_t>(slot.key & 0xFFFF);
+        group.count = slot.count;
+        summary.groups.push_back(std::move(group));
+    }
+
+    // Top-N адресов: частичная сортировка, полный список не упорядочивается
+    order_.clear();
+    for (uint32_t i = 0; i < peers_.size(); ++i) {
+        if (peers_[i].family != 0) order_.push_back(i);
+    }
+    const size_t n = std::min(top_peers_, order_.size());
+    std::partial_sort(order_.begin(), order_.begin() + n, order_.end(), [&](uint32_t a, uint32_t b) {
+        return peers_[a].count > peers_[b].count;
+    });
+    summary.top_remote_peers.reserve(n);
+    char ip[INET6_ADDRSTRLEN];
+    for (size_t i = 0; i < n; ++i) {
+        const PeerSlot& slot = peers_[order_[i]];
+        inet_ntop(slot.family, slot.addr, ip, sizeof(ip));
+        summary.top_remote_peers.push_back(RemotePeer{ip, slot.count});
+    }
+}
+
+} // namespace monitoring
@@ -0,0 +1,128 @@
+/**
+ * @file disk_stats.cpp
+ * @brief Реализация разбора /proc/diskstats
+ */
+
+#include "../include/disk_stats.hpp"
+
+#include <algorithm>
+#include <filesystem>
+
+namespace monitoring {
+
+namespace {
+
+constexpr double kSectorBytes = 512.0;
+
+double rate(uint64_t current, uint64_t previous, double seconds) {
+    if (current < previous || seconds <= 0) return 0;
+    return static_cast<double>(current - previous) / seconds;
+}
+
+// Среднее время запроса: прирост времени на прирост числа запросов
+double await_ms(uint64_t ms, uint64_t prev_ms, uint64_t ops, uint64_t prev_ops) {
+    if (ops <= prev_ops || ms < prev_ms) return 0;
+    return static_cast<double>(ms - prev_ms) / static_cast<double>(ops - prev_ops);
+}
+
+} // namespace
+
+DiskStatsTracker::DiskStatsTracker(std::string path, std::string sysfs_root)
+    : file_(std::move(path), 16384), sysfs_root_(std::move(sysfs_root)) {}
+
+// /sys/class/block/sda1 -> ../../devices/.../block/sda/sda1; у раздела есть атрибут partition
+void DiskStatsTracker::resolve_parent(Device& device) const {
+    namespace fs = std::filesystem;
+    device.parent.clear();
+    std::error_code ec;
+    const fs::path link = fs::path(sysfs_root_) / "class/block" / device.name;
+    if (!fs::exists(link / "partition", ec)) return;
+    fs::path target = fs::canonical(link, ec);
+    if (!ec) device.parent = target.parent_path().filename().string();
+}
+
+bool DiskStatsTracker::update() {
+    if (!file_.read()) return false;
+    const auto now = std::chrono::steady_clock::now();
+    const double seconds = has_previous_ ? std::chrono::duration<double>(now - last_update_).count() : 0;
+
+    devices_.swap(previous_);
+    size_t count = 0;
+    size_t hint = 0;
+    procfs::Scanner sc(file_.data());
+    if (!sc.eof()) {
+        //    8       0 sda 4128 1251 250710 1652 1734 2340 56176 2101 0 2564 3754 ...
+        do {
+            uint64_t major = 0, minor = 0;
+            if (!sc.parse_u64(major) || !sc.parse_u64(minor)) continue;
+            std::string_view name = sc.token();
+            DiskIoCounters c;
+            uint64_t skip = 0;
+            if (!sc.parse_u64(c.reads) || !sc.parse_u64(skip) || !sc.parse_u64(c.sectors_read) ||
+                !sc.parse_u64(c.read_ms) || !sc.parse_u64(c.writes) || !sc.parse_u64(skip) ||
+                !sc.parse_u64(c.sectors_written) || !sc.parse_u64(c.write_ms) ||
+                !sc.parse_u64(c.in_flight) || !sc.parse_u64(c.io_ms) || !sc.parse_u64(c.weighted_io_ms)) {
+                continue;
+            }
+
+            if (count == devices_.size()) devices_.emplace_back();
+            Device& device = devices_[count++];
+            device.major = static_cast<uint32_t>(major);
+            device.minor = static_cast<uint32_t>(minor);
+            device.counters = c;
+            device.rates = DiskIoRates{};
+
+            // Порядок строк обычно не меняется — сначала проверяем ту же позицию
+            const Device* prev = nullptr;
+            if (hint < previous_.size() && previous_[hint].major == device.major &&
+                previous_[hint].minor == device.minor) {
+                prev = &previous_[hint];
+            } else {
+                for (size_t i = 0; i < previous_.size(); ++i) {
+                    if (previous_[i].major == device.major && previous_[i].minor == device.minor) {
+                        prev = &previous_[i];
+                        hint = i;
+                        break;
+                    }
+                }
+            }
+            ++hint;
+
+            // Имя и родитель переносятся из прошлого цикла; sysfs читается
+            // только для нового устройства
+            if (prev && prev->name == name) {
+                if (device.name != prev->name) device.name.assign(name.data(), name.size());
+                if (device.parent != prev->parent) device.parent.assign(prev->parent);
+            } else {
+                device.name.assign(name.data(), name.size());
+                resolve_parent(device);
+            }
+
+            if (prev && seconds > 0) {
+                const DiskIoCounters& p = prev->counters;
+                device.rates.read_bytes_per_sec = rate(c.sectors_read, p.sectors_read, seconds) * kSectorBytes;
+                device.rates.write_bytes_per_sec = rate(c.sectors_written, p.sectors_written, seconds) * kSectorBytes;
+                device.rates.reads_per_sec = rate(c.reads, p.reads, seconds);
+                device.rates.writes_per_sec = rate(c.writes, p.writes, seconds);
+                device.rates.read_await_ms = await_ms(c.read_ms, p.read_ms, c.reads, p.reads);
+                device.rates.write_await_ms = await_ms(c.write_ms, p.write_ms, c.writes, p.writes);
+                // io_ms и weighted_io_ms — миллисекунды за секунду интервала
+                device.rates.utilization_percent = std::min(100.0, rate(c.io_ms, p.io_ms, seconds) / 10.0);
+                device.rates.queue_depth = rate(c.weighted_io_ms, p.weighted_io_ms, seconds) / 1000.0;
+            }
+        } while (sc.next_line());
+    }
+    devices_.resize(count);
+    last_update_ = now;
+    has_previous_ = true;
+    return true;
+}
+
+const DiskStatsTracker::Device* DiskStatsTracker::find(uint32_t major, uint32_t minor) const {
+    for (const auto& device : devices_) {
+        if (device.major == major && device.minor == minor) return &device;
+    }
+    return nullptr;
+}
+
+} // namespace monitoring
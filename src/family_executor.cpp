@@ -0,0 +1,60 @@
+/**
+ * @file family_executor.cpp
+ * @brief Реализация пула потоков для сбора семейств метрик
+ */
+
+#include "../include/family_executor.hpp"
+
+namespace monitoring {
+
+FamilyExecutor::FamilyExecutor(size_t threads) {
+    if (threads == 0) threads = 1;
+    threads_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) threads_.emplace_back(&FamilyExecutor::worker_loop, this);
+}
+
+FamilyExecutor::~FamilyExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto& thread : threads_) thread.join();
+}
+
+bool FamilyExecutor::submit(uint32_t family, std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (busy_ & family) return false;
+        busy_ |= family;
+        queue_.emplace_back(family, std::move(task));
+    }
+    work_cv_.notify_one();
+    return true;
+}
+
+bool FamilyExecutor::wait(uint32_t family, std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return done_cv_.wait_until(lock, deadline, [&] { return !(busy_ & family); });
+}
+
+void FamilyExecutor::worker_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        work_cv_.wait(lock, [&] { return stop_ || !queue_.empty(); });
+        if (queue_.empty()) return;  // stop_ и очередь разобрана
+        auto [family, task] = std::move(queue_.front());
+        queue_.pop_front();
+        lock.unlock();
+        try {
+            task();
+        } catch (...) {
+            // Результат семейства не обновится, сборщик отметит его как устаревший
+        }
+        lock.lock();
+        busy_ &= ~family;
+        done_cv_.notify_all();
+    }
+}
+
+} // namespace monitoring
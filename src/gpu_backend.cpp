@@ -0,0 +1,264 @@
+/**
+ * @file gpu_backend.cpp
+ * @brief Реализация телеметрии GPU через NVML и sysfs amdgpu
+ */
+
+#include "../include/gpu_backend.hpp"
+#include "../include/pci_devices.hpp"
+
+#include <dlfcn.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <string_view>
+
+namespace monitoring {
+
+namespace {
+
+// Минимальное подмножество C API NVML (nvml.h), объявленное локально,
+// чтобы сборка не зависела от CUDA Toolkit
+constexpr int kNvmlSuccess = 0;
+constexpr int kNvmlTemperatureGpu = 0;
+constexpr unsigned int kNvmlNameBufferSize = 96;
+
+struct NvmlUtilization {
+    unsigned int gpu;
+    unsigned int memory;
+};
+
+struct NvmlMemory {
+    unsigned long long total;
+    unsigned long long free;
+    unsigned long long used;
+};
+
+struct NvmlPciInfo {
+    char bus_id_legacy[16];
+    unsigned int domain;
+    unsigned int bus;
+    unsigned int device;
+    unsigned int pci_device_id;
+    unsigned int pci_subsystem_id;
+    char bus_id[32];
+};
+
+using nvmlInit_t = int (*)();
+using nvmlShutdown_t = int (*)();
+using nvmlDeviceGetCount_t = int (*)(unsigned int*);
+using nvmlDeviceGetHandleByIndex_t = int (*)(unsigned int, void**);
+using nvmlDeviceGetName_t = int (*)(void*, char*, unsigned int);
+using nvmlDeviceGetPciInfo_t = int (*)(void*, NvmlPciInfo*);
+using nvmlDeviceGetTemperature_t = int (*)(void*, int, unsigned int*);
+using nvmlDeviceGetUtilizationRates_t = int (*)(void*, NvmlUtilization*);
+using nvmlDeviceGetMemoryInfo_t = int (*)(void*, NvmlMemory*);
+
+// Первое число из атрибута sysfs
+bool read_u64(procfs::ProcFile& file, uint64_t& value) {
+    if (!file.read()) return false;
+    procfs::Scanner sc(file.data());
+    return sc.parse_u64(value);
+}
+
+// "0x1002\n" -> 0x1002
+bool read_hex_attribute(const std::filesystem::path& path, uint64_t& value) {
+    procfs::ProcFile file(path.string(), 64);
+    if (!file.read()) return false;
+    std::string_view data = file.data();
+    while (!data.empty() && (data.back() == '\n' || data.back() == ' ')) data.remove_suffix(1);
+    if (data.size() > 2 && data[0] == '0' && (data[1] == 'x' || data[1] == 'X')) data.remove_prefix(2);
+    return procfs::parse_hex(data, value);
+}
+
+// Номер карты из "card0"; -1 для разъемов вроде "card0-DP-1" и прочих записей
+int card_index(const std::string& name) {
+    if (name.compare(0, 4, "card") != 0) return -1;
+    uint64_t index = 0;
+    if (!procfs::parse_u64(std::string_view(name).substr(4), index)) return -1;
+    return static_cast<int>(index);
+}
+
+constexpr uint64_t kAmdVendorId = 0x1002;
+
+} // namespace
+
+struct GpuBackend::Nvml {
+    void* lib = nullptr;
+    nvmlShutdown_t shutdown = nullptr;
+    nvmlDeviceGetTemperature_t get_temperature = nullptr;
+    nvmlDeviceGetUtilizationRates_t get_utilization = nullptr;
+    nvmlDeviceGetMemoryInfo_t get_memory = nullptr;
+    std::vector<void*> handles;
+    std::vector<GpuDevice> devices;
+
+    ~Nvml() {
+        if (shutdown) shutdown();
+        if (lib) ::dlclose(lib);
+    }
+};
+
+GpuBackend::AmdCard::AmdCard(GpuDevice device, const std::string& dir, const std::string& temp_path)
+    : info(std::move(device)),
+      busy_percent(dir + "/gpu_busy_percent", 32),
+      vram_used(dir + "/mem_info_vram_used", 32),
+      vram_total(dir + "/mem_info_vram_total", 32),
+      temperature(temp_path, 32),
+      has_temperature(!temp_path.empty()) {}
+
+GpuBackend::GpuBackend(std::string sysfs_root, bool use_nvml) : root_(std::move(sysfs_root)) {
+    if (use_nvml) detect_nvml();
+    detect_amdgpu();
+}
+
+GpuBackend::~GpuBackend() = default;
+
+void GpuBackend::detect_nvml() {
+    void* lib = nullptr;
+    for (const char* name : {"libnvidia-ml.so.1", "libnvidia-ml.so"}) {
+        lib = ::dlopen(name, RTLD_NOW | RTLD_LOCAL);
+        if (lib) break;
+    }
+    if (!lib) return;
+
+    auto init = reinterpret_cast<nvmlInit_t>(::dlsym(lib, "nvmlInit_v2"));
+    auto get_count = reinterpret_cast<nvmlDeviceGetCount_t>(::dlsym(lib, "nvmlDeviceGetCount_v2"));
+    auto get_handle = reinterpret_cast<nvmlDeviceGetHandleByIndex_t>(::dlsym(lib, "nvmlDeviceGetHandleByIndex_v2"));
+    auto get_name = reinterpret_cast<nvmlDeviceGetName_t>(::dlsym(lib, "nvmlDeviceGetName"));
+    auto get_pci = reinterpret_cast<nvmlDeviceGetPciInfo_t>(::dlsym(lib, "nvmlDeviceGetPciInfo_v3"));
+    auto nvml = std::make_unique<Nvml>();
+    nvml->shutdown = reinterpret_cast<nvmlShutdown_t>(::dlsym(lib, "nvmlShutdown"));
+    nvml->get_temperature = reinterpret_cast<nvmlDeviceGetTemperature_t>(::dlsym(lib, "nvmlDeviceGetTemperature"));
+    nvml->get_utilization = reinterpret_cast<nvmlDeviceGetUtilizationRates_t>(::dlsym(lib, "nvmlDeviceGetUtilizationRates"));
+    nvml->get_memory = reinterpret_cast<nvmlDeviceGetMemoryInfo_t>(::dlsym(lib, "nvmlDeviceGetMemoryInfo"));
+    if (!init || !get_count || !get_handle || !nvml->shutdown || !nvml->get_temperature ||
+        !nvml->get_utilization || !nvml->get_memory) {
+        ::dlclose(lib);
+        return;
+    }
+    // Библиотека есть, но драйвер не загружен (или нет устройств)
+    if (init() != kNvmlSuccess) {
+        ::dlclose(lib);
+        return;
+    }
+    nvml->lib = lib;
+
+    unsigned int count = 0;
+    if (get_count(&count) != kNvmlSuccess) return;
+    for (unsigned int i = 0; i < count; ++i) {
+        void* handle = nullptr;
+        if (get_handle(i, &handle) != kNvmlSuccess) continue;
+        GpuDevice device;
+        device.name = "nvidia" + std::to_string(i);
+        device.vendor = "nvidia";
+        char name[kNvmlNameBufferSize] = {};
+        if (get_name && get_name(handle, name, sizeof(name)) == kNvmlSuccess) device.model = name;
+        NvmlPciInfo pci{};
+        if (get_pci && get_pci(handle, &pci) == kNvmlSuccess) {
+            pci.bus_id[sizeof(pci.bus_id) - 1] = '\0';
+            device.pci_address = pci.bus_id;
+            std::transform(device.pci_address.begin(), device.pci_address.end(), device.pci_address.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        }
+        nvml->handles.push_back(handle);
+        nvml->devices.push_back(std::move(device));
+    }
+    nvml_device_count_ = static_cast<unsigned int>(nvml->handles.size());
+    nvml_ = std::move(nvml);
+}
+
+void GpuBackend::detect_amdgpu() {
+    namespace fs = std::filesystem;
+    std::vector<std::pair<int, fs::path>> cards;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(fs::path(root_) / "class/drm", ec)) {
+        int index = card_index(entry.path().filename().string());
+        if (index >= 0) cards.emplace_back(index, entry.path() / "device");
+    }
+    std::sort(cards.begin(), cards.end());
+
+    for (const auto& [index, device_dir] : cards) {
+        uint64_t vendor = 0, device_id = 0;
+        if (!read_hex_attribute(device_dir / "vendor", vendor) || vendor != kAmdVendorId) continue;
+        if (!fs::exists(device_dir / "gpu_busy_percent", ec)) continue;
+        read_hex_attribute(device_dir / "device", device_id);
+
+        GpuDevice info;
+        info.name = "card" + std::to_string(index);
+        info.vendor = "amd";
+        PciDevice pci;
+        pci.vendor_id = static_cast<uint16_t>(vendor);
+        pci.device_id = static_cast<uint16_t>(device_id);
+        info.model = pci_device_description(pci);
+        fs::path canonical = fs::canonical(device_dir, ec);
+        info.pci_address = ec ? std::string() : canonical.filename().string();
+
+        std::string temp_path;
+        for (const auto& hwmon : fs::directory_iterator(device_dir / "hwmon", ec)) {
+            fs::path candidate = hwmon.path() / "temp1_input";
+            if (fs::exists(candidate, ec)) {
+                temp_path = candidate.string();
+                break;
+            }
+        }
+        amd_cards_.emplace_back(std::move(info), device_dir.string(), temp_path);
+    }
+}
+
+void GpuBackend::collect(GpuMetrics& metrics) {
+    metrics.temperature = 0.0;
+    metrics.usage_percent = -1.0;
+    metrics.memory_used = 0;
+    metrics.memory_total = 0;
+    metrics.devices.clear();
+    if (!has_devices()) return;
+
+    collect_nvml(metrics);
+    collect_amdgpu(metrics);
+
+    if (!metrics.devices.empty()) {
+        const GpuDevice& first = metrics.devices.front();
+        metrics.temperature = first.temperature;
+        metrics.usage_percent = first.usage_percent;
+        metrics.memory_used = first.memory_used;
+        metrics.memory_total = first.memory_total;
+    }
+}
+
+void GpuBackend::collect_nvml(GpuMetrics& metrics) {
+    if (!nvml_) return;
+    for (size_t i = 0; i < nvml_->handles.size(); ++i) {
+        void* handle = nvml_->handles[i];
+        GpuDevice device = nvml_->devices[i];
+        unsigned int temp = 0;
+        if (nvml_->get_temperature(handle, kNvmlTemperatureGpu, &temp) == kNvmlSuccess) {
+            device.temperature = temp;
+        }
+        NvmlUtilization utilization{};
+        if (nvml_->get_utilization(handle, &utilization) == kNvmlSuccess) {
+            device.usage_percent = utilization.gpu;
+        }
+        NvmlMemory memory{};
+        if (nvml_->get_memory(handle, &memory) == kNvmlSuccess) {
+            device.memory_used = memory.used;
+            device.memory_total = memory.total;
+        }
+        metrics.devices.push_back(std::move(device));
+    }
+}
+
+void GpuBackend::collect_amdgpu(GpuMetrics& metrics) {
+    for (auto& card : amd_cards_) {
+        GpuDevice device = card.info;
+        uint64_t value = 0;
+        if (read_u64(card.busy_percent, value)) device.usage_percent = static_cast<double>(value);
+        if (read_u64(card.vram_used, value)) device.memory_used = value;
+        if (read_u64(card.vram_total, value)) device.memory_total = value;
+        if (card.has_temperature && read_u64(card.temperature, value)) {
+            device.temperature = static_cast<double>(value) / 1000.0;
+        }
+        metrics.devices.push_back(std::move(device));
+    }
+}
+
+} // namespace monitoring
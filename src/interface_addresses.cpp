@@ -0,0 +1,106 @@
+/**
+ * @file interface_addresses.cpp
+ * @brief Реализация чтения адресов сетевых интерфейсов
+ */
+
+#include "../include/interface_addresses.hpp"
+#include "../include/rtnetlink_links.hpp"
+
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <net/if_arp.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <linux/if_packet.h>
+#include <linux/rtnetlink.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+namespace monitoring {
+
+namespace {
+
+InterfaceAddresses& find_or_add(std::vector<InterfaceAddresses>& list, const char* name, unsigned int flags) {
+    for (auto& item : list) {
+        if (item.name == name) return item;
+    }
+    list.push_back(InterfaceAddresses{});
+    list.back().name = name;
+    list.back().flags = flags;
+    return list.back();
+}
+
+// "aa:bb:cc:dd:ee:ff"; пусто для нулевого адреса
+std::string format_mac(const unsigned char* addr, size_t len) {
+    bool zero = true;
+    for (size_t i = 0; i < len; ++i) zero = zero && addr[i] == 0;
+    if (len == 0 || zero) return "";
+    std::string mac(len * 3 - 1, ':');
+    for (size_t i = 0; i < len; ++i) {
+        char hex[3];
+        std::snprintf(hex, sizeof(hex), "%02x", addr[i]);
+        mac[i * 3] = hex[0];
+        mac[i * 3 + 1] = hex[1];
+    }
+    return mac;
+}
+
+} // namespace
+
+std::vector<InterfaceAddresses> read_interface_addresses() {
+    std::vector<InterfaceAddresses> result;
+    struct ifaddrs* ifaddr = nullptr;
+    if (getifaddrs(&ifaddr) == -1) return result;
+
+    char ip[INET6_ADDRSTRLEN];
+    for (struct ifaddrs* ifa = ifaddr; ifa != nullptr; ifa = ifa->ifa_next) {
+        if (ifa->ifa_name == nullptr) continue;
+        InterfaceAddresses& item = find_or_add(result, ifa->ifa_name, ifa->ifa_flags);
+        if (ifa->ifa_addr == nullptr) continue;
+
+        switch (ifa->ifa_addr->sa_family) {
+        case AF_PACKET: {
+            const auto* ll = reinterpret_cast<const struct sockaddr_ll*>(ifa->ifa_addr);
+            item.flags = ifa->ifa_flags;
+            if (ll->sll_hatype != ARPHRD_LOOPBACK) {
+                item.mac = format_mac(ll->sll_addr, std::min<size_t>(ll->sll_halen, sizeof(ll->sll_addr)));
+            }
+            break;
+        }
+        case AF_INET: {
+            const auto* sa = reinterpret_cast<const struct sockaddr_in*>(ifa->ifa_addr);
+            if (inet_ntop(AF_INET, &sa->sin_addr, ip, sizeof(ip))) item.ipv4.emplace_back(ip);
+            break;
+        }
+        case AF_INET6: {
+            const auto* sa = reinterpret_cast<const struct sockaddr_in6*>(ifa->ifa_addr);
+            if (inet_ntop(AF_INET6, &sa->sin6_addr, ip, sizeof(ip))) item.ipv6.emplace_back(ip);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    freeifaddrs(ifaddr);
+    return result;
+}
+
+std::vector<InterfaceAddresses> interface_addresses() {
+    static std::mutex cache_mutex;
+    static RtnetlinkMonitor monitor(RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR);
+    static std::vector<InterfaceAddresses> cache;
+    static bool valid = false;
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    // Подписка создается до первого чтения, поэтому изменения между
+    // чтением и следующим вызовом не теряются
+    if (monitor.changed() || !valid) {
+        cache = read_interface_addresses();
+        valid = monitor.available();
+    }
+    return cache;
+}
+
+} // namespace monitoring
@@ -0,0 +1,97 @@
+/**
+ * @file interface_rates.cpp
+ * @brief Реализация расчета скоростей сетевых интерфейсов
+ */
+
+#include "../include/interface_rates.hpp"
+
+#include <cstdint>
+#include <limits>
+
+namespace monitoring {
+
+namespace {
+
+/**
+ * @brief Прирост счетчика с учетом переполнения
+ *
+ * Уменьшение считается переполнением 32-битного счетчика, только если
+ * прошлое значение было в верхней половине его диапазона: иначе это сброс
+ * (перезапуск драйвера, пересоздание интерфейса), а не переход через ноль.
+ *
+ * @return false, если счетчик был сброшен и прирост неизвестен
+ */
+bool counter_delta(uint64_t prev, uint64_t cur, uint64_t& delta) {
+    if (cur >= prev) {
+        delta = cur - prev;
+        return true;
+    }
+    constexpr uint64_t kMax32 = std::numeric_limits<uint32_t>::max();
+    if (prev > kMax32 / 2 && prev <= kMax32 && cur <= kMax32) {
+        delta = (kMax32 - prev) + cur + 1;
+        return true;
+    }
+    return false;
+}
+
+uint64_t per_second(uint64_t delta, double seconds) {
+    return static_cast<uint64_t>(static_cast<double>(delta) / seconds + 0.5);
+}
+
+} // namespace
+
+void InterfaceRateTracker::begin_cycle(std::chrono::steady_clock::time_point now) {
+    now_ = now;
+    ++generation_;
+}
+
+void InterfaceRateTracker::update(int ifindex, const InterfaceCounters& counters, NetworkInterface& iface) {
+    iface.bandwidth_sent = 0;
+    iface.bandwidth_received = 0;
+    iface.packets_sent_rate = 0;
+    iface.packets_received_rate = 0;
+
+    auto [it, inserted] = states_.try_emplace(ifindex);
+    State& state = it->second;
+    state.generation = generation_;
+    if (inserted) {
+        state.counters = counters;
+        state.time = now_;
+        return;
+    }
+
+    const double seconds = std::chrono::duration<double>(now_ - state.time).count();
+    uint64_t rx_bytes = 0, tx_bytes = 0, rx_packets = 0, tx_packets = 0;
+    const bool valid = counter_delta(state.counters.rx_bytes, counters.rx_bytes, rx_bytes) &&
+                       counter_delta(state.counters.tx_bytes, counters.tx_bytes, tx_bytes) &&
+                       counter_delta(state.counters.rx_packets, counters.rx_packets, rx_packets) &&
+                       counter_delta(state.counters.tx_packets, counters.tx_packets, tx_packets);
+    // Слишком короткий интервал дает шумные значения — копим дальше
+    if (seconds < 0.01) {
+        if (!valid) {
+            state.counters = counters;
+            state.time = now_;
+        }
+        return;
+    }
+    if (valid) {
+        iface.bandwidth_received = per_second(rx_bytes, seconds);
+        iface.bandwidth_sent = per_second(tx_bytes, seconds);
+        iface.packets_received_rate = per_second(rx_packets, seconds);
+        iface.packets_sent_rate = per_second(tx_packets, seconds);
+    }
+    state.counters = counters;
+    state.time = now_;
+}
+
+void InterfaceRateTracker::end_cycle() {
+    for (auto it = states_.begin(); it != states_.end();) {
+        if (it->second.generation != generation_) {
+            it = states_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+} // namespace monitoring
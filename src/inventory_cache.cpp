@@ -0,0 +1,181 @@
+/**
+ * @file inventory_cache.cpp
+ * @brief Реализация кэша инвентаризационных данных
+ */
+
+#include "../include/inventory_cache.hpp"
+#include "../include/procfs_reader.hpp"
+#include "../include/nlohmann/json.hpp"
+
+#include <sys/stat.h>
+#include <linux/rtnetlink.h>
+#include <cstdio>
+#include <fstream>
+
+namespace monitoring {
+
+namespace {
+
+constexpr int kCacheVersion = 2;
+
+// Базы пакетов: dpkg и rpm (BerkeleyDB, NDB и sqlite в разных дистрибутивах)
+const char* const kPackageDatabases[] = {
+    "/var/lib/dpkg/status",
+    "/var/lib/rpm/Packages",
+    "/var/lib/rpm/Packages.db",
+    "/var/lib/rpm/rpmdb.sqlite",
+    "/usr/lib/sysimage/rpm/Packages.db",
+    "/usr/lib/sysimage/rpm/rpmdb.sqlite",
+};
+
+void mix(uint64_t& h, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        h ^= (value >> (i * 8)) & 0xFF;
+        h *= 1099511628211ull;
+    }
+}
+
+} // namespace
+
+InventoryCache::InventoryCache()
+    : link_monitor_(RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR) {
+    boot_id_ = read_boot_id();
+}
+
+void InventoryCache::set_path(const std::string& path) {
+    if (path == path_) return;
+    path_ = path;
+    if (!path_.empty() && !(valid_parts_ & (kHardware | kSoftware))) load();
+}
+
+std::string InventoryCache::read_boot_id() {
+    procfs::ProcFile file("/proc/sys/kernel/random/boot_id", 64);
+    if (!file.read()) return "";
+    procfs::Scanner sc(file.data());
+    return std::string(sc.token());
+}
+
+int64_t InventoryCache::packages_signature() {
+    uint64_t h = 14695981039346656037ull;
+    bool any = false;
+    for (size_t i = 0; i < sizeof(kPackageDatabases) / sizeof(kPackageDatabases[0]); ++i) {
+        struct stat st{};
+        if (::stat(kPackageDatabases[i], &st) != 0) continue;
+        any = true;
+        mix(h, i);
+        mix(h, static_cast<uint64_t>(st.st_mtim.tv_sec));
+        mix(h, static_cast<uint64_t>(st.st_mtim.tv_nsec));
+        mix(h, static_cast<uint64_t>(st.st_size));
+    }
+    return any ? static_cast<int64_t>(h) : 0;
+}
+
+uint32_t InventoryCache::stale_parts() {
+    uint32_t stale = 0;
+    if (!(valid_parts_ & kHardware)) stale |= kHardware;
+
+    const int64_t signature = packages_signature();
+    if (!(valid_parts_ & kSoftware) || signature != packages_signature_) {
+        stale |= kSoftware;
+        packages_signature_ = signature; // фиксируем до сбора: изменения во время сбора не потеряются
+        valid_parts_ &= ~kSoftware;
+    }
+
+    // Очередь уведомлений вычитываем всегда, чтобы старые события не копились
+    if (link_monitor_.changed() || !(valid_parts_ & kAddresses)) {
+        stale |= kAddresses;
+        valid_parts_ &= ~kAddresses;
+    }
+    return stale;
+}
+
+void InventoryCache::commit(uint32_t parts) {
+    valid_parts_ |= parts;
+    if (parts & (kHardware | kSoftware)) save();
+}
+
+void InventoryCache::load() {
+    nlohmann::json j;
+    try {
+        std::ifstream file(path_);
+        if (!file.is_open()) return;
+        file >> j;
+    } catch (const std::exception&) {
+        return;
+    }
+    if (!j.is_object() || j.value("version", 0) != kCacheVersion) return;
+
+    try {
+        if (!boot_id_.empty() && j.value("boot_id", "") == boot_id_ && j.contains("hardware")) {
+            const auto& hw = j["hardware"];
+            snapshot_.device_type = hw.value("device_type", "");
+            snapshot_.manufacturer = hw.value("manufacturer", "");
+            snapshot_.model = hw.value("model", "");
+            snapshot_.serial_number = hw.value("serial_number", "");
+            snapshot_.uuid = hw.value("uuid", "");
+            snapshot_.os_name = hw.value("os_name", "");
+            snapshot_.os_version = hw.value("os_version", "");
+            snapshot_.cpu_model = hw.value("cpu_model", "");
+            snapshot_.cpu_frequency = hw.value("cpu_frequency", "");
+            snapshot_.memory_type = hw.value("memory_type", "");
+            snapshot_.disk_model = hw.value("disk_model", "");
+            snapshot_.disk_type = hw.value("disk_type", "");
+            snapshot_.disk_total_bytes = hw.value("disk_total_bytes", uint64_t{0});
+            snapshot_.gpu_model = hw.value("gpu_model", "");
+            valid_parts_ |= kHardware;
+        }
+        const int64_t signature = packages_signature();
+        if (signature != 0 && j.value("packages_signature", int64_t{0}) == signature &&
+            j.contains("installed_software")) {
+            snapshot_.installed_software = j["installed_software"].get<std::vector<std::string>>();
+            snapshot_.installed_software_versions =
+                j.value("installed_software_versions", std::vector<std::string>{});
+            packages_signature_ = signature;
+            valid_parts_ |= kSoftware;
+        }
+    } catch (const std::exception&) {
+        // Поврежденный файл — просто соберем заново
+        valid_parts_ &= ~(kHardware | kSoftware);
+    }
+}
+
+void InventoryCache::save() const {
+    if (path_.empty()) return;
+    nlohmann::json j;
+    j["version"] = kCacheVersion;
+    j["boot_id"] = boot_id_;
+    j["packages_signature"] = packages_signature_;
+    if (valid_parts_ & kHardware) {
+        auto& hw = j["hardware"];
+        hw["device_type"] = snapshot_.device_type;
+        hw["manufacturer"] = snapshot_.manufacturer;
+        hw["model"] = snapshot_.model;
+        hw["serial_number"] = snapshot_.serial_number;
+        hw["uuid"] = snapshot_.uuid;
+        hw["os_name"] = snapshot_.os_name;
+        hw["os_version"] = snapshot_.os_version;
+        hw["cpu_model"] = snapshot_.cpu_model;
+        hw["cpu_frequency"] = snapshot_.cpu_frequency;
+        hw["memory_type"] = snapshot_.memory_type;
+        hw["disk_model"] = snapshot_.disk_model;
+        hw["disk_type"] = snapshot_.disk_type;
+        hw["disk_total_bytes"] = snapshot_.disk_total_bytes;
+        hw["gpu_model"] = snapshot_.gpu_model;
+    }
+    if (valid_parts_ & kSoftware) {
+        j["installed_software"] = snapshot_.installed_software;
+        j["installed_software_versions"] = snapshot_.installed_software_versions;
+    }
+
+    // Запись через временный файл, чтобы не оставить обрезанный кэш
+    const std::string tmp = path_ + ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::trunc);
+        if (!file.is_open()) return;
+        file << j.dump();
+        if (!file.good()) return;
+    }
+    std::rename(tmp.c_str(), path_.c_str());
+}
+
+} // namespace monitoring
@@ -7,8 +7,10 @@
  * системных вызовов. Метрики включают CPU, память, диски, сеть, GPU и HDD.
  */
 
-#include "../include/metrics_collector.hpp"
-#include "../include/nlohmann/json.hpp"
+#include "../include/linux_metrics_collector.hpp"
+#include "../include/package_db.hpp"
+#include "../include/pci_devices.hpp"
+#include "../include/interface_addresses.hpp"
 #include <fstream>
 #include <sstream>
 #include <filesystem>
@@ -32,8 +34,10 @@
 #include <cstdio>
 #include <array>
 #include <map>
+#include <algorithm>
 #include <thread>
 #include <limits>
+#include <iterator>
 #include <chrono>
 #include <pwd.h>
 #include <netdb.h>
@@ -55,685 +59,911 @@ using namespace monitoring;
 
 namespace monitoring {
 
+#ifdef __linux__
+
+FILE* popen_hidden(const char* command, const char* mode);
+
 /**
- * @class LinuxMetricsCollector
- * @brief Класс для сбора системных метрик в Linux
+ * @brief Конструктор класса
+ * @throw std::runtime_error если недоступны необходимые системные файлы
  * 
- * Реализует интерфейс MetricsCollector для сбора различных системных метрик
- * в Linux через чтение системных файлов (/proc, /sys) и использование системных вызовов.
+ * Проверяет наличие и доступность критически важных системных файлов
+ * для сбора метрик.
  */
-#ifdef __linux__
-class LinuxMetricsCollector : public MetricsCollector {
-private:
-    // Удаляю last_cpu_times, last_network_stats, last_network_collection_time
-
-public:
-    /**
-     * @brief Конструктор класса
-     * @throw std::runtime_error если недоступны необходимые системные файлы
-     * 
-     * Проверяет наличие и доступность критически важных системных файлов
-     * для сбора метрик.
-     */
-    LinuxMetricsCollector() {
-        if (!std::filesystem::exists("/proc/stat") || !std::filesystem::exists("/proc/meminfo")) {
-            throw std::runtime_error("Cannot access /proc/stat or /proc/meminfo");
+LinuxMetricsCollector::LinuxMetricsCollector() {
+    if (!std::filesystem::exists("/proc/stat") || !std::filesystem::exists("/proc/meminfo")) {
+        throw std::runtime_error("Cannot access /proc/stat or /proc/meminfo");
+    }
+    ioctl_socket = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+
+    // Prime the stats for stateful calculation
+    read_cpu_times(last_cpu_times);
+    NetworkMetrics dummy_net_metrics;
+    collect_network_metrics(dummy_net_metrics, CollectOptions{});
+
+    // Диапазон эфемерных портов: такие локальные порты в сводке не различаются
+    procfs::ProcFile port_range("/proc/sys/net/ipv4/ip_local_port_range", 64);
+    if (port_range.read()) {
+        procfs::Scanner sc(port_range.data());
+        uint64_t low = 0, high = 0;
+        if (sc.parse_u64(low) && sc.parse_u64(high) && low <= high && high <= 65535) {
+            connection_aggregator.set_ephemeral_range(static_cast<uint16_t>(low), static_cast<uint16_t>(high));
         }
-        // Prime the stats for stateful calculation
-        // Удаляю last_cpu_times, last_network_stats, last_network_collection_time
-        collect_cpu_metrics(); 
-        NetworkMetrics dummy_net_metrics;
-        collect_network_metrics(dummy_net_metrics);
     }
+}
 
-    /**
-     * @brief Сбор всех системных метрик
-     * @return SystemMetrics структура, содержащая все собранные метрики
-     * 
-     * Собирает метрики CPU, памяти, дисков, сети, GPU и HDD,
-     * сохраняя их в единую структуру SystemMetrics.
-     */
-    SystemMetrics collect() override {
-        SystemMetrics metrics;
-        metrics.timestamp = std::chrono::system_clock::now();
-
-        // CPU metrics
-        metrics.cpu = collect_cpu_metrics();
-
-        // Memory metrics
-        metrics.memory = collect_memory_metrics();
+LinuxMetricsCollector::~LinuxMetricsCollector() {
+    if (ioctl_socket >= 0) ::close(ioctl_socket);
+}
 
-        // Disk metrics
-        collect_disk_metrics(metrics.disk);
+/**
+ * @brief Сбор всех системных метрик
+ * @return SystemMetrics структура, содержащая все собранные метрики
+ * 
+ * Собирает метрики CPU, памяти, дисков, сети, GPU и HDD,
+ * сохраняя их в единую структуру SystemMetrics.
+ */
+SystemMetrics LinuxMetricsCollector::collect() {
+    return collect(CollectOptions{});
+}
 
-        // Network metrics
-        collect_network_metrics(metrics.network);
+/**
+ * @brief Сбор выбранных семейств метрик
+ *
+ * Семейства, не попавшие в options.families, не опрашиваются вовсе
+ * (никаких popen/чтений), их поля в результате остаются нулевыми.
+ * Выбранные семейства собираются параллельно в family_executor. Семейство,
+ * не успевшее за family_timeout(), передается с последним удачным
+ * значением и отмечается в stale_families; его задача дорабатывает в
+ * фоне, и до ее завершения семейство заново не запускается.
+ */
+SystemMetrics LinuxMetricsCollector::collect(const CollectOptions& options) {
+    std::lock_guard<std::mutex> lock(collect_mutex);
+    const auto started = std::chrono::steady_clock::now();
+    const uint32_t families = options.families & kAllFamilies;
+    {
+        std::lock_guard<std::mutex> results_lock(results_mutex);
+        updated_families &= ~families;
+    }
 
-        // GPU metrics (если доступно)
-        metrics.gpu = collect_gpu_metrics();
+    uint32_t submitted = 0;
+    for (uint32_t bit = 1; bit & kAllFamilies; bit <<= 1) {
+        if (!(families & bit)) continue;
+        if (family_executor.submit(bit, [this, bit, options] { run_family(bit, options); })) submitted |= bit;
+    }
 
-        // HDD metrics
-        collect_hdd_metrics(metrics.hdd);
+    // Тип машины определяется один раз: systemd-detect-virt — отдельный процесс
+    if (machine_type.empty()) machine_type = detect_machine_type_linux();
 
-        // User metrics
-        metrics.user = collect_user_metrics();
+    for (uint32_t bit = 1; bit & kAllFamilies; bit <<= 1) {
+        if (submitted & bit) family_executor.wait(bit, started + family_timeout(bit));
+    }
 
-        metrics.machine_type = detect_machine_type_linux();
+    SystemMetrics metrics{};
+    metrics.timestamp = std::chrono::system_clock::now();
+    metrics.machine_type = machine_type;
+    std::lock_guard<std::mutex> results_lock(results_mutex);
+    if (families & kFamilyCpu) metrics.cpu = last_good.cpu;
+    if (families & kFamilyMemory) metrics.memory = last_good.memory;
+    if (families & kFamilyDisk) metrics.disk = last_good.disk;
+    if (families & kFamilyNetwork) metrics.network = last_good.network;
+    if (families & kFamilyGpu) metrics.gpu = last_good.gpu;
+    if (families & kFamilyHdd) metrics.hdd = last_good.hdd;
+    if (families & kFamilyUser) metrics.user = last_good.user;
+    if (families & kFamilyInventory) metrics.inventory = last_good.inventory;
+    if (families & kFamilyCgroup) metrics.cgroup = last_good.cgroup;
+    metrics.stale_families = families & ~updated_families;
+    return metrics;
+}
 
-        // === Сбор инвентаря ===
-        metrics.inventory = collect_inventory_info_linux();
+void LinuxMetricsCollector::run_family(uint32_t family, const CollectOptions& options) {
+    switch (family) {
+    case kFamilyCpu: {
+        CpuMetrics cpu = collect_cpu_metrics();
+        std::lock_guard<std::mutex> lock(results_mutex);
+        last_good.cpu = std::move(cpu);
+        break;
+    }
+    case kFamilyMemory: {
+        MemoryMetrics memory = collect_memory_metrics();
+        std::lock_guard<std::mutex> lock(results_mutex);
+        last_good.memory = memory;
+        break;
+    }
+    case kFamilyDisk: {
+        DiskMetrics disk;
+        collect_disk_metrics(disk);
+        std::lock_guard<std::mutex> lock(results_mutex);
+        last_good.disk = std::move(disk);
+        break;
+    }
+    case kFamilyNetwork: {
+        NetworkMetrics network;
+        collect_network_metrics(network, options);
+        std::lock_guard<std::mutex> lock(results_mutex);
+        last_good.network = std::move(network);
+        break;
+    }
+    case kFamilyGpu: {
+        GpuMetrics gpu = collect_gpu_metrics();
+        std::lock_guard<std::mutex> lock(results_mutex);
+        last_good.gpu = std::move(gpu);
+        break;
+    }
+    case kFamilyHdd: {
+        HddMetrics hdd;
+        collect_hdd_metrics(hdd);
+        std::lock_guard<std::mutex> lock(results_mutex);
+        last_good.hdd = std::move(hdd);
+        break;
+    }
+    case kFamilyUser: {
+        UserMetrics user = collect_user_metrics();
+        std::lock_guard<std::mutex> lock(results_mutex);
+        last_good.user = std::move(user);
+        break;
+    }
+    case kFamilyInventory: {
+        InventoryInfo inventory = collect_inventory_info_linux();
+        std::lock_guard<std::mutex> lock(results_mutex);
+        last_good.inventory = std::move(inventory);
+        break;
+    }
+    case kFamilyCgroup: {
+        CgroupMetrics cgroup;
+        cgroup_tracker.update(cgroup);
+        std::lock_guard<std::mutex> lock(results_mutex);
+        last_good.cgroup = std::move(cgroup);
+        break;
+    }
+    default:
+        return;
+    }
+    std::lock_guard<std::mutex> lock(results_mutex);
+    updated_families |= family;
+}
 
-        return metrics;
+void LinuxMetricsCollector::set_family_timeout(uint32_t family, std::chrono::milliseconds timeout) {
+    std::lock_guard<std::mutex> lock(collect_mutex);
+    for (size_t i = 0; i < std::size(family_timeout_ms); ++i) {
+        if (family & (1u << i)) family_timeout_ms[i] = timeout.count() > 0 ? timeout.count() : 1;
     }
+}
 
-    InventoryInfo collect_inventory_info_linux() {
-        InventoryInfo inv;
-        // 1. Тип устройства (попробуем определить по chassis_type)
-        std::ifstream chassis_file("/sys/class/dmi/id/chassis_type");
-        if (chassis_file.is_open()) {
-            std::string chassis;
-            std::getline(chassis_file, chassis);
-            if (chassis == "3") inv.device_type = "Desktop";
-            else if (chassis == "8" || chassis == "9" || chassis == "10" || chassis == "14") inv.device_type = "Laptop";
-            else if (chassis == "23") inv.device_type = "Server";
-            else inv.device_type = chassis;
-        }
-        // 2. Производитель, модель, серийник, UUID
-        auto read_file = [](const char* path) -> std::string {
-            std::ifstream f(path);
-            if (!f.is_open()) return "";
-            std::string s; std::getline(f, s); return s;
-        };
-        inv.manufacturer = read_file("/sys/class/dmi/id/sys_vendor");
-        inv.model = read_file("/sys/class/dmi/id/product_name");
-        inv.serial_number = read_file("/sys/class/dmi/id/product_serial");
-        inv.uuid = read_file("/sys/class/dmi/id/product_uuid");
-        // 3. ОС
-        std::ifstream osf("/etc/os-release");
-        std::string line;
-        while (std::getline(osf, line)) {
-            if (line.rfind("NAME=", 0) == 0 && inv.os_name.empty()) inv.os_name = line.substr(5);
-            if (line.rfind("VERSION=", 0) == 0 && inv.os_version.empty()) inv.os_version = line.substr(8);
-        }
-        // 4. CPU
-        std::ifstream cpuinfo("/proc/cpuinfo");
-        while (std::getline(cpuinfo, line)) {
-            if (line.find("model name") != std::string::npos && inv.cpu_model.empty()) {
-                auto pos = line.find(":");
-                if (pos != std::string::npos) inv.cpu_model = line.substr(pos+2);
-            }
-            if (line.find("cpu MHz") != std::string::npos && inv.cpu_frequency.empty()) {
-                auto pos = line.find(":");
-                if (pos != std::string::npos) inv.cpu_frequency = line.substr(pos+2) + " MHz";
-            }
-        }
-        // 5. Память (тип)
-        inv.memory_type = read_file("/sys/class/dmi/id/memory_type");
-        // 6. Диск (модель, тип, объём)
-        std::ifstream disk_model_f("/sys/class/block/sda/device/model");
-        if (disk_model_f.is_open()) std::getline(disk_model_f, inv.disk_model);
-        std::ifstream disk_type_f("/sys/class/block/sda/queue/rotational");
-        if (disk_type_f.is_open()) {
-            std::string rot; std::getline(disk_type_f, rot);
-            inv.disk_type = (rot == "0") ? "SSD" : "HDD";
+// Окно замера CPU добавляется к сроку: это ожидаемая пауза, а не задержка
+std::chrono::milliseconds LinuxMetricsCollector::family_timeout(uint32_t family) const {
+    for (size_t i = 0; i < std::size(family_timeout_ms); ++i) {
+        if (family == (1u << i)) {
+            int64_t ms = family_timeout_ms[i];
+            if (family == kFamilyCpu) ms += cpu_sample_window_ms.load();
+            return std::chrono::milliseconds(ms);
         }
-        // Общий объём диска
-        struct statvfs buf;
-        if (statvfs("/", &buf) == 0) {
-            inv.disk_total_bytes = buf.f_blocks * buf.f_frsize;
+    }
+    return std::chrono::milliseconds(0);
+}
+
+void LinuxMetricsCollector::set_inventory_cache_path(const std::string& path) {
+    std::lock_guard<std::mutex> lock(collect_mutex);
+    inventory_cache.set_path(path);
+}
+
+InventoryInfo LinuxMetricsCollector::collect_inventory_info_linux() {
+    const uint32_t stale = inventory_cache.stale_parts();
+    InventoryInfo& inv = inventory_cache.snapshot();
+    if (stale & InventoryCache::kHardware) collect_inventory_hardware(inv);
+    if (stale & InventoryCache::kAddresses) collect_inventory_addresses(inv);
+    if (stale & InventoryCache::kSoftware) collect_inventory_software(inv);
+    if (stale) inventory_cache.commit(stale);
+    return inv;
+}
+
+/// Оборудование и ОС: DMI, /etc/os-release, /proc/cpuinfo, диск, GPU
+void LinuxMetricsCollector::collect_inventory_hardware(InventoryInfo& inv) {
+    // Заполняются заново только поля оборудования и ОС: адреса и ПО обновляются отдельно
+    inv.device_type.clear();
+    inv.manufacturer.clear();
+    inv.model.clear();
+    inv.serial_number.clear();
+    inv.uuid.clear();
+    inv.os_name.clear();
+    inv.os_version.clear();
+    inv.cpu_model.clear();
+    inv.cpu_frequency.clear();
+    inv.memory_type.clear();
+    inv.disk_model.clear();
+    inv.disk_type.clear();
+    inv.disk_total_bytes = 0;
+    inv.gpu_model.clear();
+
+    // 1. Тип устройства (попробуем определить по chassis_type)
+    std::ifstream chassis_file("/sys/class/dmi/id/chassis_type");
+    if (chassis_file.is_open()) {
+        std::string chassis;
+        std::getline(chassis_file, chassis);
+        if (chassis == "3") inv.device_type = "Desktop";
+        else if (chassis == "8" || chassis == "9" || chassis == "10" || chassis == "14") inv.device_type = "Laptop";
+        else if (chassis == "23") inv.device_type = "Server";
+        else inv.device_type = chassis;
+    }
+    // 2. Производитель, модель, серийник, UUID
+    auto read_file = [](const char* path) -> std::string {
+        std::ifstream f(path);
+        if (!f.is_open()) return "";
+        std::string s; std::getline(f, s); return s;
+    };
+    inv.manufacturer = read_file("/sys/class/dmi/id/sys_vendor");
+    inv.model = read_file("/sys/class/dmi/id/product_name");
+    inv.serial_number = read_file("/sys/class/dmi/id/product_serial");
+    inv.uuid = read_file("/sys/class/dmi/id/product_uuid");
+    // 3. ОС
+    std::ifstream osf("/etc/os-release");
+    std::string line;
+    while (std::getline(osf, line)) {
+        if (line.rfind("NAME=", 0) == 0 && inv.os_name.empty()) inv.os_name = line.substr(5);
+        if (line.rfind("VERSION=", 0) == 0 && inv.os_version.empty()) inv.os_version = line.substr(8);
+    }
+    // 4. CPU
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    while (std::getline(cpuinfo, line)) {
+        if (line.find("model name") != std::string::npos && inv.cpu_model.empty()) {
+            auto pos = line.find(":");
+            if (pos != std::string::npos) inv.cpu_model = line.substr(pos+2);
         }
-        // 7. GPU (модель)
-        // Попробуем lspci | grep VGA
-        FILE* pipe = popen_hidden("lspci | grep VGA", "r");
-        if (pipe) {
-            char buffer[256];
-            if (fgets(buffer, sizeof(buffer), pipe)) {
-                std::string s(buffer);
-                auto pos = s.find(": ");
-                if (pos != std::string::npos) inv.gpu_model = s.substr(pos+2);
-                else inv.gpu_model = s;
-            }
-            pclose(pipe);
+        if (line.find("cpu MHz") != std::string::npos && inv.cpu_frequency.empty()) {
+            auto pos = line.find(":");
+            if (pos != std::string::npos) inv.cpu_frequency = line.substr(pos+2) + " MHz";
         }
-        // 8. MAC и IP-адреса
-        // ip link show для MAC
-        pipe = popen_hidden("ip link show", "r");
+    }
+    // 5. Память (тип)
+    inv.memory_type = read_file("/sys/class/dmi/id/memory_type");
+    // 6. Диск (модель, тип, объём)
+    std::ifstream disk_model_f("/sys/class/block/sda/device/model");
+    if (disk_model_f.is_open()) std::getline(disk_model_f, inv.disk_model);
+    std::ifstream disk_type_f("/sys/class/block/sda/queue/rotational");
+    if (disk_type_f.is_open()) {
+        std::string rot; std::getline(disk_type_f, rot);
+        inv.disk_type = (rot == "0") ? "SSD" : "HDD";
+    }
+    // Общий объём диска
+    struct statvfs buf;
+    if (statvfs("/", &buf) == 0) {
+        inv.disk_total_bytes = buf.f_blocks * buf.f_frsize;
+    }
+    // 7. GPU (модель): основной видеоадаптер из sysfs, иначе первый по адресу
+    const PciDevice* gpu = nullptr;
+    std::vector<PciDevice> pci_devices = enumerate_pci_devices();
+    for (const auto& device : pci_devices) {
+        if (!is_display_controller(device)) continue;
+        if (!gpu || (device.boot_vga && !gpu->boot_vga)) gpu = &device;
+    }
+    if (gpu) inv.gpu_model = pci_device_description(*gpu);
+}
+
+/// MAC и IP-адреса интерфейсов
+void LinuxMetricsCollector::collect_inventory_addresses(InventoryInfo& inv) {
+    inv.mac_addresses.clear();
+    inv.ip_addresses.clear();
+    // 8. MAC и IP-адреса: общий с автоопределением адреса агента кэш getifaddrs
+    for (const auto& iface : interface_addresses()) {
+        if (!iface.mac.empty()) inv.mac_addresses.push_back(iface.mac);
+        inv.ip_addresses.insert(inv.ip_addresses.end(), iface.ipv4.begin(), iface.ipv4.end());
+    }
+}
+
+/**
+ * @brief Список установленного ПО с версиями
+ *
+ * Читается напрямую из /var/lib/dpkg/status или базы rpm (через librpm),
+ * без дочерних процессов. rpm -qa запускается, только если librpm
+ * недоступна, а база rpm при этом есть.
+ */
+void LinuxMetricsCollector::collect_inventory_software(InventoryInfo& inv) {
+    inv.installed_software.clear();
+    inv.installed_software_versions.clear();
+    std::vector<InstalledPackage> packages;
+    bool found = read_dpkg_status("/var/lib/dpkg/status", packages) || read_rpm_database(packages);
+    if (!found && (std::filesystem::exists("/var/lib/rpm") || std::filesystem::exists("/usr/lib/sysimage/rpm"))) {
+        FILE* pipe = popen_hidden("rpm -qa --qf '%{NAME} %{VERSION}-%{RELEASE}\\n'", "r");
         if (pipe) {
             char buffer[512];
             while (fgets(buffer, sizeof(buffer), pipe)) {
-                std::string s(buffer);
-                auto pos = s.find("link/");
-                if (pos != std::string::npos) {
-                    auto mac = s.substr(pos+5);
-                    mac = mac.substr(0, mac.find(" "));
-                    if (mac != "loopback" && mac != "00:00:00:00:00:00") inv.mac_addresses.push_back(mac);
-                }
+                std::string_view line(buffer);
+                while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) line.remove_suffix(1);
+                size_t space = line.find(' ');
+                if (line.empty() || space == 0) continue;
+                InstalledPackage package;
+                package.name = std::string(line.substr(0, space));
+                if (space != std::string_view::npos) package.version = std::string(line.substr(space + 1));
+                packages.push_back(std::move(package));
             }
             pclose(pipe);
         }
-        // ip -4 -o addr show для IP
-        pipe = popen_hidden("ip -4 -o addr show", "r");
-        if (pipe) {
-            char buffer[512];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                std::string s(buffer);
-                auto pos = s.find("inet ");
-                if (pos != std::string::npos) {
-                    auto ip = s.substr(pos+5);
-                    ip = ip.substr(0, ip.find("/"));
-                    ip = ip.substr(0, ip.find(" "));
-                    inv.ip_addresses.push_back(ip);
-                }
-            }
-            pclose(pipe);
+    }
+    std::sort(packages.begin(), packages.end(), [](const InstalledPackage& a, const InstalledPackage& b) {
+        return a.name < b.name;
+    });
+    inv.installed_software.reserve(packages.size());
+    inv.installed_software_versions.reserve(packages.size());
+    for (auto& package : packages) {
+        inv.installed_software.push_back(std::move(package.name));
+        inv.installed_software_versions.push_back(std::move(package.version));
+    }
+}
+
+/**
+ * @brief Чтение снимка счетчиков CPU из /proc/stat
+ * @param out Заполняется строкой "cpu" и каждым ядром в порядке файла
+ */
+void LinuxMetricsCollector::read_cpu_times(std::vector<CpuTimes>& out) {
+    out.clear();
+    if (!proc_stat.read()) return;
+    procfs::Scanner sc(proc_stat.data());
+    do {
+        if (!sc.starts_with("cpu")) break; // строки cpu* идут в начале файла
+        std::string_view label = sc.token();
+        CpuTimes times{kAggregateCpu, 0, 0};
+        uint64_t id = 0;
+        if (label.size() > 3 && !procfs::parse_u64(label.substr(3), id)) continue;
+        if (label.size() > 3) times.id = static_cast<uint32_t>(id);
+        // user nice system idle iowait irq softirq steal
+        uint64_t fields[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+        for (uint64_t& field : fields) {
+            if (!sc.parse_u64(field)) break;
         }
-        // 9. Список установленного ПО (dpkg -l или rpm -qa)
-        // Сначала dpkg -l
-        pipe = popen_hidden("dpkg -l | awk '{print $2}'", "r");
-        if (pipe) {
-            char buffer[256];
-            int count = 0;
-            while (fgets(buffer, sizeof(buffer), pipe) && count < 1000) { // ограничим до 1000
-                std::string s(buffer);
-                if (!s.empty() && s != "\n") {
-                    s.erase(s.find_last_not_of(" \n\r\t") + 1);
-                    inv.installed_software.push_back(s);
-                    ++count;
-                }
-            }
-            pclose(pipe);
+        times.idle = fields[3] + fields[4];
+        for (uint64_t field : fields) times.total += field;
+        out.push_back(times);
+    } while (sc.next_line());
+}
+
+void LinuxMetricsCollector::set_cpu_sample_window(std::chrono::milliseconds window) {
+    if (window < std::chrono::milliseconds::zero()) window = std::chrono::milliseconds::zero();
+    if (window > std::chrono::seconds(1)) window = std::chrono::seconds(1);
+    cpu_sample_window_ms = window.count();
+}
+
+/**
+ * @brief Сбор метрик CPU
+ * @param metrics ссылка на структуру для сохранения метрик CPU
+ * 
+ * Собирает информацию о:
+ * - Загрузке CPU (из /proc/stat)
+ * - Температуре CPU (из /sys/class/thermal)
+ * - Средней загрузке (из /proc/loadavg) и ожиданию CPU (из /proc/pressure/cpu)
+ * - Процессах, больше всего потребляющих CPU, память и ввод-вывод (из /proc/[pid])
+ *
+ * Загрузка считается по разнице с предыдущим снимком /proc/stat, поэтому
+ * сбор не блокируется. Если задано окно set_cpu_sample_window(), делается
+ * отдельный короткий замер. Если с прошлого снимка счетчики не изменились
+ * (два сбора подряд), возвращаются последние посчитанные значения.
+ */
+CpuMetrics LinuxMetricsCollector::collect_cpu_metrics() {
+    CpuMetrics metrics{};
+
+    const auto window = std::chrono::milliseconds(cpu_sample_window_ms.load());
+    if (window.count() > 0 || last_cpu_times.empty()) {
+        read_cpu_times(last_cpu_times);
+        std::this_thread::sleep_for(window.count() > 0 ? window : std::chrono::milliseconds(100));
+    }
+    read_cpu_times(cur_cpu_times);
+
+    auto usage = [](const CpuTimes& prev, const CpuTimes& cur, double& out) {
+        if (cur.total <= prev.total) return;
+        uint64_t total_diff = cur.total - prev.total;
+        uint64_t idle_diff = cur.idle >= prev.idle ? cur.idle - prev.idle : 0;
+        if (idle_diff > total_diff) idle_diff = total_diff;
+        out = static_cast<double>(total_diff - idle_diff) * 100.0 / total_diff;
+    };
+
+    // Набор ядер может измениться (hotplug), поэтому сверяем номера
+    size_t cores = 0;
+    for (size_t i = 0; i < cur_cpu_times.size(); ++i) {
+        const CpuTimes& cur = cur_cpu_times[i];
+        const CpuTimes* prev = nullptr;
+        if (i < last_cpu_times.size() && last_cpu_times[i].id == cur.id) prev = &last_cpu_times[i];
+        if (cur.id == kAggregateCpu) {
+            if (prev) usage(*prev, cur, last_cpu_usage);
+            continue;
+        }
+        if (cores >= last_core_usage.size()) last_core_usage.push_back(0.0);
+        if (prev) usage(*prev, cur, last_core_usage[cores]);
+        ++cores;
+    }
+    last_core_usage.resize(cores);
+    last_cpu_times.swap(cur_cpu_times);
+
+    metrics.usage_percent = last_cpu_usage;
+    metrics.core_usage = last_core_usage;
+
+    // Температура CPU: максимум по thermal zone, по ядрам — датчики hwmon
+    sensor_registry.refresh_if_due();
+    double max_temp = 0.0;
+    for (auto& sensor : sensor_registry.sensors()) {
+        double celsius = 0.0;
+        if (!sensor_registry.read(sensor, celsius)) continue;
+        if (sensor.kind == TemperatureSensor::Kind::ThermalZone) {
+            if (celsius > max_temp) max_temp = celsius;
         } else {
-            // Если нет dpkg, пробуем rpm
-            pipe = popen_hidden("rpm -qa", "r");
-            if (pipe) {
-                char buffer[256];
-                int count = 0;
-                while (fgets(buffer, sizeof(buffer), pipe) && count < 1000) {
-                    std::string s(buffer);
-                    if (!s.empty() && s != "\n") {
-                        s.erase(s.find_last_not_of(" \n\r\t") + 1);
-                        inv.installed_software.push_back(s);
-                        ++count;
-                    }
-                }
-                pclose(pipe);
-            }
+            metrics.core_temperatures.push_back(celsius);
+            metrics.core_temperature_labels.push_back(SensorRegistry::display_name(sensor));
         }
-        return inv;
     }
+    metrics.temperature = max_temp;
 
-private:
-    /**
-     * @brief Сбор метрик CPU
-     * @param metrics ссылка на структуру для сохранения метрик CPU
-     * 
-     * Собирает информацию о:
-     * - Загрузке CPU (из /proc/stat)
-     * - Температуре CPU (из /sys/class/thermal)
-     */
-    CpuMetrics collect_cpu_metrics() {
-        // Первый замер
-        std::map<std::string, std::pair<uint64_t, uint64_t>> first_cpu_times;
-        {
-            std::ifstream file("/proc/stat");
-            std::string line;
-            while (std::getline(file, line)) {
-                if (line.rfind("cpu", 0) == 0) {
-                    std::istringstream ss(line);
-                    std::string cpu_label;
-                    ss >> cpu_label;
-                    uint64_t user, nice, system, idle, iowait, irq, softirq, steal;
-                    ss >> user >> nice >> system >> idle >> iowait >> irq >> softirq >> steal;
-                    uint64_t idle_time = idle + iowait;
-                    uint64_t total_time = user + nice + system + idle + iowait + irq + softirq + steal;
-                    first_cpu_times[cpu_label] = {total_time, idle_time};
-                }
-            }
-        }
-        std::this_thread::sleep_for(std::chrono::seconds(1));
-        // Второй замер
-        std::map<std::string, std::pair<uint64_t, uint64_t>> second_cpu_times;
-        {
-            std::ifstream file("/proc/stat");
-            std::string line;
-            while (std::getline(file, line)) {
-                if (line.rfind("cpu", 0) == 0) {
-                    std::istringstream ss(line);
-                    std::string cpu_label;
-                    ss >> cpu_label;
-                    uint64_t user, nice, system, idle, iowait, irq, softirq, steal;
-                    ss >> user >> nice >> system >> idle >> iowait >> irq >> softirq >> steal;
-                    uint64_t idle_time = idle + iowait;
-                    uint64_t total_time = user + nice + system + idle + iowait + irq + softirq + steal;
-                    second_cpu_times[cpu_label] = {total_time, idle_time};
-                }
-            }
-        }
-        CpuMetrics metrics{};
-        // Общая загрузка
-        if (first_cpu_times.count("cpu") && second_cpu_times.count("cpu")) {
-            auto& first = first_cpu_times["cpu"];
-            auto& second = second_cpu_times["cpu"];
-            uint64_t total_diff = second.first - first.first;
-            uint64_t idle_diff = second.second - first.second;
-            if (total_diff > 0) {
-                metrics.usage_percent = static_cast<double>(total_diff - idle_diff) * 100.0 / total_diff;
-            }
+    pressure_reader.read_load(metrics.load);
+    pressure_reader.read_pressure(PressureReader::Resource::kCpu, metrics.pressure);
+
+    if (const size_t top_n = process_top_n.load()) {
+        process_table.update();
+        process_table.top(top_n, metrics.processes);
+    }
+    return metrics;
+}
+
+/**
+ * @brief Сбор метрик памяти
+ * @param metrics ссылка на структуру для сохранения метрик памяти
+ * 
+ * Собирает информацию о:
+ * - Общем объеме памяти
+ * - Свободной памяти
+ * - Использованной памяти
+ * - Проценте использования
+ * 
+ * Данные берутся из /proc/meminfo; ожидание памяти — из /proc/pressure/memory,
+ * major page faults и swap — из /proc/vmstat
+ */
+MemoryMetrics LinuxMetricsCollector::collect_memory_metrics() {
+    MemoryMetrics metrics{};
+    if (!proc_meminfo.read()) return metrics;
+
+    uint64_t mem_total = 0, mem_available = 0;
+    int found = 0;
+    procfs::Scanner sc(proc_meminfo.data());
+    do {
+        if (sc.starts_with("MemTotal:")) {
+            sc.token();
+            if (sc.parse_u64(mem_total)) ++found;
+        } else if (sc.starts_with("MemAvailable:")) {
+            sc.token();
+            if (sc.parse_u64(mem_available)) ++found;
         }
-        // По ядрам
-        for (auto const& [key, first] : first_cpu_times) {
-            if (key.rfind("cpu", 0) == 0 && key != "cpu" && second_cpu_times.count(key)) {
-                auto& second = second_cpu_times[key];
-                uint64_t total_diff = second.first - first.first;
-                uint64_t idle_diff = second.second - first.second;
-                if (total_diff > 0) {
-                    metrics.core_usage.push_back(static_cast<double>(total_diff - idle_diff) * 100.0 / total_diff);
-                } else {
-                    metrics.core_usage.push_back(0.0);
-                }
+    } while (found < 2 && sc.next_line());
+
+    metrics.total_bytes = mem_total * 1024; // From kB to Bytes
+    metrics.free_bytes = mem_available * 1024; // More accurate than MemFree + Buffers + Cached
+    metrics.used_bytes = metrics.total_bytes - metrics.free_bytes;
+    if (metrics.total_bytes > 0) {
+        metrics.usage_percent = static_cast<double>(metrics.used_bytes) * 100.0 / metrics.total_bytes;
+    }
+
+    pressure_reader.read_pressure(PressureReader::Resource::kMemory, metrics.pressure);
+    pressure_reader.read_paging(metrics.paging);
+    return metrics;
+}
+
+/**
+ * @brief Сбор метрик дисков
+ * @param metrics ссылка на структуру для сохранения метрик дисков
+ * 
+ * Собирает информацию о:
+ * - Смонтированных разделах
+ * - Типах файловых систем
+ * - Общем и свободном пространстве
+ * - Проценте использования
+ * 
+ * Список разделов берется из /proc/self/mountinfo и перечитывается только
+ * после изменения таблицы монтирования. statvfs выполняется в отдельном
+ * потоке с таймаутом: зависшая точка (недоступный NFS, умирающий диск)
+ * попадает в карантин и передается с unresponsive = true. Скорости
+ * ввода-вывода берутся из /proc/diskstats по номеру устройства раздела;
+ * там же — IOPS, пропускная способность, await и загрузка каждого
+ * блочного устройства (DiskMetrics::devices). Ожидание ввода-вывода
+ * берется из /proc/pressure/io.
+ */
+void LinuxMetricsCollector::collect_disk_metrics(DiskMetrics& metrics) {
+    metrics.partitions.clear();
+    mount_table.refresh();
+    disk_stats.update();
+
+    for (const auto& mount : mount_table.entries()) {
+        DiskPartition partition{};
+        partition.mount_point = mount.mount_point;
+        partition.filesystem = mount.filesystem;
+        partition.device = mount.source;
+
+        struct statvfs buf;
+        switch (statvfs_probe.stat(mount.mount_point, buf)) {
+        case StatvfsProbe::Result::kOk:
+            partition.total_bytes = buf.f_blocks * buf.f_frsize;
+            partition.free_bytes = buf.f_bavail * buf.f_frsize;
+            partition.used_bytes = partition.total_bytes - partition.free_bytes;
+            if (partition.total_bytes > 0) {
+                partition.usage_percent = static_cast<double>(partition.used_bytes) * 100.0 / partition.total_bytes;
             }
+            break;
+        case StatvfsProbe::Result::kTimeout:
+        case StatvfsProbe::Result::kQuarantined:
+            partition.unresponsive = true;
+            partition.usage_percent = -1.0;
+            break;
+        case StatvfsProbe::Result::kError:
+            continue;
         }
-        // Температура CPU (оставляю как было)
-        try {
-            double max_temp = 0.0;
-            for (const auto& entry : std::filesystem::directory_iterator("/sys/class/thermal/")) {
-                if (entry.is_directory() && entry.path().filename().string().substr(0, 11) == "thermal_zone") {
-                    std::ifstream temp_file(entry.path() / "temp");
-                    if (temp_file.is_open()) {
-                        double temp;
-                        temp_file >> temp;
-                        temp /= 1000.0; // From millidegrees
-                        if (temp > max_temp) max_temp = temp;
-                    }
-                }
-            }
-            metrics.temperature = max_temp;
-        } catch (...) {}
-        try {
-            for (const auto& hwmon_entry : std::filesystem::directory_iterator("/sys/class/hwmon")) {
-                for (const auto& file_entry : std::filesystem::directory_iterator(hwmon_entry.path())) {
-                    std::string fname = file_entry.path().filename().string();
-                    if (fname.find("temp") == 0 && fname.find("_input") != std::string::npos) {
-                        std::ifstream temp_ifs(file_entry.path());
-                        double temp_val = 0;
-                        if(temp_ifs >> temp_val) {
-                            metrics.core_temperatures.push_back(temp_val / 1000.0);
-                        }
-                    }
-                }
-            }
-        } catch (...) {}
-        return metrics;
-    }
-
-    /**
-     * @brief Сбор метрик памяти
-     * @param metrics ссылка на структуру для сохранения метрик памяти
-     * 
-     * Собирает информацию о:
-     * - Общем объеме памяти
-     * - Свободной памяти
-     * - Использованной памяти
-     * - Проценте использования
-     * 
-     * Данные берутся из /proc/meminfo
-     */
-    MemoryMetrics collect_memory_metrics() {
-        MemoryMetrics metrics{};
-        std::ifstream file("/proc/meminfo");
-        std::string line;
-        std::map<std::string, uint64_t> mem_info;
-
-        while (std::getline(file, line)) {
-            std::istringstream ss(line);
-            std::string key;
-            uint64_t value;
-            ss >> key >> value;
-            if (!key.empty()) mem_info[key.substr(0, key.size() - 1)] = value * 1024; // From kB to Bytes
+
+        if (const auto* device = disk_stats.find(mount.major, mount.minor)) {
+            partition.read_bytes_per_sec = device->rates.read_bytes_per_sec;
+            partition.write_bytes_per_sec = device->rates.write_bytes_per_sec;
+            partition.reads_per_sec = device->rates.reads_per_sec;
+            partition.writes_per_sec = device->rates.writes_per_sec;
         }
+        metrics.partitions.push_back(std::move(partition));
+    }
+
+    pressure_reader.read_pressure(PressureReader::Resource::kIo, metrics.io_pressure);
+
+    // Устройства без единой операции с загрузки (неиспользуемые loop, ram) не передаются
+    metrics.devices.clear();
+    metrics.devices.reserve(disk_stats.devices().size());
+    for (const auto& device : disk_stats.devices()) {
+        if (device.counters.reads == 0 && device.counters.writes == 0) continue;
+        BlockDeviceIo io;
+        io.name = device.name;
+        io.parent = device.parent;
+        io.reads_per_sec = device.rates.reads_per_sec;
+        io.writes_per_sec = device.rates.writes_per_sec;
+        io.read_bytes_per_sec = device.rates.read_bytes_per_sec;
+        io.write_bytes_per_sec = device.rates.write_bytes_per_sec;
+        io.read_await_ms = device.rates.read_await_ms;
+        io.write_await_ms = device.rates.write_await_ms;
+        io.utilization_percent = device.rates.utilization_percent;
+        io.queue_depth = device.rates.queue_depth;
+        io.in_flight = device.counters.in_flight;
+        metrics.devices.push_back(std::move(io));
+    }
+}
 
-        metrics.total_bytes = mem_info["MemTotal"];
-        metrics.free_bytes = mem_info["MemAvailable"]; // More accurate than MemFree + Buffers + Cached
-        metrics.used_bytes = metrics.total_bytes - metrics.free_bytes;
-        if (metrics.total_bytes > 0) {
-            metrics.usage_percent = static_cast<double>(metrics.used_bytes) * 100.0 / metrics.total_bytes;
+/**
+ * @brief Разбор /proc/net/{tcp,udp}[6] — запасной путь, если sock_diag недоступен
+ *
+ * Формат строки: "sl local_address rem_address st ...", адреса в виде
+ * шестнадцатеричных "IP:PORT". IPv6-адрес записан как четыре 32-битных
+ * слова в порядке байт хоста.
+ */
+static void parse_proc_net(procfs::ProcFile& file, int family, int protocol, uint32_t states,
+                           SocketSink& sink) {
+    if (!file.read()) return;
+    const size_t addr_words = family == AF_INET6 ? 4 : 1;
+
+    // Слова адреса уже лежат в памяти в сетевом порядке байт — копируем как есть
+    auto parse_endpoint = [&](procfs::Scanner& sc, uint8_t* addr_out, uint16_t& port) {
+        sc.skip_spaces();
+        uint32_t words[4] = {0, 0, 0, 0};
+        std::string_view addr = sc.token_until(':');
+        if (addr.size() != addr_words * 8) return false;
+        for (size_t i = 0; i < addr_words; ++i) {
+            uint64_t word = 0;
+            if (!procfs::parse_hex(addr.substr(i * 8, 8), word)) return false;
+            words[i] = static_cast<uint32_t>(word);
         }
+        uint64_t port_value = 0;
+        if (!sc.parse_hex(port_value)) return false;
+        port = static_cast<uint16_t>(port_value);
+        std::memcpy(addr_out, words, sizeof(words));
+        return true;
+    };
+
+    SocketRecord record{};
+    record.family = static_cast<uint8_t>(family);
+    record.protocol = static_cast<uint8_t>(protocol);
+    procfs::Scanner sc(file.data());
+    while (sc.next_line()) { // первая строка — заголовок
+        uint64_t state = 0;
+        sc.token(); // sl
+        if (!parse_endpoint(sc, record.local_addr, record.local_port)) continue;
+        if (!parse_endpoint(sc, record.remote_addr, record.remote_port)) continue;
+        if (!sc.parse_hex(state)) continue;
+        if (protocol == IPPROTO_TCP && state < 32 && !(states & (1u << state))) continue;
+        record.state = static_cast<uint8_t>(state);
+        sink.on_socket(record);
+    }
+}
 
-        return metrics;
-    }
-
-    /**
-     * @brief Сбор метрик дисков
-     * @param metrics ссылка на структуру для сохранения метрик дисков
-     * 
-     * Собирает информацию о:
-     * - Смонтированных разделах
-     * - Типах файловых систем
-     * - Общем и свободном пространстве
-     * - Проценте использования
-     * 
-     * Данные берутся из /etc/mtab и statvfs
-     */
-    void collect_disk_metrics(DiskMetrics& metrics) {
-        metrics.partitions.clear();
-        std::ifstream mounts("/proc/mounts");
-        std::string line;
-        while (std::getline(mounts, line)) {
-            std::istringstream ss(line);
-            std::string device, mount_point, filesystem;
-            ss >> device >> mount_point >> filesystem;
-            
-            if (device.rfind("/dev/", 0) != 0) continue;
-
-            struct statvfs buf;
-            if (statvfs(mount_point.c_str(), &buf) == 0) {
-                DiskPartition partition;
-                partition.mount_point = mount_point;
-                partition.filesystem = filesystem;
-                partition.total_bytes = buf.f_blocks * buf.f_frsize;
-                partition.free_bytes = buf.f_bavail * buf.f_frsize;
-                partition.used_bytes = partition.total_bytes - partition.free_bytes;
-                if (partition.total_bytes > 0) {
-                    partition.usage_percent = static_cast<double>(partition.used_bytes) * 100.0 / partition.total_bytes;
-                }
-                metrics.partitions.push_back(partition);
-            }
+void LinuxMetricsCollector::set_connection_state_filter(const std::vector<std::string>& states) {
+    connection_states = tcp_state_mask(states);
+}
+
+void LinuxMetricsCollector::set_connection_top_peers(size_t top_peers) {
+    connection_top_peers = top_peers;
+}
+
+void LinuxMetricsCollector::set_process_top_n(size_t top_n) {
+    process_top_n = top_n;
+}
+
+namespace {
+
+// Раздает каждую запись нескольким получателям за один проход
+class TeeSink : public SocketSink {
+public:
+    TeeSink(SocketSink& first, SocketSink* second) : first_(first), second_(second) {}
+    void on_socket(const SocketRecord& record) override {
+        first_.on_socket(record);
+        if (second_) second_->on_socket(record);
+    }
+
+private:
+    SocketSink& first_;
+    SocketSink* second_;
+};
+
+} // namespace
+
+/**
+ * @brief Сбор TCP/UDP-сокетов (IPv4 и IPv6)
+ * @param metrics Заполняется connection_summary и, если full_list, connections
+ *
+ * Основной путь — дамп через NETLINK_SOCK_DIAG с фильтром состояний на
+ * стороне ядра. Записи сразу попадают в агрегатор, строки для полного
+ * списка формируются только по запросу. Для пары семейство/протокол,
+ * которую netlink не отдал, используется разбор файла /proc/net; если
+ * дамп оборвался после части записей, повторно их не добавляем.
+ */
+void LinuxMetricsCollector::collect_connections(NetworkMetrics& metrics, bool full_list) {
+    struct Source {
+        int family;
+        int protocol;
+        procfs::ProcFile& fallback;
+    };
+    Source sources[] = {
+        {AF_INET, IPPROTO_TCP, proc_net_tcp},
+        {AF_INET6, IPPROTO_TCP, proc_net_tcp6},
+        {AF_INET, IPPROTO_UDP, proc_net_udp},
+        {AF_INET6, IPPROTO_UDP, proc_net_udp6},
+    };
+    connection_aggregator.reset();
+    connection_aggregator.set_top_peers(connection_top_peers.load());
+    ConnectionListSink list_sink(metrics.connections);
+    TeeSink sink(connection_aggregator, full_list ? &list_sink : nullptr);
+
+    const uint32_t states = connection_states.load();
+    for (auto& source : sources) {
+        size_t delivered = 0;
+        if (!sock_diag.dump(source.family, source.protocol, states, sink, delivered) && delivered == 0) {
+            parse_proc_net(source.fallback, source.family, source.protocol, states, sink);
         }
     }
+    connection_aggregator.finish(metrics.connection_summary);
+}
 
-    /**
-     * @brief Сбор сетевых метрик
-     * @param metrics ссылка на структуру для сохранения сетевых метрик
-     * 
-     * Собирает информацию о:
-     * - Сетевых интерфейсах
-     * - Отправленных и полученных байтах
-     * - Отправленных и полученных пакетах
-     * 
-     * Данные берутся из /proc/net/dev
-     */
-    void collect_network_metrics(NetworkMetrics& metrics) {
-        metrics.interfaces.clear();
-        std::ifstream file("/proc/net/dev");
-        if (!file.is_open()) return;
-        std::string line;
-        std::getline(file, line); // Skip header
-        std::getline(file, line); // Skip header
-        while (std::getline(file, line)) {
-            std::istringstream ss(line);
-            std::string if_name;
-            ss >> if_name;
-            if (if_name.empty() || if_name == "lo:") continue;
-            if (if_name.back() == ':') if_name.pop_back();
-            uint64_t recv_bytes, recv_packets, sent_bytes, sent_packets;
-            ss >> recv_bytes >> recv_packets;
-            for(int i=0; i<6; ++i) ss.ignore(std::numeric_limits<std::streamsize>::max(), ' '); // Skip to sent bytes
-            ss >> sent_bytes >> sent_packets;
+/// Индекс интерфейса по имени; 0, если интерфейс не найден
+int LinuxMetricsCollector::interface_index(std::string_view name) {
+    if (ioctl_socket < 0 || name.size() >= IFNAMSIZ) return 0;
+    struct ifreq ifr{};
+    std::memcpy(ifr.ifr_name, name.data(), name.size());
+    if (::ioctl(ioctl_socket, SIOCGIFINDEX, &ifr) < 0) return 0;
+    return ifr.ifr_ifindex;
+}
+
+/// Скорость линка через ethtool; 0 для виртуальных интерфейсов и при ошибке
+uint32_t LinuxMetricsCollector::interface_speed_mbps(const std::string& name) {
+    if (ioctl_socket < 0 || name.size() >= IFNAMSIZ) return 0;
+    struct ethtool_cmd cmd{};
+    cmd.cmd = ETHTOOL_GSET;
+    struct ifreq ifr{};
+    std::memcpy(ifr.ifr_name, name.data(), name.size());
+    ifr.ifr_data = reinterpret_cast<char*>(&cmd);
+    if (::ioctl(ioctl_socket, SIOCETHTOOL, &ifr) < 0) return 0;
+    uint32_t speed = ethtool_cmd_speed(&cmd);
+    return speed == static_cast<uint32_t>(SPEED_UNKNOWN) ? 0 : speed;
+}
+
+/**
+ * @brief Сбор сетевых метрик
+ * @param metrics ссылка на структуру для сохранения сетевых метрик
+ * 
+ * Собирает информацию о:
+ * - Сетевых интерфейсах: счетчики, ошибки, отброшенные пакеты, MTU,
+ *   operstate, несущая и скорость линка
+ * - Скорости (байт/с и пакетов/с) с предыдущего сбора
+ * - TCP/UDP-соединениях
+ * 
+ * Счетчики берутся одним дампом RTM_GETLINK; если rtnetlink недоступен —
+ * из /proc/net/dev (без MTU, operstate и несущей).
+ */
+void LinuxMetricsCollector::collect_network_metrics(NetworkMetrics& metrics, const CollectOptions& options) {
+    metrics.interfaces.clear();
+    metrics.connections.clear();
+    interface_rates.begin_cycle(std::chrono::steady_clock::now());
+    if (rtnetlink.dump_links(link_buffer)) {
+        metrics.interfaces.reserve(link_buffer.size());
+        for (const auto& link : link_buffer) {
+            if (link.flags & IFF_LOOPBACK) continue;
             NetworkInterface netif;
-            netif.name = if_name;
-            netif.bytes_sent = sent_bytes;
-            netif.bytes_received = recv_bytes;
-            netif.packets_sent = sent_packets;
-            netif.packets_received = recv_packets;
-            netif.bandwidth_sent = 0;
-            netif.bandwidth_received = 0;
-            // Не вычисляем bandwidth по разнице, только текущее значение
-            metrics.interfaces.push_back(netif);
-        }
-        // TCP/UDP соединения оставляем как есть
-        auto parse_proc_net = [&](const char* path, const std::string& proto) {
-            std::ifstream f(path);
-            if (!f.is_open()) return;
-            std::string line;
-            std::getline(f, line); // skip header
-            while (std::getline(f, line)) {
-                std::istringstream ss(line);
-                std::string slocal, sremote, stmp;
-                int state, txq, rxq, tr, tm_when, retrnsmt, uid, timeout, inode;
-                unsigned long local_ip, remote_ip;
-                unsigned int local_port, remote_port;
-                ss >> stmp >> slocal >> sremote >> std::hex >> state;
-                size_t colon = slocal.find(":");
-                if (colon == std::string::npos) continue;
-                local_ip = std::stoul(slocal.substr(0, colon), nullptr, 16);
-                local_port = std::stoul(slocal.substr(colon + 1), nullptr, 16);
-                colon = sremote.find(":");
-                if (colon == std::string::npos) continue;
-                remote_ip = std::stoul(sremote.substr(0, colon), nullptr, 16);
-                remote_port = std::stoul(sremote.substr(colon + 1), nullptr, 16);
-                char lip[INET_ADDRSTRLEN], rip[INET_ADDRSTRLEN];
-                snprintf(lip, sizeof(lip), "%u.%u.%u.%u",
-                    (unsigned)(local_ip & 0xFF),
-                    (unsigned)((local_ip >> 8) & 0xFF),
-                    (unsigned)((local_ip >> 16) & 0xFF),
-                    (unsigned)((local_ip >> 24) & 0xFF));
-                snprintf(rip, sizeof(rip), "%u.%u.%u.%u",
-                    (unsigned)(remote_ip & 0xFF),
-                    (unsigned)((remote_ip >> 8) & 0xFF),
-                    (unsigned)((remote_ip >> 16) & 0xFF),
-                    (unsigned)((remote_ip >> 24) & 0xFF));
-                NetworkConnection conn;
-                conn.local_ip = lip;
-                conn.local_port = local_port;
-                conn.remote_ip = rip;
-                conn.remote_port = remote_port;
-                conn.protocol = proto;
-                metrics.connections.push_back(conn);
-            }
-        };
-        parse_proc_net("/proc/net/tcp", "TCP");
-        parse_proc_net("/proc/net/udp", "UDP");
-    }
-
-    /**
-     * @brief Сбор метрик GPU
-     * @param metrics ссылка на структуру для сохранения метрик GPU
-     * 
-     * Собирает информацию о:
-     * - Температуре GPU
-     * - Проценте использования GPU
-     * - Использованной памяти GPU
-     * - Общем объеме памяти GPU
-     * 
-     * Данные берутся из вывода команды nvidia-smi
-     */
-    GpuMetrics collect_gpu_metrics() {
-        GpuMetrics metrics{};
-        metrics.usage_percent = -1.0; 
-        
-        auto execute = [](const char* cmd) {
-            std::array<char, 256> buffer;
-            std::string result;
-            std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(cmd, "r"), pclose);
-            if (pipe) {
-                while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-                    result += buffer.data();
-                }
-            }
-            return result;
-        };
-        
-        // 1. NVIDIA
-        std::string nvidia_result = execute("nvidia-smi --query-gpu=temperature.gpu,utilization.gpu,memory.used,memory.total --format=csv,noheader,nounits 2>/dev/null");
-        if (!nvidia_result.empty()) {
-            std::istringstream iss(nvidia_result);
-            double temp = 0, usage = 0, mem_used = 0, mem_total = 0;
-            char comma;
-            iss >> temp >> comma >> usage >> comma >> mem_used >> comma >> mem_total;
-            metrics.temperature = temp;
-            metrics.usage_percent = usage;
-            metrics.memory_used = static_cast<uint64_t>(mem_used) * 1024 * 1024;
-            metrics.memory_total = static_cast<uint64_t>(mem_total) * 1024 * 1024;
-            return metrics;
+            netif.name = link.name;
+            netif.bytes_sent = link.tx_bytes;
+            netif.bytes_received = link.rx_bytes;
+            netif.packets_sent = link.tx_packets;
+            netif.packets_received = link.rx_packets;
+            netif.errors_sent = link.tx_errors;
+            netif.errors_received = link.rx_errors;
+            netif.dropped_sent = link.tx_dropped;
+            netif.dropped_received = link.rx_dropped;
+            netif.carrier = link.carrier;
+            netif.mtu = link.mtu;
+            netif.operstate = operstate_name(link.operstate);
+            netif.speed_mbps = link.carrier ? interface_speed_mbps(link.name) : 0;
+            InterfaceCounters counters;
+            counters.rx_bytes = link.rx_bytes;
+            counters.tx_bytes = link.tx_bytes;
+            counters.rx_packets = link.rx_packets;
+            counters.tx_packets = link.tx_packets;
+            interface_rates.update(link.ifindex, counters, netif);
+            metrics.interfaces.push_back(std::move(netif));
         }
+    } else {
+        collect_interfaces_procfs(metrics);
+    }
+    interface_rates.end_cycle();
 
-        // 2. AMD
-        std::string amd_result = execute("rocm-smi --showtemp --showuse --showmemuse --json 2>/dev/null");
-        if (!amd_result.empty()) {
-            try {
-                auto json = nlohmann::json::parse(amd_result);я
-                if (!json.empty()) {
-                    // rocm-smi returns a json object with cardX keys
-                    const auto& gpu = json.begin().value();
-                    if(gpu.contains("Temperature (Sensor 0)")) metrics.temperature = std::stod(gpu["Temperature (Sensor 0)"].get<std::string>());
-                    if(gpu.contains("GPU use (%)")) metrics.usage_percent = std::stod(gpu["GPU use (%)"].get<std::string>());
-                    if(gpu.contains("VRAM used (B)")) metrics.memory_used = gpu["VRAM used (B)"].get<uint64_t>();
-                    if(gpu.contains("VRAM total (B)")) metrics.memory_total = gpu["VRAM total (B)"].get<uint64_t>();
-                    return metrics;
-                }
-            } catch (...) {}
-        }
-        
-        return metrics;
-    }
-
-    /**
-     * @brief Сбор метрик HDD
-     * @param metrics ссылка на структуру для сохранения метрик HDD
-     * 
-     * Собирает информацию о:
-     * - Температуре HDD/SSD
-     * - Часе работы HDD/SSD
-     * - Статусе HDD/SSD
-     * 
-     * Данные берутся из вывода команды smartctl
-     */
-    void collect_hdd_metrics(HddMetrics& metrics) {
-        metrics.drives.clear();
-        std::vector<std::string> devices;
-        try {
-            for (const auto& entry : std::filesystem::directory_iterator("/dev")) {
-                std::string name = entry.path().filename().string();
-                if ((name.rfind("sd", 0) == 0 && name.length() == 3) || (name.rfind("nvme", 0) == 0 && isdigit(name.back()))) {
-                    devices.push_back(entry.path().string());
-                }
-            }
-        } catch (...) { return; }
-
-        for (const auto& dev : devices) {
-            HddDrive drive;
-            drive.name = dev;
-
-            std::string cmd = "smartctl -A -H " + dev + " 2>/dev/null";
-            std::string output;
-            std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(cmd.c_str(), "r"), pclose);
-            if (pipe) {
-                std::array<char, 256> buffer;
-                while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-                    output += buffer.data();
-                }
-            } else {
-                continue;
-            }
+    // TCP/UDP соединения
+    collect_connections(metrics, options.full_connections);
+}
 
-            std::istringstream iss(output);
-            std::string line;
-            while (std::getline(iss, line)) {
-                if (line.find("Temperature_Celsius") != std::string::npos || line.find("Temperature Sensor") != std::string::npos) {
-                    std::istringstream lss(line);
-                    std::string tmp;
-                    while (lss >> tmp);
-                    try { drive.temperature = std::stod(tmp); } catch (...) {}
-                }
-                if (line.find("Power_On_Hours") != std::string::npos) {
-                    std::istringstream lss(line);
-                    std::string tmp;
-                    while (lss >> tmp);
-                    try { drive.power_on_hours = std::stoull(tmp); } catch (...) {}
-                }
-            }
-            
-            if (output.find("PASSED") != std::string::npos || output.find("OK") != std::string::npos) {
-                drive.health_status = "OK";
-            } else if (output.find("FAILED") != std::string::npos) {
-                drive.health_status = "FAILED";
-            } else {
-                drive.health_status = "Unknown";
-            }
-            
-            metrics.drives.push_back(drive);
+/// Запасной путь: разбор /proc/net/dev
+void LinuxMetricsCollector::collect_interfaces_procfs(NetworkMetrics& metrics) {
+    if (!proc_net_dev.read()) return;
+    procfs::Scanner sc(proc_net_dev.data());
+    sc.next_line(); // Skip header
+    while (sc.next_line()) {
+        std::string_view if_name = sc.token_until(':');
+        if (if_name.empty() || if_name == "lo") continue;
+        // Receive: bytes packets errs drop fifo frame compressed multicast
+        // Transmit: bytes packets errs drop fifo colls carrier compressed
+        InterfaceCounters counters;
+        uint64_t recv_errors = 0, recv_dropped = 0, sent_errors = 0, sent_dropped = 0;
+        sc.parse_u64(counters.rx_bytes);
+        sc.parse_u64(counters.rx_packets);
+        sc.parse_u64(recv_errors);
+        sc.parse_u64(recv_dropped);
+        sc.skip_tokens(4); // Skip to sent bytes
+        sc.parse_u64(counters.tx_bytes);
+        sc.parse_u64(counters.tx_packets);
+        sc.parse_u64(sent_errors);
+        sc.parse_u64(sent_dropped);
+        NetworkInterface netif;
+        netif.name = std::string(if_name);
+        netif.bytes_sent = counters.tx_bytes;
+        netif.bytes_received = counters.rx_bytes;
+        netif.packets_sent = counters.tx_packets;
+        netif.packets_received = counters.rx_packets;
+        netif.errors_sent = sent_errors;
+        netif.errors_received = recv_errors;
+        netif.dropped_sent = sent_dropped;
+        netif.dropped_received = recv_dropped;
+        netif.bandwidth_sent = 0;
+        netif.bandwidth_received = 0;
+        int ifindex = interface_index(if_name);
+        if (ifindex > 0) {
+            interface_rates.update(ifindex, counters, netif);
         }
+        metrics.interfaces.push_back(std::move(netif));
     }
+}
 
-    // Вспомогательная функция для определения виртуалка/физика
-    std::string detect_machine_type_linux() {
-        // 1. Попробовать systemd-detect-virt
-        FILE* pipe = popen_hidden("systemd-detect-virt --quiet", "r");
-        if (pipe) {
-            int status = pclose(pipe);
-            if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
-                return "virtual";
-            }
+/**
+ * @brief Сбор метрик GPU
+ * @param metrics ссылка на структуру для сохранения метрик GPU
+ * 
+ * Собирает информацию о:
+ * - Температуре GPU
+ * - Проценте использования GPU
+ * - Использованной памяти GPU
+ * - Общем объеме памяти GPU
+ * 
+ * Адаптеры обнаруживаются один раз при создании коллектора; метрики
+ * читаются через NVML (NVIDIA) и атрибуты amdgpu в sysfs (AMD).
+ */
+GpuMetrics LinuxMetricsCollector::collect_gpu_metrics() {
+    GpuMetrics metrics{};
+    gpu_backend.collect(metrics);
+    return metrics;
+}
+
+/**
+ * @brief Сбор метрик HDD
+ * @param metrics ссылка на структуру для сохранения метрик HDD
+ * 
+ * Собирает информацию о:
+ * - Температуре HDD/SSD
+ * - Часе работы HDD/SSD
+ * - Статусе HDD/SSD
+ * 
+ * Данные читаются напрямую через SG_IO (ATA) и NVMe admin-команды и
+ * кэшируются в smart_cache: диски опрашиваются не чаще раза в TTL.
+ */
+void LinuxMetricsCollector::collect_hdd_metrics(HddMetrics& metrics) {
+    smart_cache.snapshot(metrics);
+}
+
+// Вспомогательная функция для определения виртуалка/физика
+std::string LinuxMetricsCollector::detect_machine_type_linux() {
+    // 1. Попробовать systemd-detect-virt
+    FILE* pipe = popen_hidden("systemd-detect-virt --quiet", "r");
+    if (pipe) {
+        int status = pclose(pipe);
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+            return "virtual";
         }
-        // 2. Проверить /sys/class/dmi/id/product_name
-        std::ifstream dmi_file("/sys/class/dmi/id/product_name");
-        if (dmi_file.is_open()) {
-            std::string prod_name;
-            std::getline(dmi_file, prod_name);
-            dmi_file.close();
-            if (prod_name.find("VirtualBox") != std::string::npos ||
-                prod_name.find("VMware") != std::string::npos ||
-                prod_name.find("KVM") != std::string::npos ||
-                prod_name.find("QEMU") != std::string::npos ||
-                prod_name.find("Xen") != std::string::npos) {
-                return "virtual";
-            }
+    }
+    // 2. Проверить /sys/class/dmi/id/product_name
+    std::ifstream dmi_file("/sys/class/dmi/id/product_name");
+    if (dmi_file.is_open()) {
+        std::string prod_name;
+        std::getline(dmi_file, prod_name);
+        dmi_file.close();
+        if (prod_name.find("VirtualBox") != std::string::npos ||
+            prod_name.find("VMware") != std::string::npos ||
+            prod_name.find("KVM") != std::string::npos ||
+            prod_name.find("QEMU") != std::string::npos ||
+            prod_name.find("Xen") != std::string::npos) {
+            return "virtual";
         }
-        // 3. Проверить /proc/cpuinfo
-        std::ifstream cpuinfo("/proc/cpuinfo");
-        std::string line;
-        while (std::getline(cpuinfo, line)) {
-            if (line.find("hypervisor") != std::string::npos) {
-                return "virtual";
-            }
+    }
+    // 3. Проверить /proc/cpuinfo
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.find("hypervisor") != std::string::npos) {
+            return "virtual";
         }
-        return "physical";
-    }
-
-    UserMetrics collect_user_metrics() {
-        UserMetrics metrics;
-        
-        // Получаем имя текущего пользователя
-        uid_t uid = getuid();
-        
-        // Получаем информацию о пользователе через getpwuid
-        struct passwd* pw = getpwuid(uid);
-        if (pw) {
-            metrics.username = pw->pw_name ? pw->pw_name : "";
-            metrics.full_name = pw->pw_gecos ? pw->pw_gecos : "";
+    }
+    return "physical";
+}
+
+UserMetrics LinuxMetricsCollector::collect_user_metrics() {
+    UserMetrics metrics;
+    
+    // Получаем имя текущего пользователя
+    uid_t uid = getuid();
+    
+    // Получаем информацию о пользователе через getpwuid
+    struct passwd* pw = getpwuid(uid);
+    if (pw) {
+        metrics.username = pw->pw_name ? pw->pw_name : "";
+        metrics.full_name = pw->pw_gecos ? pw->pw_gecos : "";
+        metrics.user_sid = std::to_string(uid);
+    } else {
+        // Fallback: получаем имя пользователя из переменной окружения
+        const char* env_user = getenv("USER");
+        if (env_user) {
+            metrics.username = env_user;
+            metrics.full_name = env_user;
             metrics.user_sid = std::to_string(uid);
-        } else {
-            // Fallback: получаем имя пользователя из переменной окружения
-            const char* env_user = getenv("USER");
-            if (env_user) {
-                metrics.username = env_user;
-                metrics.full_name = env_user;
-                metrics.user_sid = std::to_string(uid);
-            }
         }
-        
-        // Получаем домен (если есть)
-        const char* env_domain = getenv("DOMAIN");
-        if (env_domain) {
-            metrics.domain = env_domain;
-        } else {
-            // Попробуем получить домен из hostname
-            char hostname[256];
-            if (gethostname(hostname, sizeof(hostname)) == 0) {
-                std::string hostname_str(hostname);
-                size_t dot_pos = hostname_str.find('.');
-                if (dot_pos != std::string::npos) {
-                    metrics.domain = hostname_str.substr(dot_pos + 1);
-                }
+    }
+    
+    // Получаем домен (если есть)
+    const char* env_domain = getenv("DOMAIN");
+    if (env_domain) {
+        metrics.domain = env_domain;
+    } else {
+        // Попробуем получить домен из hostname
+        char hostname[256];
+        if (gethostname(hostname, sizeof(hostname)) == 0) {
+            std::string hostname_str(hostname);
+            size_t dot_pos = hostname_str.find('.');
+            if (dot_pos != std::string::npos) {
+                metrics.domain = hostname_str.substr(dot_pos + 1);
             }
         }
-        
-        // Пользователь считается активным, если мы можем получить его информацию
-        metrics.is_active = !metrics.username.empty();
-        
-        return metrics;
     }
-};
+    
+    // Пользователь считается активным, если мы можем получить его информацию
+    metrics.is_active = !metrics.username.empty();
+    
+    return metrics;
+}
 
 // Вспомогательная функция для безопасного запуска процесса и получения stdout
 FILE* popen_hidden(const char* command, const char* mode) {
@@ -759,18 +989,7 @@ FILE* popen_hidden(const char* command, const char* mode) {
     return f;
 }
 
-#else
-// Заглушка для не-Linux систем
-class LinuxMetricsCollector : public MetricsCollector {
-public:
-    SystemMetrics collect() override {
-        throw std::runtime_error("Linux metrics collector is not available on this platform");
-    }
 
-    CpuMetrics CollectCpuMetrics() override {
-        throw std::runtime_error("Linux metrics collector is not available on this platform");
-    }
-};
 #endif
 
 // Фабричный метод для создания коллектора метрик
@@ -45,6 +45,68 @@ void signal_handler(int signal) {
 }
 void print_metrics_to_stream(const monitoring::SystemMetrics& metrics, std::ostream& out);
 
+// Top-N процессов: {"total", "top_cpu": [...], "top_memory": [...], "top_io": [...]}
+static nlohmann::json processes_to_json(const monitoring::ProcessMetrics& p) {
+    auto list = [](const std::vector<monitoring::ProcessInfo>& processes) {
+        nlohmann::json arr = nlohmann::json::array();
+        for (const auto& proc : processes) {
+            nlohmann::json jp;
+            jp["pid"] = proc.pid;
+            jp["name"] = proc.name;
+            jp["cmdline"] = proc.cmdline;
+            jp["uid"] = proc.uid;
+            jp["state"] = std::string(1, proc.state);
+            jp["threads"] = proc.threads;
+            jp["cpu_percent"] = proc.cpu_percent;
+            jp["rss_bytes"] = proc.rss_bytes;
+            jp["read_bytes_per_sec"] = proc.read_bytes_per_sec;
+            jp["write_bytes_per_sec"] = proc.write_bytes_per_sec;
+            arr.push_back(jp);
+        }
+        return arr;
+    };
+    return nlohmann::json{{"total", p.total},
+                          {"top_cpu", list(p.top_cpu)},
+                          {"top_memory", list(p.top_memory)},
+                          {"top_io", list(p.top_io)}};
+}
+
+// PSI одного ресурса: {"available", "some": {...}, "full": {...}}
+static nlohmann::json pressure_to_json(const monitoring::PressureInfo& p) {
+    auto stall = [](const monitoring::PressureStall& s) {
+        return nlohmann::json{{"avg10", s.avg10}, {"avg60", s.avg60}, {"avg300", s.avg300}, {"total_us", s.total_us}};
+    };
+    nlohmann::json j;
+    j["available"] = p.available;
+    if (p.available) {
+        j["some"] = stall(p.some);
+        j["full"] = stall(p.full);
+    }
+    return j;
+}
+
+// Группы cgroup v2: {"available", "groups": [{"path", "cpu_percent", ...}]}
+static nlohmann::json cgroup_to_json(const monitoring::CgroupMetrics& c) {
+    nlohmann::json groups = nlohmann::json::array();
+    for (const auto& g : c.groups) {
+        groups.push_back({{"path", g.path},
+                          {"cpu_percent", g.cpu_percent},
+                          {"cpu_user_percent", g.cpu_user_percent},
+                          {"cpu_system_percent", g.cpu_system_percent},
+                          {"throttled_percent", g.throttled_percent},
+                          {"memory_current", g.memory_current},
+                          {"memory_max", g.memory_max},
+                          {"memory_anon", g.memory_anon},
+                          {"memory_file", g.memory_file},
+                          {"read_bytes_per_sec", g.read_bytes_per_sec},
+                          {"write_bytes_per_sec", g.write_bytes_per_sec},
+                          {"reads_per_sec", g.reads_per_sec},
+                          {"writes_per_sec", g.writes_per_sec},
+                          {"cpu_pressure", pressure_to_json(g.cpu_pressure)}});
+    }
+    return nlohmann::json{{"available", c.available}, {"groups", std::move(groups)}};
+}
+
 // Сериализация SystemMetrics в JSON
 json metrics_to_json(const monitoring::SystemMetrics& metrics) {
     json j;
@@ -54,12 +116,25 @@ json metrics_to_json(const monitoring::SystemMetrics& metrics) {
     j["cpu"]["usage_percent"] = metrics.cpu.usage_percent;
     j["cpu"]["temperature"] = metrics.cpu.temperature;
     j["cpu"]["core_temperatures"] = metrics.cpu.core_temperatures;
+    j["cpu"]["core_temperature_labels"] = metrics.cpu.core_temperature_labels;
     j["cpu"]["core_usage"] = metrics.cpu.core_usage;
+    j["cpu"]["load"] = {{"load1", metrics.cpu.load.load1}, {"load5", metrics.cpu.load.load5},
+                         {"load15", metrics.cpu.load.load15}, {"running", metrics.cpu.load.running},
+                         {"total", metrics.cpu.load.total}};
+    j["cpu"]["pressure"] = pressure_to_json(metrics.cpu.pressure);
+    j["cpu"]["processes"] = processes_to_json(metrics.cpu.processes);
     // Memory
     j["memory"]["total_bytes"] = metrics.memory.total_bytes;
     j["memory"]["used_bytes"] = metrics.memory.used_bytes;
     j["memory"]["free_bytes"] = metrics.memory.free_bytes;
     j["memory"]["usage_percent"] = metrics.memory.usage_percent;
+    j["memory"]["pressure"] = pressure_to_json(metrics.memory.pressure);
+    j["memory"]["paging"] = {{"major_faults", metrics.memory.paging.major_faults},
+                             {"swap_in", metrics.memory.paging.swap_in},
+                             {"swap_out", metrics.memory.paging.swap_out},
+                             {"major_faults_per_sec", metrics.memory.paging.major_faults_per_sec},
+                             {"swap_in_per_sec", metrics.memory.paging.swap_in_per_sec},
+                             {"swap_out_per_sec", metrics.memory.paging.swap_out_per_sec}};
     // Disk
     for (const auto& part : metrics.disk.partitions) {
         json jp;
@@ -69,8 +144,31 @@ json metrics_to_json(const monitoring::SystemMetrics& metrics) {
         jp["used_bytes"] = part.used_bytes;
         jp["free_bytes"] = part.free_bytes;
         jp["usage_percent"] = part.usage_percent;
+        jp["device"] = part.device;
+        jp["unresponsive"] = part.unresponsive;
+        jp["read_bytes_per_sec"] = part.read_bytes_per_sec;
+        jp["write_bytes_per_sec"] = part.write_bytes_per_sec;
+        jp["reads_per_sec"] = part.reads_per_sec;
+        jp["writes_per_sec"] = part.writes_per_sec;
         j["disk"]["partitions"].push_back(jp);
     }
+    j["disk"]["io_pressure"] = pressure_to_json(metrics.disk.io_pressure);
+    j["disk"]["devices"] = nlohmann::json::array();
+    for (const auto& dev : metrics.disk.devices) {
+        nlohmann::json jd;
+        jd["name"] = dev.name;
+        jd["parent"] = dev.parent;
+        jd["reads_per_sec"] = dev.reads_per_sec;
+        jd["writes_per_sec"] = dev.writes_per_sec;
+        jd["read_bytes_per_sec"] = dev.read_bytes_per_sec;
+        jd["write_bytes_per_sec"] = dev.write_bytes_per_sec;
+        jd["read_await_ms"] = dev.read_await_ms;
+        jd["write_await_ms"] = dev.write_await_ms;
+        jd["utilization_percent"] = dev.utilization_percent;
+        jd["queue_depth"] = dev.queue_depth;
+        jd["in_flight"] = dev.in_flight;
+        j["disk"]["devices"].push_back(jd);
+    }
     // Network
     for (const auto& iface : metrics.network.interfaces) {
         json ji;
@@ -81,9 +179,34 @@ json metrics_to_json(const monitoring::SystemMetrics& metrics) {
         ji["packets_received"] = iface.packets_received;
         ji["bandwidth_sent"] = iface.bandwidth_sent;
         ji["bandwidth_received"] = iface.bandwidth_received;
+        ji["packets_sent_rate"] = iface.packets_sent_rate;
+        ji["packets_received_rate"] = iface.packets_received_rate;
+        ji["errors_sent"] = iface.errors_sent;
+        ji["errors_received"] = iface.errors_received;
+        ji["dropped_sent"] = iface.dropped_sent;
+        ji["dropped_received"] = iface.dropped_received;
+        ji["carrier"] = iface.carrier;
+        ji["mtu"] = iface.mtu;
+        ji["operstate"] = iface.operstate;
+        ji["speed_mbps"] = iface.speed_mbps;
         j["network"]["interfaces"].push_back(ji);
     }
-    // Добавляем сериализацию connections
+    // Сводка по соединениям
+    j["network"]["connection_summary"]["total"] = metrics.network.connection_summary.total;
+    j["network"]["connection_summary"]["groups"] = json::array();
+    for (const auto& group : metrics.network.connection_summary.groups) {
+        json jg;
+        jg["protocol"] = group.protocol;
+        jg["state"] = group.state;
+        jg["local_port"] = group.local_port;
+        jg["count"] = group.count;
+        j["network"]["connection_summary"]["groups"].push_back(jg);
+    }
+    j["network"]["connection_summary"]["top_remote_peers"] = json::array();
+    for (const auto& peer : metrics.network.connection_summary.top_remote_peers) {
+        j["network"]["connection_summary"]["top_remote_peers"].push_back({{"remote_ip", peer.remote_ip}, {"count", peer.count}});
+    }
+    // Полный список соединений (заполняется только при CollectOptions::full_connections)
     for (const auto& conn : metrics.network.connections) {
         json jc;
         jc["local_ip"] = conn.local_ip;
@@ -91,6 +214,7 @@ json metrics_to_json(const monitoring::SystemMetrics& metrics) {
         jc["remote_ip"] = conn.remote_ip;
         jc["remote_port"] = conn.remote_port;
         jc["protocol"] = conn.protocol;
+        jc["state"] = conn.state;
         j["network"]["connections"].push_back(jc);
     }
     // GPU
@@ -98,6 +222,19 @@ json metrics_to_json(const monitoring::SystemMetrics& metrics) {
     j["gpu"]["usage_percent"] = metrics.gpu.usage_percent;
     j["gpu"]["memory_used"] = metrics.gpu.memory_used;
     j["gpu"]["memory_total"] = metrics.gpu.memory_total;
+    j["gpu"]["devices"] = json::array();
+    for (const auto& device : metrics.gpu.devices) {
+        json jg;
+        jg["name"] = device.name;
+        jg["vendor"] = device.vendor;
+        jg["model"] = device.model;
+        jg["pci_address"] = device.pci_address;
+        jg["temperature"] = device.temperature;
+        jg["usage_percent"] = device.usage_percent;
+        jg["memory_used"] = device.memory_used;
+        jg["memory_total"] = device.memory_total;
+        j["gpu"]["devices"].push_back(jg);
+    }
     // HDD
     for (const auto& drive : metrics.hdd.drives) {
         json jd;
@@ -126,6 +263,8 @@ json metrics_to_json(const monitoring::SystemMetrics& metrics) {
     j["inventory"]["mac_addresses"] = inv.mac_addresses;
     j["inventory"]["ip_addresses"] = inv.ip_addresses;
     j["inventory"]["installed_software"] = inv.installed_software;
+    j["inventory"]["installed_software_versions"] = inv.installed_software_versions;
+    j["cgroup"] = cgroup_to_json(metrics.cgroup);
     return j;
 }
 
@@ -24,6 +24,7 @@
 #include "agent_config.hpp"
 #include "agent_api.hpp"
 #include "../include/metrics_collector.hpp"
+#include "../include/metrics_json.hpp"
 #include <nlohmann/json.hpp>
 #include <iomanip>
 #include <sstream>
@@ -33,115 +34,21 @@ using json = nlohmann::json;
 // Глобальная переменная для контроля работы программы
 volatile bool g_running = true;
 
-// Функция для конвертации метрик в JSON с правильной кодировкой
+// Функция для конвертации метрик в JSON: семейства пишутся по тем же схемам, что и при отправке
 nlohmann::json metrics_to_json(const monitoring::SystemMetrics& metrics) {
-    nlohmann::json j;
-    
-    // Используем безопасные методы для работы с числами
-    j["timestamp"] = std::chrono::duration_cast<std::chrono::seconds>(
-        metrics.timestamp.time_since_epoch()).count();
-    j["machine_type"] = metrics.machine_type;
-    
-    // CPU метрики
-    if (metrics.cpu.usage_percent >= 0) {
-        j["cpu"]["usage_percent"] = static_cast<double>(metrics.cpu.usage_percent);
-    }
-    if (metrics.cpu.temperature >= 0) {
-        j["cpu"]["temperature"] = static_cast<double>(metrics.cpu.temperature);
-    }
-    
-    // Memory метрики
-    if (metrics.memory.total_bytes > 0) {
-        j["memory"]["total_bytes"] = static_cast<int64_t>(metrics.memory.total_bytes);
-        j["memory"]["used_bytes"] = static_cast<int64_t>(metrics.memory.used_bytes);
-        j["memory"]["free_bytes"] = static_cast<int64_t>(metrics.memory.free_bytes);
-    }
-    if (metrics.memory.usage_percent >= 0) {
-        j["memory"]["usage_percent"] = static_cast<double>(metrics.memory.usage_percent);
-    }
-    
-    // Disk метрики
-    j["disk"]["partitions"] = nlohmann::json::array();
-    for (const auto& part : metrics.disk.partitions) {
-        nlohmann::json jp;
-        jp["mount_point"] = part.mount_point;
-        jp["filesystem"] = part.filesystem;
-        jp["total_bytes"] = static_cast<int64_t>(part.total_bytes);
-        jp["used_bytes"] = static_cast<int64_t>(part.used_bytes);
-        jp["free_bytes"] = static_cast<int64_t>(part.free_bytes);
-        if (part.usage_percent >= 0) {
-            jp["usage_percent"] = static_cast<double>(part.usage_percent);
-        }
-        j["disk"]["partitions"].push_back(jp);
-    }
-    
-    // Network метрики
-    j["network"]["interfaces"] = nlohmann::json::array();
-    for (const auto& iface : metrics.network.interfaces) {
-        nlohmann::json ji;
-        ji["name"] = iface.name;
-        ji["bytes_sent"] = static_cast<int64_t>(iface.bytes_sent);
-        ji["bytes_received"] = static_cast<int64_t>(iface.bytes_received);
-        ji["packets_sent"] = static_cast<int64_t>(iface.packets_sent);
-        ji["packets_received"] = static_cast<int64_t>(iface.packets_received);
-        if (iface.bandwidth_sent >= 0) {
-            ji["bandwidth_sent"] = static_cast<double>(iface.bandwidth_sent);
-        }
-        if (iface.bandwidth_received >= 0) {
-            ji["bandwidth_received"] = static_cast<double>(iface.bandwidth_received);
-        }
-        j["network"]["interfaces"].push_back(ji);
+    std::string body;
+    monitoring::JsonWriter writer(body);
+    writer.begin_object();
+    writer.key("timestamp");
+    writer.value(std::chrono::duration_cast<std::chrono::seconds>(metrics.timestamp.time_since_epoch()).count());
+    writer.key("machine_type");
+    writer.value(metrics.machine_type);
+    for (const char* family : {"cpu", "memory", "disk", "network", "gpu", "hdd", "user", "inventory", "cgroup"}) {
+        writer.key(family);
+        monitoring::write_metric_family(writer, metrics, family, false);
     }
-    
-    // GPU метрики
-    if (metrics.gpu.temperature >= 0) {
-        j["gpu"]["temperature"] = static_cast<double>(metrics.gpu.temperature);
-    }
-    if (metrics.gpu.usage_percent >= 0) {
-        j["gpu"]["usage_percent"] = static_cast<double>(metrics.gpu.usage_percent);
-    }
-    if (metrics.gpu.memory_used > 0) {
-        j["gpu"]["memory_used"] = static_cast<int64_t>(metrics.gpu.memory_used);
-    }
-    if (metrics.gpu.memory_total > 0) {
-        j["gpu"]["memory_total"] = static_cast<int64_t>(metrics.gpu.memory_total);
-    }
-    
-    // Inventory метрики
-    j["inventory"]["device_type"] = metrics.inventory.device_type;
-    j["inventory"]["manufacturer"] = metrics.inventory.manufacturer;
-    j["inventory"]["model"] = metrics.inventory.model;
-    j["inventory"]["serial_number"] = metrics.inventory.serial_number;
-    j["inventory"]["uuid"] = metrics.inventory.uuid;
-    j["inventory"]["os_name"] = metrics.inventory.os_name;
-    j["inventory"]["os_version"] = metrics.inventory.os_version;
-    j["inventory"]["cpu_model"] = metrics.inventory.cpu_model;
-    // cpu_frequency - это строка, не приводим к double
-    j["inventory"]["cpu_frequency"] = metrics.inventory.cpu_frequency;
-    j["inventory"]["memory_type"] = metrics.inventory.memory_type;
-    j["inventory"]["disk_model"] = metrics.inventory.disk_model;
-    j["inventory"]["disk_type"] = metrics.inventory.disk_type;
-    // disk_total_bytes - это uint64_t, можно безопасно приводить
-    j["inventory"]["disk_total_bytes"] = static_cast<int64_t>(metrics.inventory.disk_total_bytes);
-    j["inventory"]["gpu_model"] = metrics.inventory.gpu_model;
-    
-    // Массивы
-    j["inventory"]["mac_addresses"] = nlohmann::json::array();
-    for (const auto& mac : metrics.inventory.mac_addresses) {
-        j["inventory"]["mac_addresses"].push_back(mac);
-    }
-    
-    j["inventory"]["ip_addresses"] = nlohmann::json::array();
-    for (const auto& ip : metrics.inventory.ip_addresses) {
-        j["inventory"]["ip_addresses"].push_back(ip);
-    }
-    
-    j["inventory"]["installed_software"] = nlohmann::json::array();
-    for (const auto& software : metrics.inventory.installed_software) {
-        j["inventory"]["installed_software"].push_back(software);
-    }
-    
-    return j;
+    writer.end_object();
+    return nlohmann::json::parse(body);
 }
 
 // Обработчик сигналов для корректного завершения
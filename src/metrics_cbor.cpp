@@ -0,0 +1,211 @@
+/**
+ * @file metrics_cbor.cpp
+ * @brief Реализация CborWriter
+ */
+
+#include "../include/metrics_cbor.hpp"
+
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace monitoring {
+
+namespace {
+
+constexpr uint8_t kMajorUnsigned = 0;
+constexpr uint8_t kMajorBytes = 2;
+constexpr uint8_t kMajorText = 3;
+constexpr uint8_t kMajorTag = 6;
+
+constexpr uint64_t kTagStringRef = 25;
+constexpr uint64_t kTagStringRefNamespace = 256;
+constexpr uint64_t kTagFloat64LittleEndian = 86;
+
+// Минимальная длина строки, которая попадает в таблицу stringref при ее размере count
+size_t stringref_min_length(uint64_t count) {
+    if (count < 24) return 3;
+    if (count < 256) return 4;
+    if (count < 65536) return 5;
+    if (count < 4294967296ull) return 7;
+    return 11;
+}
+
+// Значение float, представимое в half без потерь (нормальные числа и ноль)
+bool to_half(float f, uint16_t& half) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    const int exponent = static_cast<int>((bits >> 23) & 0xFF) - 127;
+    const uint32_t mantissa = bits & 0x7FFFFF;
+    if ((bits & 0x7FFFFFFF) == 0) {
+        half = sign;
+        return true;
+    }
+    if (exponent < -14 || exponent > 15 || (mantissa & 0x1FFF) != 0) return false;
+    half = static_cast<uint16_t>(sign | ((exponent + 15) << 10) | (mantissa >> 13));
+    return true;
+}
+
+void append_big_endian(std::string& out, uint64_t v, int bytes) {
+    for (int i = bytes - 1; i >= 0; --i) out += static_cast<char>((v >> (8 * i)) & 0xFF);
+}
+
+} // namespace
+
+void CborWriter::head(uint8_t major, uint64_t argument) {
+    const auto type = static_cast<uint8_t>(major << 5);
+    if (argument < 24) {
+        out_ += static_cast<char>(type | argument);
+    } else if (argument <= 0xFF) {
+        out_ += static_cast<char>(type | 24);
+        append_big_endian(out_, argument, 1);
+    } else if (argument <= 0xFFFF) {
+        out_ += static_cast<char>(type | 25);
+        append_big_endian(out_, argument, 2);
+    } else if (argument <= 0xFFFFFFFF) {
+        out_ += static_cast<char>(type | 26);
+        append_big_endian(out_, argument, 4);
+    } else {
+        out_ += static_cast<char>(type | 27);
+        append_big_endian(out_, argument, 8);
+    }
+}
+
+void CborWriter::begin_string_namespace() {
+    head(kMajorTag, kTagStringRefNamespace);
+    namespace_depth_ = depth_;
+    strings_.clear();
+    string_count_ = 0;
+}
+
+void CborWriter::begin_object() {
+    out_ += '\xBF';  // map неопределенной длины
+    ++depth_;
+}
+
+void CborWriter::end_object() {
+    end_container();
+}
+
+void CborWriter::begin_array() {
+    out_ += '\x9F';  // array неопределенной длины
+    ++depth_;
+}
+
+void CborWriter::end_array() {
+    end_container();
+}
+
+void CborWriter::end_container() {
+    out_ += '\xFF';  // break
+    if (--depth_ == namespace_depth_) {
+        namespace_depth_ = -1;
+        strings_.clear();
+    }
+}
+
+bool CborWriter::add_string(size_t length) {
+    if (namespace_depth_ < 0 || length < stringref_min_length(string_count_)) return false;
+    ++string_count_;
+    return true;
+}
+
+void CborWriter::text(std::string_view v) {
+    const auto* s = reinterpret_cast<const unsigned char*>(v.data());
+    const size_t n = v.size();
+    size_t i = 0;
+    while (i < n) {
+        if (s[i] < 0x80) {
+            ++i;
+            continue;
+        }
+        const size_t length = utf8_sequence_length(s + i, n - i);
+        if (length == 0) break;
+        i += length;
+    }
+
+    if (i < n) {
+        // Исправленная копия не живет до конца пространства строк и не запоминается
+        std::string fixed(v.substr(0, i));
+        while (i < n) {
+            const size_t length = s[i] < 0x80 ? 1 : utf8_sequence_length(s + i, n - i);
+            if (length == 0) {
+                fixed += "\xEF\xBF\xBD";
+                ++i;
+            } else {
+                fixed.append(v.data() + i, length);
+                i += length;
+            }
+        }
+        head(kMajorText, fixed.size());
+        out_ += fixed;
+        add_string(fixed.size());
+        return;
+    }
+
+    if (namespace_depth_ >= 0) {
+        auto it = strings_.find(v);
+        if (it != strings_.end()) {
+            head(kMajorTag, kTagStringRef);
+            head(kMajorUnsigned, it->second);
+            return;
+        }
+    }
+    head(kMajorText, n);
+    out_ += v;
+    if (add_string(n)) strings_.emplace(v, string_count_ - 1);
+}
+
+void CborWriter::value(bool v) {
+    out_ += v ? '\xF5' : '\xF4';
+}
+
+void CborWriter::value(double v) {
+    if (!std::isfinite(v)) {
+        null();
+        return;
+    }
+    if (std::fabs(v) <= FLT_MAX) {
+        const auto f = static_cast<float>(v);
+        if (static_cast<double>(f) == v) {
+            uint16_t half;
+            if (to_half(f, half)) {
+                out_ += '\xF9';
+                append_big_endian(out_, half, 2);
+            } else {
+                uint32_t bits;
+                std::memcpy(&bits, &f, sizeof(bits));
+                out_ += '\xFA';
+                append_big_endian(out_, bits, 4);
+            }
+            return;
+        }
+    }
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    out_ += '\xFB';
+    append_big_endian(out_, bits, 8);
+}
+
+void CborWriter::null() {
+    out_ += '\xF6';
+}
+
+void CborWriter::number_array(const std::vector<double>& values) {
+    head(kMajorTag, kTagFloat64LittleEndian);
+    head(kMajorBytes, values.size() * sizeof(double));
+    for (double v : values) {
+        uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        for (int i = 0; i < 8; ++i) out_ += static_cast<char>((bits >> (8 * i)) & 0xFF);
+    }
+    // Байтовая строка тоже занимает место в таблице stringref
+    add_string(values.size() * sizeof(double));
+}
+
+void CborWriter::raw(std::string_view cbor) {
+    out_ += cbor;
+}
+
+} // namespace monitoring
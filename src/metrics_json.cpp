@@ -0,0 +1,622 @@
+/**
+ * @file metrics_json.cpp
+ * @brief Схемы полей метрик и потоковая запись JSON
+ *
+ * Схемы не зависят от формата: те же функции записи инстанцируются для
+ * JsonWriter и CborWriter.
+ */
+
+#include "../include/metrics_json.hpp"
+#include "../include/metrics_cbor.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <tuple>
+#include <vector>
+
+namespace monitoring {
+
+// ---------------------------------------------------------------------------
+// JsonWriter
+// ---------------------------------------------------------------------------
+
+size_t utf8_sequence_length(const unsigned char* p, size_t available) {
+    const unsigned char c = p[0];
+    size_t length;
+    unsigned char low = 0x80, high = 0xBF;  // допустимый диапазон второго байта
+    if (c >= 0xC2 && c <= 0xDF) {
+        length = 2;
+    } else if (c >= 0xE0 && c <= 0xEF) {
+        length = 3;
+        if (c == 0xE0) low = 0xA0;          // overlong
+        else if (c == 0xED) high = 0x9F;    // суррогаты
+    } else if (c >= 0xF0 && c <= 0xF4) {
+        length = 4;
+        if (c == 0xF0) low = 0x90;          // overlong
+        else if (c == 0xF4) high = 0x8F;    // больше U+10FFFF
+    } else {
+        return 0;
+    }
+    if (available < length || p[1] < low || p[1] > high) return 0;
+    for (size_t i = 2; i < length; ++i) {
+        if (p[i] < 0x80 || p[i] > 0xBF) return 0;
+    }
+    return length;
+}
+
+void JsonWriter::separate() {
+    if (need_comma_) out_ += ',';
+    need_comma_ = true;
+}
+
+void JsonWriter::begin_object() {
+    separate();
+    out_ += '{';
+    need_comma_ = false;
+}
+
+void JsonWriter::end_object() {
+    out_ += '}';
+    need_comma_ = true;
+}
+
+void JsonWriter::begin_array() {
+    separate();
+    out_ += '[';
+    need_comma_ = false;
+}
+
+void JsonWriter::end_array() {
+    out_ += ']';
+    need_comma_ = true;
+}
+
+void JsonWriter::key(std::string_view name) {
+    separate();
+    out_ += '"';
+    out_ += name;
+    out_ += "\":";
+    need_comma_ = false;  // значение ключа идет без запятой
+}
+
+void JsonWriter::value(bool v) {
+    separate();
+    out_ += v ? "true" : "false";
+}
+
+void JsonWriter::value(double v) {
+    if (!std::isfinite(v)) {
+        null();
+        return;
+    }
+    separate();
+    char buffer[32];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), v);
+    const std::string_view text(buffer, static_cast<size_t>(result.ptr - buffer));
+    out_ += text;
+    // Целое значение double nlohmann::json пишет как "5.0": на сервере оно остается float
+    if (text.find_first_of(".e") == std::string_view::npos) out_ += ".0";
+}
+
+void JsonWriter::write_signed(int64_t v) {
+    separate();
+    char buffer[24];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), v);
+    out_.append(buffer, result.ptr);
+}
+
+void JsonWriter::write_unsigned(uint64_t v) {
+    separate();
+    char buffer[24];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), v);
+    out_.append(buffer, result.ptr);
+}
+
+void JsonWriter::value(std::string_view v) {
+    separate();
+    out_ += '"';
+    const auto* s = reinterpret_cast<const unsigned char*>(v.data());
+    const size_t n = v.size();
+    size_t run = 0;  // начало участка, который копируется без изменений
+    size_t i = 0;
+    while (i < n) {
+        const unsigned char c = s[i];
+        if (c >= 0x20 && c < 0x80 && c != '"' && c != '\\') {
+            ++i;
+            continue;
+        }
+        if (c >= 0x80) {
+            const size_t length = utf8_sequence_length(s + i, n - i);
+            if (length != 0) {
+                i += length;
+                continue;
+            }
+        }
+        out_.append(v.data() + run, i - run);
+        switch (c) {
+        case '"': out_ += "\\\""; break;
+        case '\\': out_ += "\\\\"; break;
+        case '\n': out_ += "\\n"; break;
+        case '\r': out_ += "\\r"; break;
+        case '\t': out_ += "\\t"; break;
+        case '\b': out_ += "\\b"; break;
+        case '\f': out_ += "\\f"; break;
+        default:
+            if (c < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out_ += escaped;
+            } else {
+                out_ += "\xEF\xBF\xBD";  // U+FFFD вместо байта, не образующего символ
+            }
+        }
+        run = ++i;
+    }
+    out_.append(v.data() + run, n - run);
+    out_ += '"';
+}
+
+void JsonWriter::null() {
+    separate();
+    out_ += "null";
+}
+
+void JsonWriter::number_array(const std::vector<double>& values) {
+    begin_array();
+    for (double v : values) value(v);
+    end_array();
+}
+
+void JsonWriter::raw(std::string_view json) {
+    separate();
+    out_ += json;
+}
+
+// ---------------------------------------------------------------------------
+// Схемы полей
+// ---------------------------------------------------------------------------
+
+namespace {
+
+template <typename W>
+void write_value(W& w, const PressureInfo& p);
+template <typename W, typename T>
+void write_value(W& w, const T& v);
+
+/// Запись члена по его типу (write_value)
+struct WriteByType {
+    template <typename W, typename M>
+    void operator()(W& w, const M& v) const { write_value(w, v); }
+};
+
+/// Поле схемы: ключ, член структуры и, при необходимости, своя запись и условие
+template <typename T, typename M, typename Write>
+struct Field {
+    const char* name;
+    M T::*member;
+    Write write;                 ///< Функциональный объект (writer, значение); шаблонный по формату
+    bool (*present)(const M&);   ///< nullptr — поле пишется всегда
+};
+
+template <typename T, typename M, typename Write = WriteByType>
+constexpr Field<T, M, Write> field(const char* name, M T::*member, Write write = {}) {
+    return {name, member, write, nullptr};
+}
+
+/// Поле, которое пишется, только если present(значение) вернула true
+template <typename T, typename M>
+constexpr Field<T, M, WriteByType> optional_field(const char* name, M T::*member, bool (*present)(const M&)) {
+    return {name, member, {}, present};
+}
+
+/// Специализация на каждую структуру: static constexpr auto fields = std::make_tuple(field(...), ...)
+template <typename T>
+struct Schema;
+
+template <typename T>
+struct is_vector : std::false_type {};
+template <typename T>
+struct is_vector<std::vector<T>> : std::true_type {};
+
+template <typename W, typename T, typename M, typename Write>
+void write_field(W& w, const T& object, const Field<T, M, Write>& f) {
+    const M& v = object.*(f.member);
+    if (f.present && !f.present(v)) return;
+    w.key(f.name);
+    f.write(w, v);
+}
+
+/// Поля объекта без фигурных скобок
+template <typename W, typename T>
+void write_fields(W& w, const T& object) {
+    std::apply([&](const auto&... f) { (write_field(w, object, f), ...); }, Schema<T>::fields);
+}
+
+template <typename W, typename T>
+void write_value(W& w, const T& v) {
+    if constexpr (std::is_arithmetic_v<T> || std::is_same_v<T, std::string>) {
+        w.value(v);
+    } else if constexpr (std::is_same_v<T, std::vector<double>>) {
+        w.number_array(v);  // в CBOR — упакованный типизированный массив
+    } else if constexpr (is_vector<T>::value) {
+        w.begin_array();
+        for (const auto& item : v) write_value(w, item);
+        w.end_array();
+    } else {
+        w.begin_object();
+        write_fields(w, v);
+        w.end_object();
+    }
+}
+
+// Нестандартные записи и условия
+
+struct WriteChar {
+    template <typename W>
+    void operator()(W& w, const char& c) const { w.value(std::string_view(&c, 1)); }
+};
+constexpr WriteChar write_char{};
+
+// Счетчики скорости интерфейса всегда передавались как числа с плавающей точкой
+struct WriteAsDouble {
+    template <typename W>
+    void operator()(W& w, const uint64_t& v) const { w.value(static_cast<double>(v)); }
+};
+constexpr WriteAsDouble write_as_double{};
+
+// usage_percent = -1 у раздела, не ответившего statvfs
+bool non_negative(const double& v) {
+    return v >= 0;
+}
+
+bool non_empty(const std::string& v) {
+    return !v.empty();
+}
+
+template <>
+struct Schema<PressureStall> {
+    static constexpr auto fields = std::make_tuple(
+        field("avg10", &PressureStall::avg10),
+        field("avg60", &PressureStall::avg60),
+        field("avg300", &PressureStall::avg300),
+        field("total_us", &PressureStall::total_us));
+};
+
+// {"available"} или {"available", "some", "full"}
+template <typename W>
+void write_value(W& w, const PressureInfo& p) {
+    w.begin_object();
+    w.key("available");
+    w.value(p.available);
+    if (p.available) {
+        w.key("some");
+        write_value(w, p.some);
+        w.key("full");
+        write_value(w, p.full);
+    }
+    w.end_object();
+}
+
+template <>
+struct Schema<LoadAverage> {
+    static constexpr auto fields = std::make_tuple(
+        field("load1", &LoadAverage::load1),
+        field("load5", &LoadAverage::load5),
+        field("load15", &LoadAverage::load15),
+        field("running", &LoadAverage::running),
+        field("total", &LoadAverage::total));
+};
+
+template <>
+struct Schema<ProcessInfo> {
+    static constexpr auto fields = std::make_tuple(
+        field("pid", &ProcessInfo::pid),
+        field("name", &ProcessInfo::name),
+        field("cmdline", &ProcessInfo::cmdline),
+        field("uid", &ProcessInfo::uid),
+        field("state", &ProcessInfo::state, write_char),
+        field("threads", &ProcessInfo::threads),
+        field("cpu_percent", &ProcessInfo::cpu_percent),
+        field("rss_bytes", &ProcessInfo::rss_bytes),
+        field("read_bytes_per_sec", &ProcessInfo::read_bytes_per_sec),
+        field("write_bytes_per_sec", &ProcessInfo::write_bytes_per_sec));
+};
+
+template <>
+struct Schema<ProcessMetrics> {
+    static constexpr auto fields = std::make_tuple(
+        field("total", &ProcessMetrics::total),
+        field("top_cpu", &ProcessMetrics::top_cpu),
+        field("top_memory", &ProcessMetrics::top_memory),
+        field("top_io", &ProcessMetrics::top_io));
+};
+
+template <>
+struct Schema<CpuMetrics> {
+    static constexpr auto fields = std::make_tuple(
+        field("usage_percent", &CpuMetrics::usage_percent),
+        field("temperature", &CpuMetrics::temperature),
+        field("core_temperatures", &CpuMetrics::core_temperatures),
+        field("core_temperature_labels", &CpuMetrics::core_temperature_labels),
+        field("core_usage", &CpuMetrics::core_usage),
+        field("load", &CpuMetrics::load),
+        field("pressure", &CpuMetrics::pressure),
+        field("processes", &CpuMetrics::processes));
+};
+
+template <>
+struct Schema<PagingActivity> {
+    static constexpr auto fields = std::make_tuple(
+        field("major_faults", &PagingActivity::major_faults),
+        field("swap_in", &PagingActivity::swap_in),
+        field("swap_out", &PagingActivity::swap_out),
+        field("major_faults_per_sec", &PagingActivity::major_faults_per_sec),
+        field("swap_in_per_sec", &PagingActivity::swap_in_per_sec),
+        field("swap_out_per_sec", &PagingActivity::swap_out_per_sec));
+};
+
+template <>
+struct Schema<MemoryMetrics> {
+    static constexpr auto fields = std::make_tuple(
+        field("total_bytes", &MemoryMetrics::total_bytes),
+        field("used_bytes", &MemoryMetrics::used_bytes),
+        field("free_bytes", &MemoryMetrics::free_bytes),
+        field("usage_percent", &MemoryMetrics::usage_percent),
+        field("pressure", &MemoryMetrics::pressure),
+        field("paging", &MemoryMetrics::paging));
+};
+
+template <>
+struct Schema<DiskPartition> {
+    static constexpr auto fields = std::make_tuple(
+        field("mount_point", &DiskPartition::mount_point),
+        field("filesystem", &DiskPartition::filesystem),
+        field("total_bytes", &DiskPartition::total_bytes),
+        field("used_bytes", &DiskPartition::used_bytes),
+        field("free_bytes", &DiskPartition::free_bytes),
+        optional_field("usage_percent", &DiskPartition::usage_percent, non_negative),
+        field("device", &DiskPartition::device),
+        field("unresponsive", &DiskPartition::unresponsive),
+        field("read_bytes_per_sec", &DiskPartition::read_bytes_per_sec),
+        field("write_bytes_per_sec", &DiskPartition::write_bytes_per_sec),
+        field("reads_per_sec", &DiskPartition::reads_per_sec),
+        field("writes_per_sec", &DiskPartition::writes_per_sec));
+};
+
+template <>
+struct Schema<BlockDeviceIo> {
+    static constexpr auto fields = std::make_tuple(
+        field("name", &BlockDeviceIo::name),
+        field("parent", &BlockDeviceIo::parent),
+        field("reads_per_sec", &BlockDeviceIo::reads_per_sec),
+        field("writes_per_sec", &BlockDeviceIo::writes_per_sec),
+        field("read_bytes_per_sec", &BlockDeviceIo::read_bytes_per_sec),
+        field("write_bytes_per_sec", &BlockDeviceIo::write_bytes_per_sec),
+        field("read_await_ms", &BlockDeviceIo::read_await_ms),
+        field("write_await_ms", &BlockDeviceIo::write_await_ms),
+        field("utilization_percent", &BlockDeviceIo::utilization_percent),
+        field("queue_depth", &BlockDeviceIo::queue_depth),
+        field("in_flight", &BlockDeviceIo::in_flight));
+};
+
+template <>
+struct Schema<DiskMetrics> {
+    static constexpr auto fields = std::make_tuple(
+        field("partitions", &DiskMetrics::partitions),
+        field("io_pressure", &DiskMetrics::io_pressure),
+        field("devices", &DiskMetrics::devices));
+};
+
+template <>
+struct Schema<NetworkInterface> {
+    static constexpr auto fields = std::make_tuple(
+        field("name", &NetworkInterface::name),
+        field("bytes_sent", &NetworkInterface::bytes_sent),
+        field("bytes_received", &NetworkInterface::bytes_received),
+        field("packets_sent", &NetworkInterface::packets_sent),
+        field("packets_received", &NetworkInterface::packets_received),
+        field("bandwidth_sent", &NetworkInterface::bandwidth_sent, write_as_double),
+        field("bandwidth_received", &NetworkInterface::bandwidth_received, write_as_double),
+        field("packets_sent_rate", &NetworkInterface::packets_sent_rate),
+        field("packets_received_rate", &NetworkInterface::packets_received_rate),
+        field("errors_sent", &NetworkInterface::errors_sent),
+        field("errors_received", &NetworkInterface::errors_received),
+        field("dropped_sent", &NetworkInterface::dropped_sent),
+        field("dropped_received", &NetworkInterface::dropped_received),
+        field("carrier", &NetworkInterface::carrier),
+        field("mtu", &NetworkInterface::mtu),
+        field("operstate", &NetworkInterface::operstate),
+        field("speed_mbps", &NetworkInterface::speed_mbps));
+};
+
+template <>
+struct Schema<ConnectionGroup> {
+    static constexpr auto fields = std::make_tuple(
+        field("protocol", &ConnectionGroup::protocol),
+        field("state", &ConnectionGroup::state),
+        field("local_port", &ConnectionGroup::local_port),
+        field("count", &ConnectionGroup::count));
+};
+
+template <>
+struct Schema<RemotePeer> {
+    static constexpr auto fields = std::make_tuple(
+        field("remote_ip", &RemotePeer::remote_ip),
+        field("count", &RemotePeer::count));
+};
+
+template <>
+struct Schema<ConnectionSummary> {
+    static constexpr auto fields = std::make_tuple(
+        field("total", &ConnectionSummary::total),
+        field("groups", &ConnectionSummary::groups),
+        field("top_remote_peers", &ConnectionSummary::top_remote_peers));
+};
+
+template <>
+struct Schema<NetworkConnection> {
+    static constexpr auto fields = std::make_tuple(
+        field("local_ip", &NetworkConnection::local_ip),
+        field("local_port", &NetworkConnection::local_port),
+        field("remote_ip", &NetworkConnection::remote_ip),
+        field("remote_port", &NetworkConnection::remote_port),
+        field("protocol", &NetworkConnection::protocol),
+        field("state", &NetworkConnection::state));
+};
+
+template <>
+struct Schema<GpuDevice> {
+    static constexpr auto fields = std::make_tuple(
+        field("name", &GpuDevice::name),
+        field("vendor", &GpuDevice::vendor),
+        field("model", &GpuDevice::model),
+        field("pci_address", &GpuDevice::pci_address),
+        field("temperature", &GpuDevice::temperature),
+        field("usage_percent", &GpuDevice::usage_percent),
+        field("memory_used", &GpuDevice::memory_used),
+        field("memory_total", &GpuDevice::memory_total));
+};
+
+template <>
+struct Schema<GpuMetrics> {
+    static constexpr auto fields = std::make_tuple(
+        field("temperature", &GpuMetrics::temperature),
+        field("usage_percent", &GpuMetrics::usage_percent),
+        field("memory_used", &GpuMetrics::memory_used),
+        field("memory_total", &GpuMetrics::memory_total),
+        field("devices", &GpuMetrics::devices));
+};
+
+template <>
+struct Schema<HddDrive> {
+    static constexpr auto fields = std::make_tuple(
+        field("name", &HddDrive::name),
+        field("temperature", &HddDrive::temperature),
+        field("power_on_hours", &HddDrive::power_on_hours),
+        field("health_status", &HddDrive::health_status));
+};
+
+template <>
+struct Schema<HddMetrics> {
+    static constexpr auto fields = std::make_tuple(
+        field("drives", &HddMetrics::drives));
+};
+
+template <>
+struct Schema<UserMetrics> {
+    static constexpr auto fields = std::make_tuple(
+        field("username", &UserMetrics::username),
+        field("domain", &UserMetrics::domain),
+        field("full_name", &UserMetrics::full_name),
+        field("user_sid", &UserMetrics::user_sid),
+        field("is_active", &UserMetrics::is_active));
+};
+
+template <>
+struct Schema<InventoryInfo> {
+    static constexpr auto fields = std::make_tuple(
+        field("device_type", &InventoryInfo::device_type),
+        field("manufacturer", &InventoryInfo::manufacturer),
+        field("model", &InventoryInfo::model),
+        field("serial_number", &InventoryInfo::serial_number),
+        field("uuid", &InventoryInfo::uuid),
+        field("os_name", &InventoryInfo::os_name),
+        field("os_version", &InventoryInfo::os_version),
+        field("cpu_model", &InventoryInfo::cpu_model),
+        field("cpu_frequency", &InventoryInfo::cpu_frequency),
+        field("memory_type", &InventoryInfo::memory_type),
+        field("disk_model", &InventoryInfo::disk_model),
+        field("disk_type", &InventoryInfo::disk_type),
+        field("disk_total_bytes", &InventoryInfo::disk_total_bytes),
+        field("gpu_model", &InventoryInfo::gpu_model),
+        field("mac_addresses", &InventoryInfo::mac_addresses),
+        field("ip_addresses", &InventoryInfo::ip_addresses),
+        field("installed_software", &InventoryInfo::installed_software),
+        field("installed_software_versions", &InventoryInfo::installed_software_versions),
+        optional_field("content_hash", &InventoryInfo::content_hash, non_empty));
+};
+
+template <>
+struct Schema<CgroupInfo> {
+    static constexpr auto fields = std::make_tuple(
+        field("path", &CgroupInfo::path),
+        field("cpu_percent", &CgroupInfo::cpu_percent),
+        field("cpu_user_percent", &CgroupInfo::cpu_user_percent),
+        field("cpu_system_percent", &CgroupInfo::cpu_system_percent),
+        field("throttled_percent", &CgroupInfo::throttled_percent),
+        field("memory_current", &CgroupInfo::memory_current),
+        field("memory_max", &CgroupInfo::memory_max),
+        field("memory_anon", &CgroupInfo::memory_anon),
+        field("memory_file", &CgroupInfo::memory_file),
+        field("read_bytes_per_sec", &CgroupInfo::read_bytes_per_sec),
+        field("write_bytes_per_sec", &CgroupInfo::write_bytes_per_sec),
+        field("reads_per_sec", &CgroupInfo::reads_per_sec),
+        field("writes_per_sec", &CgroupInfo::writes_per_sec),
+        field("cpu_pressure", &CgroupInfo::cpu_pressure));
+};
+
+template <>
+struct Schema<CgroupMetrics> {
+    static constexpr auto fields = std::make_tuple(
+        field("available", &CgroupMetrics::available),
+        field("groups", &CgroupMetrics::groups));
+};
+
+template <typename W>
+void write_network(W& w, const NetworkMetrics& network, bool full_connections) {
+    w.key("interfaces");
+    write_value(w, network.interfaces);
+    // Сводка по соединениям отправляется всегда
+    w.key("connection_summary");
+    write_value(w, network.connection_summary);
+    // Полный список соединений — только в режиме "full" или по запросу;
+    // коллекторы без агрегации (Windows) по-прежнему отдают список
+    const bool has_summary = network.connection_summary.total > 0 || network.connections.empty();
+    if (full_connections || !has_summary) {
+        w.key("connections");
+        write_value(w, network.connections);
+    }
+}
+
+template <typename W>
+void write_family(W& w, const SystemMetrics& metrics, uint32_t bit, bool full_connections) {
+    w.begin_object();
+    switch (bit) {
+    case kFamilyCpu: write_fields(w, metrics.cpu); break;
+    case kFamilyMemory: write_fields(w, metrics.memory); break;
+    case kFamilyDisk: write_fields(w, metrics.disk); break;
+    case kFamilyNetwork: write_network(w, metrics.network, full_connections); break;
+    case kFamilyGpu: write_fields(w, metrics.gpu); break;
+    case kFamilyHdd: write_fields(w, metrics.hdd); break;
+    case kFamilyUser: write_fields(w, metrics.user); break;
+    case kFamilyInventory: write_fields(w, metrics.inventory); break;
+    case kFamilyCgroup: write_fields(w, metrics.cgroup); break;
+    }
+    // Семейство не успело к сроку — передано последнее удачное значение
+    if (metrics.stale_families & bit) {
+        w.key("stale");
+        w.value(true);
+    }
+    w.end_object();
+}
+
+} // namespace
+
+bool write_metric_family(JsonWriter& w, const SystemMetrics& metrics, const std::string& family, bool full_connections) {
+    const uint32_t bit = metric_family_bit(family);
+    if (bit == 0) return false;
+    write_family(w, metrics, bit, full_connections);
+    return true;
+}
+
+bool write_metric_family(CborWriter& w, const SystemMetrics& metrics, const std::string& family, bool full_connections) {
+    const uint32_t bit = metric_family_bit(family);
+    if (bit == 0) return false;
+    // У каждого семейства свое пространство строк: фрагменты кэшируются и склеиваются независимо
+    w.begin_string_namespace();
+    write_family(w, metrics, bit, full_connections);
+    return true;
+}
+
+} // namespace monitoring
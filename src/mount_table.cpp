@@ -0,0 +1,98 @@
+/**
+ * @file mount_table.cpp
+ * @brief Реализация чтения /proc/self/mountinfo
+ */
+
+#include "../include/mount_table.hpp"
+
+#include <poll.h>
+#include <string_view>
+
+namespace monitoring {
+
+namespace {
+
+// В mountinfo пробелы, табуляции, переводы строк и '\' записаны как \ooo
+std::string unescape_octal(std::string_view s) {
+    std::string out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '\\' && i + 3 < s.size() &&
+            s[i + 1] >= '0' && s[i + 1] <= '7' && s[i + 2] >= '0' && s[i + 2] <= '7' &&
+            s[i + 3] >= '0' && s[i + 3] <= '7') {
+            out.push_back(static_cast<char>((s[i + 1] - '0') * 64 + (s[i + 2] - '0') * 8 + (s[i + 3] - '0')));
+            i += 3;
+        } else {
+            out.push_back(s[i]);
+        }
+    }
+    return out;
+}
+
+bool is_network_filesystem(std::string_view fs) {
+    for (std::string_view name : {"nfs", "nfs4", "cifs", "smb3", "smbfs", "ceph", "glusterfs",
+                                  "fuse.glusterfs", "fuse.sshfs", "9p", "afs"}) {
+        if (fs == name) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+MountTable::MountTable(std::string path) : file_(std::move(path), 16384) {}
+
+bool MountTable::changed() {
+    if (!loaded_ || !file_.is_open()) return true;
+    struct pollfd pfd{file_.fd(), POLLPRI, 0};
+    int rc = ::poll(&pfd, 1, 0);
+    return rc != 0;  // событие или ошибка poll — перечитываем
+}
+
+bool MountTable::refresh() {
+    if (!changed()) return false;
+    if (!file_.read()) {
+        entries_.clear();
+        loaded_ = false;
+        return true;
+    }
+    parse();
+    loaded_ = true;
+    return true;
+}
+
+void MountTable::parse() {
+    entries_.clear();
+    procfs::Scanner sc(file_.data());
+    if (sc.eof()) return;
+    // 36 35 98:0 /mnt1 /mnt/parent rw,noatime master:1 - ext3 /dev/root rw,errors=continue
+    do {
+        sc.skip_tokens(2);
+        uint64_t major = 0, minor = 0;
+        if (!sc.parse_u64(major) || !sc.consume(':') || !sc.parse_u64(minor)) continue;
+        sc.skip_tokens(1);
+        std::string_view mount_point = sc.token();
+        sc.skip_tokens(1);
+        // Необязательные поля до разделителя "-"
+        std::string_view field;
+        do {
+            field = sc.token();
+        } while (!field.empty() && field != "-");
+        if (field.empty()) continue;
+        std::string_view filesystem = sc.token();
+        std::string_view source = sc.token();
+
+        const bool network = is_network_filesystem(filesystem);
+        if (!network && source.rfind("/dev/", 0) != 0) continue;
+
+        MountEntry entry;
+        entry.mount_point = unescape_octal(mount_point);
+        entry.filesystem = std::string(filesystem);
+        entry.source = unescape_octal(source);
+        entry.major = static_cast<uint32_t>(major);
+        entry.minor = static_cast<uint32_t>(minor);
+        entry.network = network;
+        entries_.push_back(std::move(entry));
+    } while (sc.next_line());
+}
+
+} // namespace monitoring
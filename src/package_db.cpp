@@ -0,0 +1,180 @@
+/**
+ * @file package_db.cpp
+ * @brief Реализация чтения баз пакетов dpkg и rpm
+ */
+
+#include "../include/package_db.hpp"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dlfcn.h>
+#include <cstring>
+#include <string_view>
+
+namespace monitoring {
+
+namespace {
+
+bool field_value(std::string_view line, std::string_view name, std::string_view& value) {
+    if (line.size() <= name.size() || line.compare(0, name.size(), name) != 0 || line[name.size()] != ':') {
+        return false;
+    }
+    value = line.substr(name.size() + 1);
+    while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t' || value.back() == '\r')) value.remove_suffix(1);
+    return true;
+}
+
+// "install ok installed", "hold ok installed"; "deinstall ok config-files" и т.п. пропускаем
+bool is_installed(std::string_view status) {
+    constexpr std::string_view suffix = " installed";
+    return status.size() >= suffix.size() &&
+           status.compare(status.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+void parse_dpkg_status(std::string_view data, std::vector<InstalledPackage>& out) {
+    std::string_view package, version, status;
+    auto flush = [&]() {
+        if (!package.empty() && is_installed(status)) {
+            out.push_back(InstalledPackage{std::string(package), std::string(version)});
+        }
+        package = version = status = std::string_view();
+    };
+
+    size_t pos = 0;
+    while (pos < data.size()) {
+        const char* nl = static_cast<const char*>(std::memchr(data.data() + pos, '\n', data.size() - pos));
+        size_t end = nl ? static_cast<size_t>(nl - data.data()) : data.size();
+        std::string_view line = data.substr(pos, end - pos);
+        pos = end + 1;
+
+        if (line.empty() || line == "\r") {
+            flush();
+            continue;
+        }
+        if (line.front() == ' ' || line.front() == '\t') continue; // продолжение многострочного поля
+
+        std::string_view value;
+        switch (line.front()) {
+        case 'P':
+            if (field_value(line, "Package", value)) package = value;
+            break;
+        case 'S':
+            if (field_value(line, "Status", value)) status = value;
+            break;
+        case 'V':
+            if (field_value(line, "Version", value)) version = value;
+            break;
+        default:
+            break;
+        }
+    }
+    flush();
+}
+
+// Минимальное подмножество C API librpm
+using rpmReadConfigFiles_t = int (*)(const char*, const char*);
+using rpmtsCreate_t = void* (*)();
+using rpmtsFree_t = void* (*)(void*);
+using rpmtsInitIterator_t = void* (*)(void*, int, const void*, size_t);
+using rpmdbNextIterator_t = void* (*)(void*);
+using rpmdbFreeIterator_t = void* (*)(void*);
+using headerGetString_t = const char* (*)(void*, int);
+
+constexpr int kRpmDbiPackages = 0;
+constexpr int kRpmTagName = 1000;
+constexpr int kRpmTagVersion = 1001;
+constexpr int kRpmTagRelease = 1002;
+
+struct RpmApi {
+    void* lib = nullptr;
+    rpmReadConfigFiles_t read_config = nullptr;
+    rpmtsCreate_t ts_create = nullptr;
+    rpmtsFree_t ts_free = nullptr;
+    rpmtsInitIterator_t init_iterator = nullptr;
+    rpmdbNextIterator_t next_iterator = nullptr;
+    rpmdbFreeIterator_t free_iterator = nullptr;
+    headerGetString_t get_string = nullptr;
+};
+
+RpmApi load_rpm_api() {
+    RpmApi api;
+    void* lib = nullptr;
+    for (const char* name : {"librpm.so", "librpm.so.10", "librpm.so.9", "librpm.so.8", "librpm.so.3"}) {
+        lib = ::dlopen(name, RTLD_NOW | RTLD_LOCAL);
+        if (lib) break;
+    }
+    if (!lib) return api;
+    api.read_config = reinterpret_cast<rpmReadConfigFiles_t>(::dlsym(lib, "rpmReadConfigFiles"));
+    api.ts_create = reinterpret_cast<rpmtsCreate_t>(::dlsym(lib, "rpmtsCreate"));
+    api.ts_free = reinterpret_cast<rpmtsFree_t>(::dlsym(lib, "rpmtsFree"));
+    api.init_iterator = reinterpret_cast<rpmtsInitIterator_t>(::dlsym(lib, "rpmtsInitIterator"));
+    api.next_iterator = reinterpret_cast<rpmdbNextIterator_t>(::dlsym(lib, "rpmdbNextIterator"));
+    api.free_iterator = reinterpret_cast<rpmdbFreeIterator_t>(::dlsym(lib, "rpmdbFreeIterator"));
+    api.get_string = reinterpret_cast<headerGetString_t>(::dlsym(lib, "headerGetString"));
+    if (!api.read_config || !api.ts_create || !api.ts_free || !api.init_iterator ||
+        !api.next_iterator || !api.free_iterator || !api.get_string) {
+        ::dlclose(lib);
+        return RpmApi{};
+    }
+    api.lib = lib;
+    return api;
+}
+
+} // namespace
+
+bool read_dpkg_status(const char* path, std::vector<InstalledPackage>& out) {
+    out.clear();
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    if (st.st_size == 0) {
+        ::close(fd);
+        return true;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return false;
+    ::madvise(map, size, MADV_SEQUENTIAL);
+    parse_dpkg_status(std::string_view(static_cast<const char*>(map), size), out);
+    ::munmap(map, size);
+    return true;
+}
+
+bool read_rpm_database(std::vector<InstalledPackage>& out) {
+    out.clear();
+    // librpm загружается один раз и не выгружается: она хранит глобальное
+    // состояние (прочитанные macros/rpmrc), которое переживает rpmtsFree()
+    static const RpmApi api = load_rpm_api();
+    if (!api.lib) return false;
+
+    if (api.read_config(nullptr, nullptr) != 0) return false;
+    void* ts = api.ts_create();
+    if (!ts) return false;
+    void* it = api.init_iterator(ts, kRpmDbiPackages, nullptr, 0);
+    if (!it) {
+        api.ts_free(ts);
+        return false;
+    }
+    while (void* header = api.next_iterator(it)) {
+        const char* name = api.get_string(header, kRpmTagName);
+        if (!name || std::strcmp(name, "gpg-pubkey") == 0) continue;
+        const char* version = api.get_string(header, kRpmTagVersion);
+        const char* release = api.get_string(header, kRpmTagRelease);
+        InstalledPackage package{name, version ? version : ""};
+        if (release && *release) package.version.append("-").append(release);
+        out.push_back(std::move(package));
+    }
+    api.free_iterator(it);
+    api.ts_free(ts);
+    return true;
+}
+
+} // namespace monitoring
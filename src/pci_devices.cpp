@@ -0,0 +1,160 @@
+/**
+ * @file pci_devices.cpp
+ * @brief Реализация перечисления PCI-устройств и разбора pci.ids
+ */
+
+#include "../include/pci_devices.hpp"
+#include "../include/procfs_reader.hpp"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace monitoring {
+
+namespace {
+
+// Шестнадцатеричное значение атрибута sysfs вида "0x030000\n"
+bool read_sysfs_hex(const std::filesystem::path& path, uint64_t& value) {
+    procfs::ProcFile file(path.string(), 64);
+    if (!file.read()) return false;
+    std::string_view data = file.data();
+    while (!data.empty() && (data.back() == '\n' || data.back() == ' ')) data.remove_suffix(1);
+    if (data.size() > 2 && data[0] == '0' && (data[1] == 'x' || data[1] == 'X')) data.remove_prefix(2);
+    return procfs::parse_hex(data, value);
+}
+
+// Четыре шестнадцатеричные цифры в начале строки pci.ids
+bool parse_id(std::string_view line, uint16_t& id) {
+    uint64_t value = 0;
+    if (line.size() < 4 || !procfs::parse_hex(line.substr(0, 4), value)) return false;
+    id = static_cast<uint16_t>(value);
+    return true;
+}
+
+// Имя после идентификатора: "8086  Intel Corporation" -> "Intel Corporation"
+std::string_view id_name(std::string_view line) {
+    line.remove_prefix(std::min<size_t>(4, line.size()));
+    while (!line.empty() && (line.front() == ' ' || line.front() == '\t')) line.remove_prefix(1);
+    while (!line.empty() && (line.back() == ' ' || line.back() == '\r')) line.remove_suffix(1);
+    return line;
+}
+
+const char* const kPciIdsPaths[] = {
+    "/usr/share/misc/pci.ids",
+    "/usr/share/hwdata/pci.ids",
+    "/usr/share/pci.ids",
+    "/usr/local/share/pci.ids",
+};
+
+} // namespace
+
+std::vector<PciDevice> enumerate_pci_devices(const std::string& sysfs_root) {
+    namespace fs = std::filesystem;
+    std::vector<PciDevice> devices;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(fs::path(sysfs_root) / "bus/pci/devices", ec)) {
+        const fs::path& dir = entry.path();
+        uint64_t class_code = 0, vendor = 0, device = 0;
+        if (!read_sysfs_hex(dir / "class", class_code) ||
+            !read_sysfs_hex(dir / "vendor", vendor) ||
+            !read_sysfs_hex(dir / "device", device)) {
+            continue;
+        }
+        PciDevice pci;
+        pci.address = dir.filename().string();
+        pci.class_code = static_cast<uint32_t>(class_code);
+        pci.vendor_id = static_cast<uint16_t>(vendor);
+        pci.device_id = static_cast<uint16_t>(device);
+        int64_t boot_vga = 0;
+        pci.boot_vga = procfs::read_i64((dir / "boot_vga").c_str(), boot_vga) && boot_vga == 1;
+        devices.push_back(std::move(pci));
+    }
+    std::sort(devices.begin(), devices.end(),
+              [](const PciDevice& a, const PciDevice& b) { return a.address < b.address; });
+    return devices;
+}
+
+bool lookup_pci_ids(const char* ids_path, uint16_t vendor_id, uint16_t device_id,
+                    std::string& vendor_name, std::string& device_name) {
+    vendor_name.clear();
+    device_name.clear();
+
+    int fd = ::open(ids_path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return false;
+
+    // Формат: "vvvv  Vendor", "\tdddd  Device", "\t\tssss ssss  Subsystem";
+    // после списка производителей идут классы устройств ("C 00  ...")
+    std::string_view data(static_cast<const char*>(map), size);
+    bool in_vendor = false;
+    size_t pos = 0;
+    while (pos < data.size()) {
+        const char* nl = static_cast<const char*>(std::memchr(data.data() + pos, '\n', data.size() - pos));
+        size_t end = nl ? static_cast<size_t>(nl - data.data()) : data.size();
+        std::string_view line = data.substr(pos, end - pos);
+        pos = end + 1;
+
+        if (line.empty() || line.front() == '#') continue;
+        if (line.front() != '\t') {
+            if (in_vendor || line.front() == 'C') break;
+            uint16_t id = 0;
+            if (parse_id(line, id) && id == vendor_id) {
+                vendor_name = std::string(id_name(line));
+                in_vendor = true;
+            }
+            continue;
+        }
+        if (!in_vendor || (line.size() > 1 && line[1] == '\t')) continue;
+        uint16_t id = 0;
+        if (parse_id(line.substr(1), id) && id == device_id) {
+            device_name = std::string(id_name(line.substr(1)));
+            break;
+        }
+    }
+    ::munmap(map, size);
+    return in_vendor;
+}
+
+std::string pci_device_description(const PciDevice& device) {
+    static std::mutex cache_mutex;
+    static std::unordered_map<uint32_t, std::string> cache;
+
+    const uint32_t key = (static_cast<uint32_t>(device.vendor_id) << 16) | device.device_id;
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto it = cache.find(key);
+    if (it != cache.end()) return it->second;
+
+    char ids[16];
+    std::snprintf(ids, sizeof(ids), "[%04x:%04x]", device.vendor_id, device.device_id);
+    std::string description;
+    std::string vendor_name, device_name;
+    for (const char* path : kPciIdsPaths) {
+        if (lookup_pci_ids(path, device.vendor_id, device.device_id, vendor_name, device_name)) {
+            description = vendor_name + " " + (device_name.empty() ? std::string(ids) : device_name);
+            break;
+        }
+        if (::access(path, R_OK) == 0) break; // файл есть, но производителя в нем нет
+    }
+    if (description.empty()) description = ids;
+    cache.emplace(key, description);
+    return description;
+}
+
+} // namespace monitoring
@@ -0,0 +1,132 @@
+/**
+ * @file pressure_stats.cpp
+ * @brief Реализация чтения PSI, /proc/loadavg и /proc/vmstat
+ */
+
+#include "../include/pressure_stats.hpp"
+
+#include <unistd.h>
+
+namespace monitoring {
+
+namespace {
+
+// Десятичная дробь вида "12.34" без strtod: токен не завершается нулем
+bool parse_decimal(std::string_view s, double& value) {
+    const size_t dot = s.find('.');
+    uint64_t whole = 0;
+    if (!procfs::parse_u64(s.substr(0, dot), whole)) return false;
+    double fraction = 0;
+    if (dot != std::string_view::npos) {
+        double scale = 0.1;
+        for (char c : s.substr(dot + 1)) {
+            if (c < '0' || c > '9') return false;
+            fraction += (c - '0') * scale;
+            scale /= 10;
+        }
+    }
+    value = static_cast<double>(whole) + fraction;
+    return true;
+}
+
+// "some avg10=0.42 avg60=1.01 avg300=1.19 total=34979834"
+bool parse_stall_line(procfs::Scanner& sc, PressureStall& out) {
+    bool ok = true;
+    for (int i = 0; i < 4 && !sc.eol(); ++i) {
+        std::string_view key = sc.token_until('=');
+        std::string_view value = sc.token();
+        if (key == "avg10") ok &= parse_decimal(value, out.avg10);
+        else if (key == "avg60") ok &= parse_decimal(value, out.avg60);
+        else if (key == "avg300") ok &= parse_decimal(value, out.avg300);
+        else if (key == "total") ok &= procfs::parse_u64(value, out.total_us);
+    }
+    return ok;
+}
+
+double per_second(uint64_t current, uint64_t previous, double seconds) {
+    if (current < previous || seconds <= 0) return 0;
+    return static_cast<double>(current - previous) / seconds;
+}
+
+} // namespace
+
+bool parse_pressure(std::string_view text, PressureInfo& out) {
+    procfs::Scanner sc(text);
+    bool ok = false;
+    do {
+        std::string_view kind = sc.token();
+        if (kind == "some") ok = parse_stall_line(sc, out.some);
+        else if (kind == "full") parse_stall_line(sc, out.full);
+    } while (sc.next_line());
+    out.available = ok;
+    return ok;
+}
+
+PressureReader::PressureReader(const std::string& proc_root)
+    : pressure_{procfs::ProcFile(proc_root + "/pressure/cpu", 256),
+                procfs::ProcFile(proc_root + "/pressure/memory", 256),
+                procfs::ProcFile(proc_root + "/pressure/io", 256)},
+      loadavg_(proc_root + "/loadavg", 128),
+      vmstat_(proc_root + "/vmstat", 16384) {
+    for (int i = 0; i < 3; ++i) {
+        pressure_available_[i] = ::access(pressure_[i].path().c_str(), R_OK) == 0;
+    }
+}
+
+bool PressureReader::read_pressure(Resource resource, PressureInfo& out) {
+    const int index = static_cast<int>(resource);
+    out = PressureInfo{};
+    if (!pressure_available_[index] || !pressure_[index].read()) return false;
+    return parse_pressure(pressure_[index].data(), out);
+}
+
+// "0.35 0.30 0.25 2/70 9651"
+bool PressureReader::read_load(LoadAverage& out) {
+    out = LoadAverage{};
+    if (!loadavg_.read()) return false;
+
+    procfs::Scanner sc(loadavg_.data());
+    if (!parse_decimal(sc.token(), out.load1) || !parse_decimal(sc.token(), out.load5) ||
+        !parse_decimal(sc.token(), out.load15)) {
+        return false;
+    }
+    uint64_t running = 0, total = 0;
+    sc.skip_spaces();
+    if (sc.parse_u64(running) && sc.consume('/') && sc.parse_u64(total)) {
+        out.running = static_cast<uint32_t>(running);
+        out.total = static_cast<uint32_t>(total);
+    }
+    return true;
+}
+
+bool PressureReader::read_paging(PagingActivity& out) {
+    out = PagingActivity{};
+    if (!vmstat_.read()) return false;
+
+    int found = 0;
+    procfs::Scanner sc(vmstat_.data());
+    do {
+        uint64_t* target = nullptr;
+        if (sc.starts_with("pgmajfault ")) target = &out.major_faults;
+        else if (sc.starts_with("pswpin ")) target = &out.swap_in;
+        else if (sc.starts_with("pswpout ")) target = &out.swap_out;
+        if (!target) continue;
+        sc.token();
+        if (sc.parse_u64(*target)) ++found;
+    } while (found < 3 && sc.next_line());
+    if (found == 0) return false;
+
+    const auto now = std::chrono::steady_clock::now();
+    if (has_last_paging_) {
+        const double seconds = std::chrono::duration<double>(now - last_paging_time_).count();
+        out.major_faults_per_sec = per_second(out.major_faults, last_paging_.major_faults, seconds);
+        out.swap_in_per_sec = per_second(out.swap_in, last_paging_.swap_in, seconds);
+        out.swap_out_per_sec = per_second(out.swap_out, last_paging_.swap_out, seconds);
+    }
+    last_paging_ = out;
+    last_paging_time_ = now;
+    has_last_paging_ = true;
+    return true;
+}
+
+} // namespace monitoring
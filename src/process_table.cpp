@@ -0,0 +1,371 @@
+/**
+ * @file process_table.cpp
+ * @brief Реализация обхода /proc/[pid]
+ */
+
+#include "../include/process_table.hpp"
+#include "../include/procfs_reader.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace monitoring {
+
+namespace {
+
+constexpr size_t kMaxCmdline = 512;
+constexpr size_t kDirentBufferSize = 32768;
+constexpr rlim_t kReservedFds = 1024;     ///< Оставляются остальному агенту
+
+// Запись getdents64; в glibc до 2.30 нет объявления
+struct LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+bool parse_pid(const char* name, uint32_t& pid) {
+    if (*name < '1' || *name > '9') return false;
+    uint32_t value = 0;
+    for (; *name; ++name) {
+        if (*name < '0' || *name > '9') return false;
+        value = value * 10 + static_cast<uint32_t>(*name - '0');
+    }
+    pid = value;
+    return true;
+}
+
+// "1234/stat" без snprintf
+void format_path(char* out, uint32_t pid, const char* file) {
+    char digits[10];
+    size_t n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + pid % 10);
+        pid /= 10;
+    } while (pid);
+    size_t len = 0;
+    while (n) out[len++] = digits[--n];
+    out[len++] = '/';
+    for (; *file; ++file) out[len++] = *file;
+    out[len] = '\0';
+}
+
+struct StatFields {
+    std::string_view name;
+    char state = '?';
+    uint64_t cpu_ticks = 0;       ///< utime + stime
+    uint32_t threads = 0;
+    uint64_t starttime = 0;       ///< Время запуска в тиках после загрузки
+};
+
+// "pid (comm) state ppid ... utime(14) stime(15) ... num_threads(20) itrealvalue(21) starttime(22) ..."
+bool parse_stat(std::string_view text, StatFields& out) {
+    // comm может содержать пробелы и скобки — берется последняя ')'
+    const size_t open = text.find('(');
+    const size_t close = text.rfind(')');
+    if (open == std::string_view::npos || close == std::string_view::npos || close < open) return false;
+    out.name = text.substr(open + 1, close - open - 1);
+
+    procfs::Scanner sc(text.substr(close + 1));
+    std::string_view state = sc.token();
+    out.state = state.empty() ? '?' : state[0];
+    uint64_t utime = 0, stime = 0, threads = 0;
+    sc.skip_tokens(10);                   // ppid .. cmajflt (поля 4-13)
+    sc.skip_spaces();
+    if (!sc.parse_u64(utime)) return false;
+    sc.skip_spaces();
+    if (!sc.parse_u64(stime)) return false;
+    sc.skip_tokens(4);                    // cutime cstime priority nice
+    sc.skip_spaces();
+    if (!sc.parse_u64(threads)) return false;
+    sc.skip_tokens(1);                    // itrealvalue
+    sc.skip_spaces();
+    if (!sc.parse_u64(out.starttime)) return false;
+    out.cpu_ticks = utime + stime;
+    out.threads = static_cast<uint32_t>(threads);
+    return true;
+}
+
+double per_second(uint64_t current, uint64_t previous, double seconds) {
+    if (current < previous || seconds <= 0) return 0;
+    return static_cast<double>(current - previous) / seconds;
+}
+
+} // namespace
+
+ProcessTable::ProcessTable(std::string proc_root)
+    : proc_root_(std::move(proc_root)), buffer_(4096) {
+    proc_fd_ = ::open(proc_root_.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    use_schedstat_ = proc_fd_ >= 0 && ::faccessat(proc_fd_, "self/schedstat", R_OK, 0) == 0;
+    long ticks = sysconf(_SC_CLK_TCK);
+    if (ticks > 0) ns_per_tick_ = 1e9 / static_cast<double>(ticks);
+    long page = sysconf(_SC_PAGESIZE);
+    if (page > 0) page_size_ = static_cast<uint64_t>(page);
+
+    struct rlimit limit;
+    if (::getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+        if (limit.rlim_cur < limit.rlim_max) {
+            struct rlimit raised = limit;
+            raised.rlim_cur = limit.rlim_max == RLIM_INFINITY ? rlim_t{1} << 20 : limit.rlim_max;
+            if (::setrlimit(RLIMIT_NOFILE, &raised) == 0) limit = raised;
+        }
+        fd_budget_ = limit.rlim_cur > 2 * kReservedFds ? static_cast<size_t>(limit.rlim_cur - kReservedFds)
+                                                       : static_cast<size_t>(limit.rlim_cur / 2);
+    }
+}
+
+ProcessTable::~ProcessTable() {
+    for (auto& entry : entries_) close_entry(entry);
+    if (proc_fd_ >= 0) ::close(proc_fd_);
+}
+
+bool ProcessTable::read_file(uint32_t pid, const char* file, std::string_view& out) {
+    char path[32];
+    format_path(path, pid, file);
+    int fd = ::openat(proc_fd_, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    size_t size = 0;
+    for (;;) {
+        ssize_t n = ::read(fd, buffer_.data() + size, buffer_.size() - size);
+        if (n < 0) {
+            ::close(fd);
+            return false;
+        }
+        size += static_cast<size_t>(n);
+        if (n == 0 || size < buffer_.size()) break;
+        buffer_.resize(buffer_.size() * 2);
+    }
+    ::close(fd);
+    out = std::string_view(buffer_.data(), size);
+    return true;
+}
+
+bool ProcessTable::read_counter_file(uint32_t pid, int fd, const char* file, std::string_view& out) {
+    if (fd < 0) return read_file(pid, file, out);
+    ssize_t n = ::pread(fd, buffer_.data(), buffer_.size(), 0);
+    if (n <= 0) return false;
+    out = std::string_view(buffer_.data(), static_cast<size_t>(n));
+    return true;
+}
+
+int ProcessTable::open_counter_file(uint32_t pid, const char* file) {
+    if (open_fds_ >= fd_budget_) return -1;
+    char path[32];
+    format_path(path, pid, file);
+    int fd = ::openat(proc_fd_, path, O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) ++open_fds_;
+    return fd;
+}
+
+void ProcessTable::close_entry(Entry& entry) {
+    if (entry.schedstat_fd < 0) return;
+    ::close(entry.schedstat_fd);
+    entry.schedstat_fd = -1;
+    --open_fds_;
+}
+
+// В /proc/[pid]/task по ссылке на каждый поток, плюс "." и ".."
+bool ProcessTable::single_threaded(uint32_t pid) {
+    char path[32];
+    format_path(path, pid, "task");
+    struct stat st;
+    return ::fstatat(proc_fd_, path, &st, 0) == 0 && st.st_nlink == 3;
+}
+
+// schedstat: "run_ns wait_ns timeslices" — только главного потока,
+// поэтому у многопоточных процессов время берется из stat
+bool ProcessTable::read_cpu(Entry& entry) {
+    std::string_view text;
+    const bool schedstat = use_schedstat_ && single_threaded(entry.pid);
+    // Без открытого schedstat файлы читаются по pid, который мог занять новый процесс:
+    // он отличается временем запуска
+    if (!schedstat || entry.schedstat_fd < 0) {
+        StatFields stat;
+        if (!read_file(entry.pid, "stat", text) || !parse_stat(text, stat)) return false;
+        if (stat.starttime != entry.starttime) return false;
+        if (!schedstat) {
+            entry.cpu_ns = static_cast<uint64_t>(static_cast<double>(stat.cpu_ticks) * ns_per_tick_);
+            entry.cpu_from_stat = true;
+            return true;
+        }
+    }
+    if (!read_counter_file(entry.pid, entry.schedstat_fd, "schedstat", text)) return false;
+    procfs::Scanner sc(text);
+    entry.cpu_from_stat = false;
+    return sc.parse_u64(entry.cpu_ns);
+}
+
+// statm: "size resident shared ..." в страницах
+bool ProcessTable::read_rss(Entry& entry) {
+    std::string_view text;
+    if (!read_file(entry.pid, "statm", text)) return false;
+    procfs::Scanner sc(text);
+    sc.skip_tokens(1);
+    sc.skip_spaces();
+    return sc.parse_u64(entry.rss_pages);
+}
+
+// Выполняется один раз для нового pid
+bool ProcessTable::start_entry(Entry& entry) {
+    std::string_view text;
+    StatFields stat;
+    if (!read_file(entry.pid, "stat", text) || !parse_stat(text, stat)) return false;
+    entry.name.assign(stat.name.data(), stat.name.size());
+    entry.starttime = stat.starttime;
+
+    char path[32];
+    format_path(path, entry.pid, ".");
+    struct stat st;
+    entry.uid = ::fstatat(proc_fd_, path, &st, 0) == 0 ? st.st_uid : 0;
+
+    entry.cmdline.clear();
+    if (read_file(entry.pid, "cmdline", text)) {
+        text = text.substr(0, kMaxCmdline);
+        while (!text.empty() && text.back() == '\0') text.remove_suffix(1);
+        entry.cmdline.assign(text.data(), text.size());
+        std::replace(entry.cmdline.begin(), entry.cmdline.end(), '\0', ' ');
+    }
+
+    if (use_schedstat_) entry.schedstat_fd = open_counter_file(entry.pid, "schedstat");
+    if (!read_cpu(entry) || !read_rss(entry)) return false;
+    read_io(entry);
+    return true;
+}
+
+void ProcessTable::read_io(Entry& entry) {
+    if (entry.io_denied) return;
+    std::string_view text;
+    if (!read_file(entry.pid, "io", text)) {
+        // Без прав на чужой процесс io не откроется до конца его жизни
+        entry.io_denied = errno == EACCES;
+        return;
+    }
+    procfs::Scanner sc(text);
+    int found = 0;
+    do {
+        if (sc.starts_with("read_bytes:")) {
+            sc.token();
+            if (sc.parse_u64(entry.read_bytes)) ++found;
+        } else if (sc.starts_with("write_bytes:")) {
+            sc.token();
+            if (sc.parse_u64(entry.write_bytes)) ++found;
+        }
+    } while (found < 2 && sc.next_line());
+}
+
+void ProcessTable::update() {
+    if (proc_fd_ < 0) return;
+    const auto now = std::chrono::steady_clock::now();
+    const double seconds = entries_.empty() ? 0 : std::chrono::duration<double>(now - last_update_).count();
+    last_update_ = now;
+
+    alignas(LinuxDirent64) char dirents[kDirentBufferSize];
+    if (::lseek(proc_fd_, 0, SEEK_SET) < 0) return;
+
+    next_.clear();
+    size_t prev = 0;
+    for (;;) {
+        long n = ::syscall(SYS_getdents64, proc_fd_, dirents, sizeof(dirents));
+        if (n <= 0) break;
+        for (long offset = 0; offset < n;) {
+            const auto* d = reinterpret_cast<const LinuxDirent64*>(dirents + offset);
+            offset += d->d_reclen;
+            uint32_t pid = 0;
+            if (d->d_type != DT_DIR || !parse_pid(d->d_name, pid)) continue;
+
+            // Слияние с прошлым обходом: оба списка по возрастанию pid
+            while (prev < entries_.size() && entries_[prev].pid < pid) ++prev;
+            Entry* old = prev < entries_.size() && entries_[prev].pid == pid ? &entries_[prev] : nullptr;
+
+            next_.emplace_back();
+            Entry& entry = next_.back();
+            entry.pid = pid;
+            if (old) {
+                entry.name = std::move(old->name);
+                entry.cmdline = std::move(old->cmdline);
+                entry.uid = old->uid;
+                entry.starttime = old->starttime;
+                entry.schedstat_fd = old->schedstat_fd;
+                old->schedstat_fd = -1;
+                entry.rss_pages = old->rss_pages;
+                entry.io_denied = old->io_denied;
+                entry.read_bytes = old->read_bytes;
+                entry.write_bytes = old->write_bytes;
+                // RSS растет и ввод-вывод идет только у процесса, который выполнялся
+                if (read_cpu(entry)) {
+                    // При смене источника (процесс стал многопоточным) прирост неизвестен
+                    const uint64_t cpu_ns = entry.cpu_ns >= old->cpu_ns && entry.cpu_from_stat == old->cpu_from_stat
+                        ? entry.cpu_ns - old->cpu_ns : 0;
+                    if (seconds > 0) entry.cpu_percent = static_cast<double>(cpu_ns) / (seconds * 1e7);
+                    if (cpu_ns > 0) {
+                        read_rss(entry);
+                        read_io(entry);
+                        entry.read_bytes_per_sec = per_second(entry.read_bytes, old->read_bytes, seconds);
+                        entry.write_bytes_per_sec = per_second(entry.write_bytes, old->write_bytes, seconds);
+                    }
+                    continue;
+                }
+                // Процесс завершился или pid занят новым процессом — запись заводится заново
+                close_entry(entry);
+                entry = Entry{};
+                entry.pid = pid;
+            }
+            if (!start_entry(entry)) {
+                close_entry(entry);
+                next_.pop_back();
+            }
+        }
+    }
+    // Записи завершившихся процессов
+    for (auto& entry : entries_) close_entry(entry);
+    entries_.swap(next_);
+}
+
+void ProcessTable::fill(const Entry& entry, ProcessInfo& info) {
+    info.pid = entry.pid;
+    info.name = entry.name;
+    info.cmdline = entry.cmdline;
+    info.uid = entry.uid;
+    info.cpu_percent = entry.cpu_percent;
+    info.rss_bytes = entry.rss_pages * page_size_;
+    info.read_bytes_per_sec = entry.read_bytes_per_sec;
+    info.write_bytes_per_sec = entry.write_bytes_per_sec;
+
+    std::string_view text;
+    StatFields stat;
+    if (read_file(entry.pid, "stat", text) && parse_stat(text, stat)) {
+        info.state = stat.state;
+        info.threads = stat.threads;
+    }
+}
+
+void ProcessTable::top(size_t n, ProcessMetrics& out) {
+    out.total = static_cast<uint32_t>(entries_.size());
+
+    auto select = [&](std::vector<ProcessInfo>& list, auto key) {
+        order_.clear();
+        for (uint32_t i = 0; i < entries_.size(); ++i) {
+            if (key(entries_[i]) > 0) order_.push_back(i);
+        }
+        const size_t count = std::min(n, order_.size());
+        std::partial_sort(order_.begin(), order_.begin() + count, order_.end(), [&](uint32_t a, uint32_t b) {
+            return key(entries_[a]) > key(entries_[b]);
+        });
+        list.clear();
+        list.resize(count);
+        for (size_t i = 0; i < count; ++i) fill(entries_[order_[i]], list[i]);
+    };
+    select(out.top_cpu, [](const Entry& e) { return e.cpu_percent; });
+    select(out.top_memory, [](const Entry& e) { return static_cast<double>(e.rss_pages); });
+    select(out.top_io, [](const Entry& e) { return e.read_bytes_per_sec + e.write_bytes_per_sec; });
+}
+
+} // namespace monitoring
@@ -0,0 +1,222 @@
+/**
+ * @file procfs_reader.cpp
+ * @brief Реализация чтения и разбора файлов /proc и /sys
+ */
+
+#include "../include/procfs_reader.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+
+namespace monitoring {
+namespace procfs {
+
+ProcFile::ProcFile(std::string path, size_t initial_capacity)
+    : path_(std::move(path)), buffer_(initial_capacity ? initial_capacity : 4096) {}
+
+ProcFile::~ProcFile() {
+    close();
+}
+
+ProcFile::ProcFile(ProcFile&& other) noexcept
+    : path_(std::move(other.path_)), buffer_(std::move(other.buffer_)), size_(other.size_), fd_(other.fd_) {
+    other.size_ = 0;
+    other.fd_ = -1;
+}
+
+ProcFile& ProcFile::operator=(ProcFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        path_ = std::move(other.path_);
+        buffer_ = std::move(other.buffer_);
+        size_ = other.size_;
+        fd_ = other.fd_;
+        other.size_ = 0;
+        other.fd_ = -1;
+    }
+    return *this;
+}
+
+bool ProcFile::open() {
+    if (fd_ >= 0) return true;
+    fd_ = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    return fd_ >= 0;
+}
+
+void ProcFile::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool ProcFile::read_from_fd() {
+    size_ = 0;
+    if (buffer_.empty()) buffer_.resize(4096);
+    for (;;) {
+        if (size_ == buffer_.size()) {
+            buffer_.resize(buffer_.size() * 2);
+        }
+        ssize_t n = ::pread(fd_, buffer_.data() + size_, buffer_.size() - size_, static_cast<off_t>(size_));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            size_ = 0;
+            return false;
+        }
+        if (n == 0) return true;
+        size_ += static_cast<size_t>(n);
+    }
+}
+
+bool ProcFile::read() {
+    bool was_open = fd_ >= 0;
+    if (!open()) {
+        size_ = 0;
+        return false;
+    }
+    if (read_from_fd()) return true;
+
+    // Дескриптор мог устареть (устройство удалено и добавлено заново) —
+    // переоткрываем файл один раз
+    close();
+    if (!was_open || !open()) return false;
+    if (read_from_fd()) return true;
+    close();
+    return false;
+}
+
+bool Scanner::next_line() {
+    while (pos_ < text_.size() && text_[pos_] != '\n') ++pos_;
+    if (pos_ >= text_.size()) return false;
+    ++pos_;
+    return pos_ < text_.size();
+}
+
+void Scanner::skip_spaces() {
+    while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\t')) ++pos_;
+}
+
+std::string_view Scanner::token() {
+    skip_spaces();
+    size_t start = pos_;
+    while (pos_ < text_.size() && text_[pos_] != ' ' && text_[pos_] != '\t' && text_[pos_] != '\n') ++pos_;
+    return text_.substr(start, pos_ - start);
+}
+
+std::string_view Scanner::token_until(char sep) {
+    skip_spaces();
+    size_t start = pos_;
+    while (pos_ < text_.size() && text_[pos_] != sep && text_[pos_] != ' ' && text_[pos_] != '\n') ++pos_;
+    std::string_view result = text_.substr(start, pos_ - start);
+    if (pos_ < text_.size() && text_[pos_] == sep) ++pos_;
+    return result;
+}
+
+std::string_view Scanner::rest_of_line() {
+    skip_spaces();
+    size_t start = pos_;
+    while (pos_ < text_.size() && text_[pos_] != '\n') ++pos_;
+    return text_.substr(start, pos_ - start);
+}
+
+void Scanner::skip_tokens(size_t n) {
+    for (size_t i = 0; i < n && !eol(); ++i) token();
+}
+
+bool Scanner::parse_u64(uint64_t& value) {
+    skip_spaces();
+    size_t start = pos_;
+    uint64_t v = 0;
+    while (pos_ < text_.size() && text_[pos_] >= '0' && text_[pos_] <= '9') {
+        v = v * 10 + static_cast<uint64_t>(text_[pos_] - '0');
+        ++pos_;
+    }
+    if (pos_ == start) return false;
+    value = v;
+    return true;
+}
+
+bool Scanner::parse_i64(int64_t& value) {
+    skip_spaces();
+    bool negative = consume('-');
+    uint64_t v = 0;
+    if (!parse_u64(v)) return false;
+    value = negative ? -static_cast<int64_t>(v) : static_cast<int64_t>(v);
+    return true;
+}
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool Scanner::parse_hex(uint64_t& value) {
+    skip_spaces();
+    size_t start = pos_;
+    uint64_t v = 0;
+    int d;
+    while (pos_ < text_.size() && (d = hex_digit(text_[pos_])) >= 0) {
+        v = (v << 4) | static_cast<uint64_t>(d);
+        ++pos_;
+    }
+    if (pos_ == start) return false;
+    value = v;
+    return true;
+}
+
+bool Scanner::starts_with(std::string_view prefix) const {
+    return text_.substr(pos_, prefix.size()) == prefix;
+}
+
+bool Scanner::consume(char c) {
+    if (pos_ < text_.size() && text_[pos_] == c) {
+        ++pos_;
+        return true;
+    }
+    return false;
+}
+
+bool parse_u64(std::string_view s, uint64_t& value) {
+    Scanner sc(s);
+    return sc.parse_u64(value) && sc.eol();
+}
+
+bool parse_hex(std::string_view s, uint64_t& value) {
+    Scanner sc(s);
+    return sc.parse_hex(value) && sc.eol();
+}
+
+bool read_i64(const char* path, int64_t& value) {
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    char buf[64];
+    ssize_t n;
+    do {
+        n = ::pread(fd, buf, sizeof(buf), 0);
+    } while (n < 0 && errno == EINTR);
+    ::close(fd);
+    if (n <= 0) return false;
+    Scanner sc(std::string_view(buf, static_cast<size_t>(n)));
+    return sc.parse_i64(value);
+}
+
+size_t format_ipv4(uint32_t addr, char* out) {
+    // В /proc/net адрес записан как число в порядке байт хоста поверх
+    // сетевого порядка, поэтому младший байт — первый октет
+    size_t len = 0;
+    for (int i = 0; i < 4; ++i) {
+        unsigned octet = (addr >> (8 * i)) & 0xFF;
+        if (octet >= 100) out[len++] = static_cast<char>('0' + octet / 100);
+        if (octet >= 10) out[len++] = static_cast<char>('0' + (octet / 10) % 10);
+        out[len++] = static_cast<char>('0' + octet % 10);
+        if (i < 3) out[len++] = '.';
+    }
+    out[len] = '\0';
+    return len;
+}
+
+} // namespace procfs
+} // namespace monitoring
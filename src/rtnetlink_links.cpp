@@ -0,0 +1,197 @@
+/**
+ * @file rtnetlink_links.cpp
+ * @brief Реализация дампа интерфейсов через RTM_GETLINK
+ */
+
+#include "../include/rtnetlink_links.hpp"
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/if_link.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace monitoring {
+
+namespace {
+
+const char* const kOperStateNames[] = {
+    "unknown",
+    "notpresent",
+    "down",
+    "lowerlayerdown",
+    "testing",
+    "dormant",
+    "up",
+};
+
+template <typename Stats>
+void copy_stats(const Stats& stats, LinkInfo& link) {
+    link.rx_bytes = stats.rx_bytes;
+    link.tx_bytes = stats.tx_bytes;
+    link.rx_packets = stats.rx_packets;
+    link.tx_packets = stats.tx_packets;
+    link.rx_errors = stats.rx_errors;
+    link.tx_errors = stats.tx_errors;
+    link.rx_dropped = stats.rx_dropped;
+    link.tx_dropped = stats.tx_dropped;
+}
+
+} // namespace
+
+const char* operstate_name(uint8_t operstate) {
+    constexpr size_t count = sizeof(kOperStateNames) / sizeof(kOperStateNames[0]);
+    return operstate < count ? kOperStateNames[operstate] : kOperStateNames[0];
+}
+
+RtnetlinkClient::RtnetlinkClient() : buffer_(65536) {
+    fd_ = ::socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (fd_ < 0) return;
+    struct timeval tv{};
+    tv.tv_sec = 1;
+    setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+}
+
+RtnetlinkClient::~RtnetlinkClient() {
+    if (fd_ >= 0) ::close(fd_);
+}
+
+bool RtnetlinkClient::dump_links(std::vector<LinkInfo>& out) {
+    if (fd_ < 0) return false;
+
+    struct {
+        struct nlmsghdr nlh;
+        struct ifinfomsg ifi;
+    } request{};
+    request.nlh.nlmsg_len = sizeof(request);
+    request.nlh.nlmsg_type = RTM_GETLINK;
+    request.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    request.nlh.nlmsg_seq = ++seq_;
+    request.ifi.ifi_family = AF_UNSPEC;
+
+    struct sockaddr_nl kernel{};
+    kernel.nl_family = AF_NETLINK;
+    ssize_t sent;
+    do {
+        sent = ::sendto(fd_, &request, sizeof(request), 0,
+                        reinterpret_cast<struct sockaddr*>(&kernel), sizeof(kernel));
+    } while (sent < 0 && errno == EINTR);
+    if (sent < 0) return false;
+
+    size_t count = 0;
+    for (;;) {
+        struct iovec iov{buffer_.data(), buffer_.size()};
+        struct msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        ssize_t len = ::recvmsg(fd_, &msg, 0);
+        if (len < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (len == 0 || (msg.msg_flags & MSG_TRUNC)) return false;
+
+        int remaining = static_cast<int>(len);
+        for (auto* h = reinterpret_cast<struct nlmsghdr*>(buffer_.data());
+             NLMSG_OK(h, remaining); h = NLMSG_NEXT(h, remaining)) {
+            if (h->nlmsg_seq != seq_) continue;
+            if (h->nlmsg_type == NLMSG_DONE) {
+                out.resize(count);
+                return true;
+            }
+            if (h->nlmsg_type == NLMSG_ERROR) return false;
+            if (h->nlmsg_type != RTM_NEWLINK) continue;
+            if (h->nlmsg_len < NLMSG_LENGTH(sizeof(struct ifinfomsg))) continue;
+
+            const auto* ifi = static_cast<const struct ifinfomsg*>(NLMSG_DATA(h));
+            if (count == out.size()) out.emplace_back();
+            LinkInfo& link = out[count];
+            std::string name = std::move(link.name); // сохраняем емкость строки
+            link = LinkInfo{};
+            name.clear();
+            link.name = std::move(name);
+            link.ifindex = ifi->ifi_index;
+            link.flags = ifi->ifi_flags;
+
+            bool have_stats64 = false;
+            int attr_len = static_cast<int>(h->nlmsg_len - NLMSG_LENGTH(sizeof(*ifi)));
+            for (auto* rta = IFLA_RTA(ifi); RTA_OK(rta, attr_len); rta = RTA_NEXT(rta, attr_len)) {
+                const void* data = RTA_DATA(rta);
+                const size_t payload = RTA_PAYLOAD(rta);
+                switch (rta->rta_type) {
+                case IFLA_IFNAME:
+                    link.name.assign(static_cast<const char*>(data), strnlen(static_cast<const char*>(data), payload));
+                    break;
+                case IFLA_MTU:
+                    if (payload >= sizeof(uint32_t)) std::memcpy(&link.mtu, data, sizeof(uint32_t));
+                    break;
+                case IFLA_OPERSTATE:
+                    if (payload >= 1) link.operstate = *static_cast<const uint8_t*>(data);
+                    break;
+                case IFLA_CARRIER:
+                    if (payload >= 1) link.carrier = *static_cast<const uint8_t*>(data) != 0;
+                    break;
+                case IFLA_STATS64:
+                    if (payload >= sizeof(struct rtnl_link_stats64)) {
+                        struct rtnl_link_stats64 stats;
+                        std::memcpy(&stats, data, sizeof(stats));
+                        copy_stats(stats, link);
+                        have_stats64 = true;
+                    }
+                    break;
+                case IFLA_STATS:
+                    // Старые ядра: 32-битные счетчики, только если нет IFLA_STATS64
+                    if (!have_stats64 && payload >= sizeof(struct rtnl_link_stats)) {
+                        struct rtnl_link_stats stats;
+                        std::memcpy(&stats, data, sizeof(stats));
+                        copy_stats(stats, link);
+                    }
+                    break;
+                default:
+                    break;
+                }
+            }
+            ++count;
+        }
+    }
+}
+
+RtnetlinkMonitor::RtnetlinkMonitor(uint32_t groups) {
+    fd_ = ::socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_ROUTE);
+    if (fd_ < 0) return;
+    struct sockaddr_nl local{};
+    local.nl_family = AF_NETLINK;
+    local.nl_groups = groups;
+    if (::bind(fd_, reinterpret_cast<struct sockaddr*>(&local), sizeof(local)) < 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+RtnetlinkMonitor::~RtnetlinkMonitor() {
+    if (fd_ >= 0) ::close(fd_);
+}
+
+bool RtnetlinkMonitor::changed() {
+    if (fd_ < 0) return true;
+    bool any = false;
+    char buffer[8192];
+    for (;;) {
+        ssize_t len = ::recv(fd_, buffer, sizeof(buffer), 0);
+        if (len > 0) {
+            any = true;
+            continue;
+        }
+        if (len < 0 && errno == EINTR) continue;
+        if (len < 0 && errno == ENOBUFS) {
+            any = true;
+            continue;
+        }
+        return any;
+    }
+}
+
+} // namespace monitoring
@@ -0,0 +1,139 @@
+/**
+ * @file sensor_registry.cpp
+ * @brief Реализация реестра датчиков температуры Linux
+ */
+
+#include "../include/sensor_registry.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <tuple>
+
+namespace monitoring {
+
+namespace {
+
+// Первая строка небольшого файла /sys без завершающего перевода строки
+std::string read_sysfs_line(const std::filesystem::path& path) {
+    procfs::ProcFile file(path.string(), 128);
+    if (!file.read()) return "";
+    std::string_view data = file.data();
+    size_t end = data.find('\n');
+    if (end != std::string_view::npos) data = data.substr(0, end);
+    while (!data.empty() && (data.back() == ' ' || data.back() == '\r')) data.remove_suffix(1);
+    return std::string(data);
+}
+
+// Числовой суффикс после prefix ("hwmon3" -> 3), -1 если его нет
+int numeric_suffix(const std::string& name, const std::string& prefix) {
+    if (name.compare(0, prefix.size(), prefix) != 0) return -1;
+    uint64_t value = 0;
+    if (!procfs::parse_u64(std::string_view(name).substr(prefix.size()), value)) return -1;
+    return static_cast<int>(value);
+}
+
+struct Candidate {
+    TemperatureSensor::Kind kind;
+    int dir_index;
+    int index;
+    std::string path;
+    std::string chip;
+    std::string label;
+};
+
+} // namespace
+
+SensorRegistry::SensorRegistry(std::string sysfs_root, std::chrono::seconds rescan_interval)
+    : root_(std::move(sysfs_root)), rescan_interval_(rescan_interval) {
+    rescan();
+}
+
+void SensorRegistry::refresh_if_due() {
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_scan_ >= rescan_interval_ || (read_failed_ && now - last_scan_ >= kRetryInterval)) {
+        rescan();
+    }
+}
+
+void SensorRegistry::rescan() {
+    namespace fs = std::filesystem;
+    last_scan_ = std::chrono::steady_clock::now();
+    read_failed_ = false;
+
+    std::vector<Candidate> found;
+    try {
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(fs::path(root_) / "class/thermal", ec)) {
+            std::string name = entry.path().filename().string();
+            int index = numeric_suffix(name, "thermal_zone");
+            if (index < 0) continue;
+            found.push_back({TemperatureSensor::Kind::ThermalZone, 0, index,
+                             (entry.path() / "temp").string(),
+                             read_sysfs_line(entry.path() / "type"), name});
+        }
+    } catch (...) {}
+
+    try {
+        std::error_code ec;
+        for (const auto& hwmon_entry : fs::directory_iterator(fs::path(root_) / "class/hwmon", ec)) {
+            int dir_index = numeric_suffix(hwmon_entry.path().filename().string(), "hwmon");
+            std::string chip = read_sysfs_line(hwmon_entry.path() / "name");
+            std::error_code inner_ec;
+            for (const auto& file_entry : fs::directory_iterator(hwmon_entry.path(), inner_ec)) {
+                std::string fname = file_entry.path().filename().string();
+                const std::string suffix = "_input";
+                if (fname.rfind("temp", 0) != 0 || fname.size() <= suffix.size() + 4 ||
+                    fname.compare(fname.size() - suffix.size(), suffix.size(), suffix) != 0) {
+                    continue;
+                }
+                std::string base = fname.substr(0, fname.size() - suffix.size()); // tempN
+                int index = numeric_suffix(base, "temp");
+                if (index < 0) continue;
+                std::string label = read_sysfs_line(hwmon_entry.path() / (base + "_label"));
+                if (label.empty()) label = base;
+                found.push_back({TemperatureSensor::Kind::Hwmon, dir_index, index,
+                                 file_entry.path().string(), chip, label});
+            }
+        }
+    } catch (...) {}
+
+    std::sort(found.begin(), found.end(), [](const Candidate& a, const Candidate& b) {
+        return std::tie(a.kind, a.dir_index, a.index) < std::tie(b.kind, b.dir_index, b.index);
+    });
+
+    std::vector<TemperatureSensor> updated;
+    updated.reserve(found.size());
+    for (auto& c : found) {
+        auto it = std::find_if(sensors_.begin(), sensors_.end(),
+                               [&](const TemperatureSensor& s) { return s.file.path() == c.path; });
+        if (it != sensors_.end()) {
+            // Уже открытый дескриптор переиспользуем, метаданные обновляем
+            it->chip = std::move(c.chip);
+            it->label = std::move(c.label);
+            it->index = c.index;
+            updated.push_back(std::move(*it));
+        } else {
+            updated.push_back(TemperatureSensor{c.kind, procfs::ProcFile(std::move(c.path), 64),
+                                                std::move(c.chip), std::move(c.label), 0.001, c.index});
+        }
+    }
+    sensors_.swap(updated);
+}
+
+bool SensorRegistry::read(TemperatureSensor& sensor, double& celsius) {
+    int64_t raw = 0;
+    procfs::Scanner sc(sensor.file.read() ? sensor.file.data() : std::string_view());
+    if (!sc.parse_i64(raw)) {
+        read_failed_ = true;
+        return false;
+    }
+    celsius = static_cast<double>(raw) * sensor.scale;
+    return true;
+}
+
+std::string SensorRegistry::display_name(const TemperatureSensor& sensor) {
+    if (sensor.chip.empty()) return sensor.label;
+    return sensor.chip + ": " + sensor.label;
+}
+
+} // namespace monitoring
@@ -0,0 +1,285 @@
+/**
+ * @file smart_reader.cpp
+ * @brief Реализация чтения S.M.A.R.T. через SG_IO и NVMe admin-команды
+ */
+
+#include "../include/smart_reader.hpp"
+
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <scsi/sg.h>
+#include <linux/nvme_ioctl.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <set>
+
+namespace monitoring {
+
+namespace {
+
+constexpr unsigned int kIoTimeoutMs = 5000;
+
+// ATA PASS-THROUGH (16), SAT-спецификация
+constexpr uint8_t kAtaPassThrough16 = 0x85;
+constexpr uint8_t kAtaSmart = 0xB0;
+constexpr uint8_t kSmartReadData = 0xD0;
+constexpr uint8_t kSmartReturnStatus = 0xDA;
+constexpr uint8_t kSmartLbaMid = 0x4F;
+constexpr uint8_t kSmartLbaHigh = 0xC2;
+constexpr uint8_t kSmartFailLbaMid = 0xF4;
+constexpr uint8_t kSmartFailLbaHigh = 0x2C;
+
+constexpr uint8_t kAttrPowerOnHours = 9;
+constexpr uint8_t kAttrAirflowTemperature = 190;
+constexpr uint8_t kAttrTemperature = 194;
+
+// NVMe Get Log Page, SMART / Health Information
+constexpr uint8_t kNvmeAdminGetLogPage = 0x02;
+constexpr uint8_t kNvmeLogSmart = 0x02;
+constexpr uint32_t kNvmeSmartLogSize = 512;
+
+class Fd {
+public:
+    explicit Fd(int fd) : fd_(fd) {}
+    ~Fd() { if (fd_ >= 0) ::close(fd_); }
+    Fd(const Fd&) = delete;
+    Fd& operator=(const Fd&) = delete;
+    int get() const { return fd_; }
+private:
+    int fd_;
+};
+
+uint64_t read_le(const uint8_t* p, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = bytes; i-- > 0;) value = (value << 8) | p[i];
+    return value;
+}
+
+bool sg_ata_command(int fd, uint8_t features, bool data_in, uint8_t* data, uint8_t* sense, size_t sense_len) {
+    uint8_t cdb[16] = {};
+    cdb[0] = kAtaPassThrough16;
+    if (data_in) {
+        cdb[1] = 4 << 1;  // PIO Data-In
+        cdb[2] = 0x0e;    // T_DIR=1, BYT_BLOK=1, T_LENGTH=sector count
+        cdb[6] = 1;
+    } else {
+        cdb[1] = 3 << 1;  // Non-data
+        cdb[2] = 0x20;    // CK_COND=1: вернуть регистры в sense
+    }
+    cdb[4] = features;
+    cdb[10] = kSmartLbaMid;
+    cdb[12] = kSmartLbaHigh;
+    cdb[14] = kAtaSmart;
+
+    sg_io_hdr_t io{};
+    io.interface_id = 'S';
+    io.cmd_len = sizeof(cdb);
+    io.cmdp = cdb;
+    io.mx_sb_len = static_cast<unsigned char>(sense_len);
+    io.sbp = sense;
+    io.timeout = kIoTimeoutMs;
+    if (data_in) {
+        io.dxfer_direction = SG_DXFER_FROM_DEV;
+        io.dxfer_len = 512;
+        io.dxferp = data;
+    } else {
+        io.dxfer_direction = SG_DXFER_NONE;
+    }
+    if (::ioctl(fd, SG_IO, &io) != 0) return false;
+    if (io.host_status != 0 || (io.driver_status & ~0x08) /* кроме DRIVER_SENSE */) return false;
+    return data_in ? io.status == 0 : true;
+}
+
+// Регистры LBA mid/high из дескриптора ATA Status Return (sense в формате 0x72)
+bool ata_return_lba(const uint8_t* sense, size_t len, uint8_t& lba_mid, uint8_t& lba_high) {
+    if (len < 8 || (sense[0] & 0x7f) != 0x72) return false;
+    size_t total = std::min<size_t>(len, 8 + sense[7]);
+    for (size_t pos = 8; pos + 1 < total;) {
+        const uint8_t* desc = sense + pos;
+        if (desc[0] == 0x09 && pos + 14 <= total) {
+            lba_mid = desc[9];
+            lba_high = desc[11];
+            return true;
+        }
+        pos += 2 + desc[1];
+    }
+    return false;
+}
+
+bool read_ata_smart(int fd, SmartData& out) {
+    uint8_t data[512] = {};
+    uint8_t sense[32] = {};
+    if (!sg_ata_command(fd, kSmartReadData, true, data, sense, sizeof(sense))) return false;
+
+    bool have_temperature = false;
+    // 30 атрибутов по 12 байт начиная со смещения 2
+    for (size_t i = 0; i < 30; ++i) {
+        const uint8_t* attr = data + 2 + i * 12;
+        const uint8_t* raw = attr + 5;
+        switch (attr[0]) {
+        case kAttrPowerOnHours:
+            out.power_on_hours = read_le(raw, 4);
+            break;
+        case kAttrTemperature:
+            out.temperature = raw[0];
+            have_temperature = true;
+            break;
+        case kAttrAirflowTemperature:
+            if (!have_temperature) out.temperature = raw[0];
+            break;
+        default:
+            break;
+        }
+    }
+
+    std::memset(sense, 0, sizeof(sense));
+    uint8_t lba_mid = 0, lba_high = 0;
+    if (sg_ata_command(fd, kSmartReturnStatus, false, nullptr, sense, sizeof(sense)) &&
+        ata_return_lba(sense, sizeof(sense), lba_mid, lba_high)) {
+        if (lba_mid == kSmartLbaMid && lba_high == kSmartLbaHigh) out.health_status = "OK";
+        else if (lba_mid == kSmartFailLbaMid && lba_high == kSmartFailLbaHigh) out.health_status = "FAILED";
+    }
+    return true;
+}
+
+bool read_nvme_smart(int fd, SmartData& out) {
+    uint8_t log[kNvmeSmartLogSize] = {};
+    struct nvme_admin_cmd cmd{};
+    cmd.opcode = kNvmeAdminGetLogPage;
+    cmd.nsid = 0xFFFFFFFF;
+    cmd.addr = reinterpret_cast<uint64_t>(log);
+    cmd.data_len = sizeof(log);
+    cmd.cdw10 = ((sizeof(log) / 4 - 1) << 16) | kNvmeLogSmart;
+    cmd.timeout_ms = kIoTimeoutMs;
+    if (::ioctl(fd, NVME_IOCTL_ADMIN_CMD, &cmd) != 0) return false;
+
+    const uint64_t kelvin = read_le(log + 1, 2);
+    if (kelvin > 0) out.temperature = static_cast<double>(kelvin) - 273.0;
+    out.power_on_hours = read_le(log + 128, 8);
+    out.health_status = log[0] == 0 ? "OK" : "FAILED";  // critical warning
+    return true;
+}
+
+// "nvme0n1" и "nvme0c1n1" -> "nvme0"
+std::string nvme_controller(const std::string& name) {
+    size_t end = 4;
+    while (end < name.size() && std::isdigit(static_cast<unsigned char>(name[end]))) ++end;
+    return end > 4 ? name.substr(0, end) : std::string();
+}
+
+} // namespace
+
+LinuxSmartBackend::LinuxSmartBackend(std::string sysfs_root, std::string dev_root)
+    : sysfs_root_(std::move(sysfs_root)), dev_root_(std::move(dev_root)) {}
+
+std::vector<std::string> LinuxSmartBackend::list_devices() {
+    namespace fs = std::filesystem;
+    std::set<std::string> names;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(fs::path(sysfs_root_) / "block", ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.compare(0, 2, "sd") == 0) {
+            names.insert(name);
+        } else if (name.compare(0, 4, "nvme") == 0) {
+            std::string controller = nvme_controller(name);
+            if (!controller.empty()) names.insert(controller);
+        }
+    }
+    std::vector<std::string> devices;
+    devices.reserve(names.size());
+    for (const auto& name : names) devices.push_back(dev_root_ + "/" + name);
+    return devices;
+}
+
+bool LinuxSmartBackend::read(const std::string& device, SmartData& out) {
+    Fd fd(::open(device.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC));
+    if (fd.get() < 0) return false;
+    std::string name = std::filesystem::path(device).filename().string();
+    // Диск без поддержки запроса (например, SAS) остается в списке со статусом "Unknown"
+    if (name.compare(0, 4, "nvme") == 0) read_nvme_smart(fd.get(), out);
+    else read_ata_smart(fd.get(), out);
+    return true;
+}
+
+SmartCache::SmartCache(std::unique_ptr<SmartDeviceBackend> backend, std::chrono::seconds ttl,
+                       std::chrono::milliseconds wait_timeout)
+    : backend_(std::move(backend)), ttl_(ttl), wait_timeout_(wait_timeout) {}
+
+SmartCache::~SmartCache() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) worker_.join();
+}
+
+void SmartCache::snapshot(HddMetrics& metrics) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!worker_.joinable()) worker_ = std::thread(&SmartCache::worker_loop, this);
+
+    const bool stale = generation_ == 0 || std::chrono::steady_clock::now() - updated_at_ >= ttl_;
+    if (stale) {
+        // Обновление, начатое по прошлому запросу, тоже подходит
+        const uint64_t target = generation_ + 1;
+        if (!refreshing_) refresh_requested_ = true;
+        cv_.notify_all();
+        cv_.wait_for(lock, wait_timeout_, [&] { return generation_ >= target || stop_; });
+    }
+    metrics.drives = drives_;
+}
+
+void SmartCache::worker_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        cv_.wait(lock, [&] { return refresh_requested_ || stop_; });
+        if (stop_) break;
+        refresh_requested_ = false;
+        refreshing_ = true;
+        lock.unlock();
+        std::vector<HddDrive> drives = refresh();
+        lock.lock();
+        drives_ = std::move(drives);
+        updated_at_ = std::chrono::steady_clock::now();
+        ++generation_;
+        refreshing_ = false;
+        cv_.notify_all();
+    }
+}
+
+std::vector<HddDrive> SmartCache::refresh() {
+    const std::vector<std::string> devices = backend_->list_devices();
+    std::vector<HddDrive> drives(devices.size());
+    std::vector<char> ok(devices.size(), 0);
+    std::atomic<size_t> next{0};
+
+    auto poll = [&] {
+        for (size_t i = next++; i < devices.size(); i = next++) {
+            SmartData data;
+            ok[i] = backend_->read(devices[i], data);
+            drives[i].name = devices[i];
+            drives[i].temperature = data.temperature;
+            drives[i].power_on_hours = data.power_on_hours;
+            drives[i].health_status = data.health_status;
+        }
+    };
+    const size_t threads = std::min(devices.size(), kMaxParallel);
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < threads; ++t) pool.emplace_back(poll);
+    poll();
+    for (auto& thread : pool) thread.join();
+
+    // Устройства, которые не удалось открыть, в список не попадают
+    std::vector<HddDrive> result;
+    result.reserve(drives.size());
+    for (size_t i = 0; i < drives.size(); ++i) {
+        if (ok[i]) result.push_back(std::move(drives[i]));
+    }
+    return result;
+}
+
+} // namespace monitoring
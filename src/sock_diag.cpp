@@ -0,0 +1,156 @@
+/**
+ * @file sock_diag.cpp
+ * @brief Реализация перечисления сокетов через NETLINK_SOCK_DIAG
+ */
+
+#include "../include/sock_diag.hpp"
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <linux/netlink.h>
+#include <linux/sock_diag.h>
+#include <linux/inet_diag.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <strings.h>
+
+namespace monitoring {
+
+namespace {
+
+const char* const kTcpStateNames[] = {
+    "UNKNOWN",
+    "ESTABLISHED",
+    "SYN_SENT",
+    "SYN_RECV",
+    "FIN_WAIT1",
+    "FIN_WAIT2",
+    "TIME_WAIT",
+    "CLOSE",
+    "CLOSE_WAIT",
+    "LAST_ACK",
+    "LISTEN",
+    "CLOSING",
+    "NEW_SYN_RECV",
+};
+
+constexpr size_t kTcpStateCount = sizeof(kTcpStateNames) / sizeof(kTcpStateNames[0]);
+
+} // namespace
+
+const char* tcp_state_name(uint8_t state) {
+    return state < kTcpStateCount ? kTcpStateNames[state] : kTcpStateNames[0];
+}
+
+const char* udp_state_name(uint8_t state) {
+    return state == 1 ? "ESTABLISHED" : "UNCONN";
+}
+
+uint32_t tcp_state_mask(const std::vector<std::string>& names) {
+    if (names.empty()) return kAllTcpStates;
+    uint32_t mask = 0;
+    for (const auto& name : names) {
+        for (size_t i = 1; i < kTcpStateCount; ++i) {
+            if (strcasecmp(name.c_str(), kTcpStateNames[i]) == 0) {
+                mask |= 1u << i;
+            }
+        }
+    }
+    return mask ? mask : kAllTcpStates;
+}
+
+SockDiagClient::SockDiagClient() : buffer_(32768) {
+    fd_ = ::socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_SOCK_DIAG);
+    if (fd_ < 0) return;
+    // Дамп не должен подвешивать поток сбора, если ядро перестало отвечать
+    struct timeval tv{};
+    tv.tv_sec = 1;
+    setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+}
+
+SockDiagClient::~SockDiagClient() {
+    if (fd_ >= 0) ::close(fd_);
+}
+
+bool SockDiagClient::dump(int family, int protocol, uint32_t states, SocketSink& sink, size_t& delivered) {
+    delivered = 0;
+    if (fd_ < 0) return false;
+
+    struct {
+        struct nlmsghdr nlh;
+        struct inet_diag_req_v2 req;
+    } request{};
+    request.nlh.nlmsg_len = sizeof(request);
+    request.nlh.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+    request.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    request.nlh.nlmsg_seq = ++seq_;
+    request.req.sdiag_family = static_cast<uint8_t>(family);
+    request.req.sdiag_protocol = static_cast<uint8_t>(protocol);
+    request.req.idiag_states = protocol == IPPROTO_TCP ? states : kAllTcpStates;
+
+    struct sockaddr_nl kernel{};
+    kernel.nl_family = AF_NETLINK;
+    ssize_t sent;
+    do {
+        sent = ::sendto(fd_, &request, sizeof(request), 0,
+                        reinterpret_cast<struct sockaddr*>(&kernel), sizeof(kernel));
+    } while (sent < 0 && errno == EINTR);
+    if (sent < 0) return false;
+
+    SocketRecord record{};
+    record.family = static_cast<uint8_t>(family);
+    record.protocol = static_cast<uint8_t>(protocol);
+    const size_t addr_len = family == AF_INET6 ? 16 : 4;
+
+    for (;;) {
+        ssize_t len = ::recv(fd_, buffer_.data(), buffer_.size(), 0);
+        if (len < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (len == 0) return false; // ответ оборвался без NLMSG_DONE
+
+        int remaining = static_cast<int>(len);
+        for (auto* h = reinterpret_cast<struct nlmsghdr*>(buffer_.data());
+             NLMSG_OK(h, remaining); h = NLMSG_NEXT(h, remaining)) {
+            if (h->nlmsg_seq != seq_) continue;
+            if (h->nlmsg_type == NLMSG_DONE) return true;
+            if (h->nlmsg_type == NLMSG_ERROR) return false;
+            if (h->nlmsg_type != SOCK_DIAG_BY_FAMILY) continue;
+            if (h->nlmsg_len < NLMSG_LENGTH(sizeof(struct inet_diag_msg))) continue;
+
+            const auto* msg = static_cast<const struct inet_diag_msg*>(NLMSG_DATA(h));
+            record.state = msg->idiag_state;
+            record.local_port = ntohs(msg->id.idiag_sport);
+            record.remote_port = ntohs(msg->id.idiag_dport);
+            std::memcpy(record.local_addr, msg->id.idiag_src, addr_len);
+            std::memcpy(record.remote_addr, msg->id.idiag_dst, addr_len);
+            sink.on_socket(record);
+            ++delivered;
+        }
+    }
+}
+
+void ConnectionListSink::on_socket(const SocketRecord& record) {
+    char ip[INET6_ADDRSTRLEN];
+    NetworkConnection conn;
+    inet_ntop(record.family, record.local_addr, ip, sizeof(ip));
+    conn.local_ip = ip;
+    conn.local_port = record.local_port;
+    inet_ntop(record.family, record.remote_addr, ip, sizeof(ip));
+    conn.remote_ip = ip;
+    conn.remote_port = record.remote_port;
+    if (record.protocol == IPPROTO_TCP) {
+        conn.protocol = "TCP";
+        conn.state = tcp_state_name(record.state);
+    } else {
+        conn.protocol = "UDP";
+        conn.state = udp_state_name(record.state);
+    }
+    out_.push_back(std::move(conn));
+}
+
+} // namespace monitoring
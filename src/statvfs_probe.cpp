@@ -0,0 +1,91 @@
+/**
+ * @file statvfs_probe.cpp
+ * @brief Реализация statvfs() с таймаутом
+ */
+
+#include "../include/statvfs_probe.hpp"
+
+namespace monitoring {
+
+StatvfsProbe::StatvfsProbe(std::chrono::milliseconds timeout) : timeout_(timeout) {}
+
+StatvfsProbe::~StatvfsProbe() {
+    if (worker_) {
+        {
+            std::lock_guard<std::mutex> lock(worker_->mutex);
+            worker_->stop = true;
+        }
+        worker_->cv.notify_all();
+        thread_.join();
+    }
+    // Потоки из карантина завершатся сами, когда ядро вернет управление
+    for (auto& [path, worker] : quarantine_) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        worker->stop = true;
+    }
+}
+
+void StatvfsProbe::worker_loop(std::shared_ptr<Worker> worker) {
+    std::unique_lock<std::mutex> lock(worker->mutex);
+    for (;;) {
+        worker->cv.wait(lock, [&] { return worker->pending || worker->stop; });
+        if (!worker->pending) return;
+        std::string path = worker->path;
+        lock.unlock();
+        struct statvfs buf {};
+        int rc = ::statvfs(path.c_str(), &buf);
+        lock.lock();
+        worker->buf = buf;
+        worker->rc = rc;
+        worker->pending = false;
+        worker->cv.notify_all();
+        if (worker->stop) return;
+    }
+}
+
+void StatvfsProbe::start_worker() {
+    worker_ = std::make_shared<Worker>();
+    thread_ = std::thread(&StatvfsProbe::worker_loop, worker_);
+}
+
+void StatvfsProbe::release_finished() {
+    for (auto it = quarantine_.begin(); it != quarantine_.end();) {
+        std::lock_guard<std::mutex> lock(it->second->mutex);
+        if (!it->second->pending) {
+            it->second->stop = true;
+            it->second->cv.notify_all();
+            it = quarantine_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+StatvfsProbe::Result StatvfsProbe::stat(const std::string& path, struct statvfs& out) {
+    release_finished();
+    if (quarantine_.count(path)) return Result::kQuarantined;
+    if (!worker_) start_worker();
+
+    std::unique_lock<std::mutex> lock(worker_->mutex);
+    worker_->path = path;
+    worker_->pending = true;
+    worker_->cv.notify_all();
+    if (!worker_->cv.wait_for(lock, timeout_, [&] { return !worker_->pending; })) {
+        // Поток занят зависшим вызовом: отпускаем его и берем новый
+        lock.unlock();
+        quarantine_[path] = worker_;
+        thread_.detach();
+        worker_.reset();
+        return Result::kTimeout;
+    }
+    if (worker_->rc != 0) return Result::kError;
+    out = worker_->buf;
+    return Result::kOk;
+}
+
+size_t StatvfsProbe::quarantined_count() {
+    release_finished();
+    return quarantine_.size();
+}
+
+} // namespace monitoring
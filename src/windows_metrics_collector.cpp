@@ -238,18 +238,26 @@ WindowsMetricsCollector::~WindowsMetricsCollector() {
 }
 
 SystemMetrics WindowsMetricsCollector::collect() {
-    SystemMetrics metrics;
+    return collect(CollectOptions{});
+}
+
+SystemMetrics WindowsMetricsCollector::collect(const CollectOptions& options) {
+    SystemMetrics metrics{};
     metrics.timestamp = std::chrono::system_clock::now();
+    const uint32_t families = options.families;
     
-    metrics.cpu = collect_cpu_metrics();
-    metrics.memory = collect_memory_metrics();
-    metrics.disk = collect_disk_metrics();
-    metrics.network = collect_network_metrics();
-    metrics.gpu = collect_gpu_metrics();
-    metrics.hdd = collect_hdd_metrics();
-    metrics.user = collect_user_metrics();
+    if (families & kFamilyCpu) metrics.cpu = collect_cpu_metrics();
+    if (families & kFamilyMemory) metrics.memory = collect_memory_metrics();
+    if (families & kFamilyDisk) metrics.disk = collect_disk_metrics();
+    if (families & kFamilyNetwork) metrics.network = collect_network_metrics();
+    if (families & kFamilyGpu) metrics.gpu = collect_gpu_metrics();
+    if (families & kFamilyHdd) metrics.hdd = collect_hdd_metrics();
+    if (families & kFamilyUser) metrics.user = collect_user_metrics();
     metrics.machine_type = detect_machine_type_windows();
 
+    // Инвентаризация через WMI — самая дорогая часть, только по запросу
+    if (!(families & kFamilyInventory)) return metrics;
+
     // --- Сбор инвентаризационных данных ---
     auto& inv = metrics.inventory;
     HRESULT hres = CoInitializeEx(0, COINIT_MULTITHREADED);
@@ -862,6 +870,14 @@ GpuMetrics WindowsMetricsCollector::collect_gpu_metrics() {
                 metrics.usage_percent = usage;
                 metrics.memory_used = static_cast<uint64_t>(mem_used) * 1024 * 1024; // MB -> bytes
                 metrics.memory_total = static_cast<uint64_t>(mem_total) * 1024 * 1024; // MB -> bytes
+                GpuDevice device;
+                device.name = "nvidia0";
+                device.vendor = "nvidia";
+                device.temperature = metrics.temperature;
+                device.usage_percent = metrics.usage_percent;
+                device.memory_used = metrics.memory_used;
+                device.memory_total = metrics.memory_total;
+                metrics.devices.push_back(std::move(device));
                 return metrics;
             }
         }